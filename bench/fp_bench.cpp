@@ -0,0 +1,354 @@
+/**
+ *	@file fp_bench.cpp
+ *	Benchmark driver and the arithmetic suite: add, sub, mul, div, compare and convert on every fp_predef.h type,
+ *	on Fraction<int32_t> and Fraction<int64_t>, and on float, double and integer baselines
+ *
+ *	Usage: fp_bench [--iterations N] [--json FILE] [filter...]
+ *	Benchmarks run if "suite/type/operation" contains one of the filters, e.g. "arith/fp16_16" or "/mul". Results are written as JSON
+ *	to FILE, or to the standard output. Each benchmark runs in two modes: "latency" times one dependent chain, so each operation
+ *	waits for the one before it, and "throughput" times eight independent chains interleaved, which the processor can overlap.
+ *	FixedDecimal is not measured: fp_decimal.h does not compile yet
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include "fp_bench.h"
+
+#ifndef FP_BENCH_CONFIGURATION
+	#define FP_BENCH_CONFIGURATION "default"
+#endif
+
+// Best of this many runs is kept, which discards runs slowed by interrupts or frequency changes
+static const int _bench_runs = 3;
+
+// Operands of a chain: an additive pair, whose sum is zero, and a multiplicative pair, whose product is about one,
+// so that chains stay in range. Chains start from the first operand of the pair
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void _bench_operands(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* additive, FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* multiplicative){
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	additive[0] = value_type::from_float(1.25L);
+	additive[1] = value_type(IntegerType(0)) - additive[0];
+	multiplicative[0] = value_type::from_float(1.25L);
+	multiplicative[1] = value_type::from_float(0.8L);
+}
+
+template<typename IntegerType>
+void _bench_operands(Fraction<IntegerType>* additive, Fraction<IntegerType>* multiplicative){
+	additive[0] = Fraction<IntegerType>(1, 3);
+	additive[1] = Fraction<IntegerType>(-1, 3);
+	multiplicative[0] = Fraction<IntegerType>(3, 2);
+	multiplicative[1] = Fraction<IntegerType>(2, 3);
+}
+
+template<typename Float>
+void _bench_float_operands(Float* additive, Float* multiplicative){
+	additive[0] = Float(1.25);
+	additive[1] = Float(-1.25);
+	multiplicative[0] = Float(1.25);
+	multiplicative[1] = Float(0.8);
+}
+
+inline void _bench_operands(float* additive, float* multiplicative){
+	_bench_float_operands(additive, multiplicative);
+}
+
+inline void _bench_operands(double* additive, double* multiplicative){
+	_bench_float_operands(additive, multiplicative);
+}
+
+// Integers multiply by 3 and by its inverse modulo 2^N, which gives back the value exactly. Division chains decay to zero,
+// which still divides on every step
+inline void _bench_operands(unsigned int* additive, unsigned int* multiplicative){
+	additive[0] = 7u;
+	additive[1] = 0u - 7u;
+	multiplicative[0] = 3u;
+	multiplicative[1] = 0xAAAAAAABu;
+}
+
+inline void _bench_operands(unsigned long long int* additive, unsigned long long int* multiplicative){
+	additive[0] = 7ull;
+	additive[1] = 0ull - 7ull;
+	multiplicative[0] = 3ull;
+	multiplicative[1] = 0xAAAAAAAAAAAAAAABull;
+}
+
+// Conversions: FixedPoints go to the format with one fractional bit less and back, the shift done by mixed-format operations.
+// Fractions go through FixedPoint, floating point values through the integer of the same width, integers through double
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> _bench_convert(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& value){
+	return value.template convert<IntegerBits + 1, FractionalBits - 1>().template convert<IntegerBits, FractionalBits>();
+}
+
+template<typename IntegerType>
+Fraction<IntegerType> _bench_convert(const Fraction<IntegerType>& value){
+	static const count_type bits = std::numeric_limits<IntegerType>::digits;
+	return Fraction<IntegerType>(FixedPoint<IntegerType, bits / 2, bits - bits / 2>(value));
+}
+
+inline float _bench_convert(float value){
+	return float(int(value));
+}
+
+inline double _bench_convert(double value){
+	return double((long long int)(value));
+}
+
+inline unsigned int _bench_convert(unsigned int value){
+	return (unsigned int)(double(value));
+}
+
+inline unsigned long long int _bench_convert(unsigned long long int value){
+	return (unsigned long long int)(double(value));
+}
+
+struct _bench_add{
+	static const bool multiplicative = false;
+
+	template<typename Type>
+	static Type apply(const Type& x, const Type& y){
+		return x + y;
+	}
+};
+
+struct _bench_sub{
+	static const bool multiplicative = false;
+
+	template<typename Type>
+	static Type apply(const Type& x, const Type& y){
+		return x - y;
+	}
+};
+
+struct _bench_mul{
+	static const bool multiplicative = true;
+
+	template<typename Type>
+	static Type apply(const Type& x, const Type& y){
+		return x * y;
+	}
+};
+
+struct _bench_div{
+	static const bool multiplicative = true;
+
+	template<typename Type>
+	static Type apply(const Type& x, const Type& y){
+		return x / y;
+	}
+};
+
+// A compare and a select, i.e. max
+struct _bench_compare{
+	static const bool multiplicative = false;
+
+	template<typename Type>
+	static Type apply(const Type& x, const Type& y){
+		return x < y ? y : x;
+	}
+};
+
+struct _bench_convert_op{
+	static const bool multiplicative = false;
+
+	template<typename Type>
+	static Type apply(const Type& x, const Type&){
+		return _bench_convert(x);
+	}
+};
+
+// Times one operation on one type in both modes
+template<typename Operation, typename Type>
+void _bench_chain(FpBench& bench, const char* type, const char* operation){
+	if (!bench.selected("arith", type, operation)){
+		return;
+	}
+	Type additive[2], multiplicative[2];
+	_bench_operands(additive, multiplicative);
+	const Type* const operands = Operation::multiplicative ? multiplicative : additive;
+	const size_t iterations = bench.iterations();
+
+	double best = 0;
+	for (int run = 0; run < _bench_runs; run++){
+		Type x = operands[0];
+		fp_bench_opaque(x);
+		const FpBenchTimer timer;
+		for (size_t i = 0; i < iterations; i++){
+			x = Operation::apply(x, operands[i & 1]);
+			fp_bench_opaque(x);
+		}
+		const double seconds = timer.seconds();
+		fp_bench_keep(x);
+		best = run == 0 || seconds < best ? seconds : best;
+	}
+	bench.add("arith", type, operation, "latency", best, double(iterations));
+
+	static const size_t streams = 8;
+	for (int run = 0; run < _bench_runs; run++){
+		Type x[streams];
+		for (size_t k = 0; k < streams; k++){
+			x[k] = operands[k & 1];
+			fp_bench_opaque(x[k]);
+		}
+		const FpBenchTimer timer;
+		for (size_t i = 0; i < iterations; i += streams){
+			for (size_t k = 0; k < streams; k++){
+				x[k] = Operation::apply(x[k], operands[(i / streams + k) & 1]);
+				fp_bench_opaque(x[k]);
+			}
+		}
+		const double seconds = timer.seconds();
+		for (size_t k = 0; k < streams; k++){
+			fp_bench_keep(x[k]);
+		}
+		best = run == 0 || seconds < best ? seconds : best;
+	}
+	bench.add("arith", type, operation, "throughput", best, double(iterations / streams * streams));
+}
+
+template<typename Type>
+void _bench_type(FpBench& bench, const char* type){
+	_bench_chain<_bench_add, Type>(bench, type, "add");
+	_bench_chain<_bench_sub, Type>(bench, type, "sub");
+	_bench_chain<_bench_mul, Type>(bench, type, "mul");
+	_bench_chain<_bench_div, Type>(bench, type, "div");
+	_bench_chain<_bench_compare, Type>(bench, type, "compare");
+	_bench_chain<_bench_convert_op, Type>(bench, type, "convert");
+}
+
+// Dividing by a reciprocal computed once, against the exact division above
+struct _bench_div_reciprocal{
+	static const bool multiplicative = true;
+
+	template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+	static FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> apply(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& x, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& y){
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(x) *= reciprocals(y)[0];
+	}
+
+	// The reciprocals of both operands, computed before timing starts
+	template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+	static const FixedPointReciprocal<IntegerType, IntegerBits, FractionalBits>* reciprocals(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& y){
+		static FixedPointReciprocal<IntegerType, IntegerBits, FractionalBits> cache[2] = {
+			FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>::from_float(1.25L).reciprocal(),
+			FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>::from_float(0.8L).reciprocal()
+		};
+		return y() == FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>::from_float(1.25L)() ? cache : cache + 1;
+	}
+};
+
+template<typename Type>
+void _bench_fixedpoint(FpBench& bench, const char* type){
+	_bench_type<Type>(bench, type);
+	_bench_chain<_bench_div_reciprocal, Type>(bench, type, "div_reciprocal");
+}
+
+void fp_bench_arith(FpBench& bench){
+	_bench_type<float>(bench, "float");
+	_bench_type<double>(bench, "double");
+	_bench_type<unsigned int>(bench, "uint32");
+	_bench_type<unsigned long long int>(bench, "uint64");
+
+	#define FP_BENCH_TYPE(_type_) _bench_fixedpoint<_type_>(bench, #_type_);
+	#ifdef FIXEDPOINT_SIZE8
+		FP_BENCH_TYPE(fp1_7) FP_BENCH_TYPE(fp2_6) FP_BENCH_TYPE(fp3_5) FP_BENCH_TYPE(fp4_4)
+		FP_BENCH_TYPE(fp5_3) FP_BENCH_TYPE(fp6_2) FP_BENCH_TYPE(fp7_1)
+	#endif
+	#ifdef FIXEDPOINT_SIZE16
+		FP_BENCH_TYPE(fp15_1) FP_BENCH_TYPE(fp14_2) FP_BENCH_TYPE(fp13_3) FP_BENCH_TYPE(fp12_4) FP_BENCH_TYPE(fp11_5)
+		FP_BENCH_TYPE(fp10_6) FP_BENCH_TYPE(fp9_7) FP_BENCH_TYPE(fp8_8) FP_BENCH_TYPE(fp7_9) FP_BENCH_TYPE(fp6_10)
+		FP_BENCH_TYPE(fp5_11) FP_BENCH_TYPE(fp4_12) FP_BENCH_TYPE(fp3_13) FP_BENCH_TYPE(fp2_14) FP_BENCH_TYPE(fp1_15)
+	#endif
+	#ifdef FIXEDPOINT_SIZE32
+		FP_BENCH_TYPE(fp30_2) FP_BENCH_TYPE(fp28_4) FP_BENCH_TYPE(fp26_6) FP_BENCH_TYPE(fp24_8) FP_BENCH_TYPE(fp22_10)
+		FP_BENCH_TYPE(fp20_12) FP_BENCH_TYPE(fp18_14) FP_BENCH_TYPE(fp16_16) FP_BENCH_TYPE(fp14_18) FP_BENCH_TYPE(fp12_20)
+		FP_BENCH_TYPE(fp10_22) FP_BENCH_TYPE(fp8_24) FP_BENCH_TYPE(fp6_26) FP_BENCH_TYPE(fp4_28) FP_BENCH_TYPE(fp2_30)
+	#endif
+	#ifdef FIXEDPOINT_SIZE64
+		FP_BENCH_TYPE(fp60_4) FP_BENCH_TYPE(fp56_8) FP_BENCH_TYPE(fp52_12) FP_BENCH_TYPE(fp48_16) FP_BENCH_TYPE(fp44_20)
+		FP_BENCH_TYPE(fp40_24) FP_BENCH_TYPE(fp36_28) FP_BENCH_TYPE(fp32_32) FP_BENCH_TYPE(fp28_36) FP_BENCH_TYPE(fp24_40)
+		FP_BENCH_TYPE(fp20_44) FP_BENCH_TYPE(fp16_48) FP_BENCH_TYPE(fp12_52) FP_BENCH_TYPE(fp8_56) FP_BENCH_TYPE(fp4_60)
+	#endif
+	#undef FP_BENCH_TYPE
+
+	// What clamping and trapping cost over wrapping, on signed values that never overflow
+	_bench_fixedpoint<FixedPoint<int, 15, 16, fp_wrap> >(bench, "q15_16_wrap");
+	_bench_fixedpoint<FixedPoint<int, 15, 16, fp_saturate> >(bench, "q15_16_saturate");
+	_bench_fixedpoint<FixedPoint<int, 15, 16, fp_trap> >(bench, "q15_16_trap");
+
+	_bench_type<Fraction<int> >(bench, "Fraction<int32_t>");
+	_bench_type<Fraction<long long int> >(bench, "Fraction<int64_t>");
+}
+
+// Writes text as a JSON string
+static void _bench_json_string(std::FILE* file, const std::string& text){
+	std::fputc('"', file);
+	for (size_t i = 0; i < text.size(); i++){
+		if (text[i] == '"' || text[i] == '\\'){
+			std::fputc('\\', file);
+		}
+		std::fputc(text[i], file);
+	}
+	std::fputc('"', file);
+}
+
+void FpBench::write(std::FILE* file, const char* configuration) const{
+	std::fprintf(file, "{\n\t\"configuration\": ");
+	_bench_json_string(file, configuration);
+	#if defined(__VERSION__)
+		std::fprintf(file, ",\n\t\"compiler\": ");
+		_bench_json_string(file, __VERSION__);
+	#endif
+	std::fprintf(file, ",\n\t\"iterations\": %lu,\n\t\"results\": [", (unsigned long)_iterations);
+	for (size_t i = 0; i < _results.size(); i++){
+		const fp_bench_result& result = _results[i];
+		std::fprintf(file, "%s\n\t\t{\"suite\": ", i ? "," : "");
+		_bench_json_string(file, result.suite);
+		std::fprintf(file, ", \"type\": ");
+		_bench_json_string(file, result.type);
+		std::fprintf(file, ", \"operation\": ");
+		_bench_json_string(file, result.operation);
+		std::fprintf(file, ", \"mode\": ");
+		_bench_json_string(file, result.mode);
+		std::fprintf(file, ", \"ns_per_op\": %.4f, \"ops_per_second\": %.6g", result.ns_per_op, result.ops_per_second);
+		if (!result.extra_name.empty()){
+			std::fprintf(file, ", ");
+			_bench_json_string(file, result.extra_name);
+			std::fprintf(file, ": %.6g", result.extra);
+		}
+		std::fprintf(file, "}");
+	}
+	std::fprintf(file, "\n\t]\n}\n");
+}
+
+int main(int argc, char** argv){
+	std::vector<std::string> filters;
+	size_t iterations = size_t(1) << 19;
+	const char* output = 0;
+	for (int i = 1; i < argc; i++){
+		if (!std::strcmp(argv[i], "--iterations") && i + 1 < argc){
+			iterations = size_t(std::strtoul(argv[++i], 0, 10));
+		}else if (!std::strcmp(argv[i], "--json") && i + 1 < argc){
+			output = argv[++i];
+		}else{
+			filters.push_back(argv[i]);
+		}
+	}
+	if (iterations < 8){
+		iterations = 8;
+	}
+
+	FpBench bench(filters, iterations);
+	fp_bench_arith(bench);
+	fp_bench_kernels(bench);
+
+	std::FILE* const file = output ? std::fopen(output, "w") : stdout;
+	if (!file){
+		std::fprintf(stderr, "fp_bench: cannot open %s\n", output);
+		return 1;
+	}
+	bench.write(file, FP_BENCH_CONFIGURATION);
+	if (output){
+		std::fclose(file);
+	}
+	return 0;
+}
@@ -0,0 +1,150 @@
+/**
+ *	@file fp_bench.h
+ *	Timing, result collection and JSON output shared by the benchmark suites
+ */
+
+#ifndef H_FP_BENCH
+#define H_FP_BENCH
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_predef.h"
+
+/// One measurement, written as one JSON object
+struct fp_bench_result{
+	std::string suite;			///< Group of the benchmark, e.g. "arith" or "fft"
+	std::string type;			///< Type measured, e.g. "fp16_16" or "double"
+	std::string operation;		///< Operation, e.g. "mul"
+	std::string mode;			///< "latency" for one dependent chain, "throughput" for independent streams, or a suite's own mode
+	double ns_per_op;			///< Nanoseconds per operation
+	double ops_per_second;		///< Operations per second
+	double extra;				///< Suite-specific figure, e.g. the maximum error in ULP, negative if none
+	std::string extra_name;		///< Name of extra in the JSON output
+};
+
+/// Options and results of a run
+class FpBench{
+	std::vector<std::string> _filters;
+	std::vector<fp_bench_result> _results;
+	size_t _iterations;
+
+public:
+	/// Runs every benchmark whose "suite/type/operation" contains one of the filters, or every one if there are none
+	FpBench(const std::vector<std::string>& filters, size_t iterations) : _filters(filters), _iterations(iterations){}
+
+	/// Number of operations each benchmark should time
+	size_t iterations() const{
+		return _iterations;
+	}
+
+	/// Whether a benchmark is selected by the filters
+	bool selected(const std::string& suite, const std::string& type, const std::string& operation) const{
+		if (_filters.empty()){
+			return true;
+		}
+		const std::string name = suite + "/" + type + "/" + operation;
+		for (size_t i = 0; i < _filters.size(); i++){
+			if (name.find(_filters[i]) != std::string::npos){
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// Records a measurement of operations taking seconds in total
+	void add(const std::string& suite, const std::string& type, const std::string& operation, const std::string& mode, double seconds, double operations, double extra = -1, const std::string& extra_name = std::string()){
+		fp_bench_result result;
+		result.suite = suite;
+		result.type = type;
+		result.operation = operation;
+		result.mode = mode;
+		result.ns_per_op = operations > 0 ? seconds * 1e9 / operations : 0;
+		result.ops_per_second = seconds > 0 ? operations / seconds : 0;
+		result.extra = extra;
+		result.extra_name = extra_name;
+		_results.push_back(result);
+	}
+
+	/// Writes every result as JSON
+	void write(std::FILE* file, const char* configuration) const;
+};
+
+/// Seconds elapsed since construction
+class FpBenchTimer{
+	std::chrono::steady_clock::time_point _start;
+
+public:
+	FpBenchTimer() : _start(std::chrono::steady_clock::now()){}
+
+	double seconds() const{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+	}
+};
+
+// Hides a value from the optimizer, so that chains are neither folded nor strength-reduced.
+// Costs nothing at run time: the value only has to be in a register
+#if defined(__GNUC__) || defined(__clang__)
+	template<typename Type>
+	inline void fp_bench_opaque(Type& value){
+		asm volatile("" : "+r"(value));
+	}
+
+	#if defined(__x86_64__) || defined(__i386__)
+		inline void fp_bench_opaque(float& value){
+			asm volatile("" : "+x"(value));
+		}
+
+		inline void fp_bench_opaque(double& value){
+			asm volatile("" : "+x"(value));
+		}
+	#else
+		inline void fp_bench_opaque(float& value){
+			asm volatile("" : "+m"(value));
+		}
+
+		inline void fp_bench_opaque(double& value){
+			asm volatile("" : "+m"(value));
+		}
+	#endif
+#else
+	template<typename Type>
+	inline void fp_bench_opaque(Type& value){
+		volatile Type copy = value;
+		value = copy;
+	}
+#endif
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+inline void fp_bench_opaque(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& value){
+	IntegerType content = value();
+	fp_bench_opaque(content);
+	value = FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(content);
+}
+
+template<typename IntegerType>
+inline void fp_bench_opaque(Fraction<IntegerType>& value){
+	IntegerType numerator = value.numerator();
+	IntegerType denominator = value.denominator();
+	fp_bench_opaque(numerator);
+	fp_bench_opaque(denominator);
+	value.set(numerator, denominator);
+}
+
+/// Keeps a result alive, so that the work computing it is not removed
+template<typename Type>
+inline void fp_bench_keep(const Type& value){
+	Type copy = value;
+	fp_bench_opaque(copy);
+}
+
+// Suites: fp_bench_arith in fp_bench.cpp, fp_bench_kernels in fp_bench_kernels.cpp
+void fp_bench_arith(FpBench& bench);
+void fp_bench_kernels(FpBench& bench);
+
+#endif//H_FP_BENCH
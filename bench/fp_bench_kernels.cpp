@@ -0,0 +1,727 @@
+/**
+ *	@file fp_bench_kernels.cpp
+ *	Benchmarks of the rounding policies, fp_math.h, fp_batch.h, fp_convert.h, fp_matrix.h, fp_filter.h, fp_fft.h, fp_chars.h, and Fraction and BigFraction chains,
+ *	each against a float or C library baseline where there is one
+ */
+
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+
+#include "fp_bench.h"
+#include "fp_batch.h"
+#include "fp_bigfraction.h"
+#include "fp_chars.h"
+#include "fp_convert.h"
+#include "fp_fft.h"
+#include "fp_filter.h"
+#include "fp_math.h"
+#include "fp_matrix.h"
+
+// Deterministic inputs, the same on every run
+class _BenchRandom{
+	unsigned long long int _state;
+
+public:
+	explicit _BenchRandom(unsigned long long int seed = 0x9E3779B97F4A7C15ull) : _state(seed){}
+
+	unsigned long long int next(){
+		_state ^= _state << 13;
+		_state ^= _state >> 7;
+		_state ^= _state << 17;
+		return _state;
+	}
+
+	// Uniform in [low, high)
+	double uniform(double low, double high){
+		return low + (high - low) * double(next() >> 11) / 9007199254740992.0;
+	}
+};
+
+// Value of a FixedPoint, exactly for up to 64 bits of content
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+long double _bench_value(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& value){
+	return std::ldexp((long double)value(), -int(FractionalBits));
+}
+
+inline long double _bench_value(float value){
+	return value;
+}
+
+inline long double _bench_value(double value){
+	return value;
+}
+
+// Error in units of the last place of the result's type
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+double _bench_ulp_error(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& result, long double reference){
+	return double(std::fabs(_bench_value(result) - reference) * std::ldexp(1.0L, int(FractionalBits)));
+}
+
+template<typename Float>
+double _bench_ulp_error(Float result, long double reference){
+	const Float rounded = Float(reference);
+	const long double ulp = std::fabs((long double)std::nextafter(rounded, rounded < 0 ? -std::numeric_limits<Float>::infinity() : std::numeric_limits<Float>::infinity()) - (long double)rounded);
+	return double(std::fabs((long double)result - reference) / ulp);
+}
+
+// Generator for the stochastic rounding benchmark
+struct _bench_generator{
+	static unsigned long long int& state(){
+		static unsigned long long int value = 0x2545F4914F6CDD1Dull;
+		return value;
+	}
+
+	static unsigned long long int next(){
+		unsigned long long int& x = state();
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		return x;
+	}
+};
+
+// What each rounding policy adds to a Q15.16 or Q31.32 multiplication
+template<typename IntegerType, typename Rounding>
+void _bench_rounding(FpBench& bench, const char* type, const char* operation, count_type shift){
+	if (!bench.selected("rounding", type, operation)){
+		return;
+	}
+	const IntegerType one = IntegerType(1) << shift;
+	const IntegerType operands[2] = {IntegerType(one + one / 4), IntegerType(one - one / 5)};
+	const size_t iterations = bench.iterations();
+
+	IntegerType x = operands[0];
+	const FpBenchTimer timer;
+	for (size_t i = 0; i < iterations; i++){
+		x = _fp_wide_arith<IntegerType, Rounding>::mul_shift(x, operands[i & 1], shift);
+		fp_bench_opaque(x);
+	}
+	const double seconds = timer.seconds();
+	fp_bench_keep(x);
+	bench.add("rounding", type, operation, "latency", seconds, double(iterations));
+}
+
+template<typename IntegerType>
+void _bench_roundings(FpBench& bench, const char* type, count_type shift){
+	_bench_rounding<IntegerType, fp_round_truncate>(bench, type, "mul_truncate", shift);
+	_bench_rounding<IntegerType, fp_round_half_up>(bench, type, "mul_half_up", shift);
+	_bench_rounding<IntegerType, fp_round_half_even>(bench, type, "mul_half_even", shift);
+	_bench_rounding<IntegerType, fp_round_stochastic<_bench_generator> >(bench, type, "mul_stochastic", shift);
+}
+
+// Functions of fp_math.h and their C library counterparts, with the domain inputs are drawn from
+#define FP_BENCH_FUNCTION(_name_, _fixed_, _libm_, _low_, _high_) \
+	struct _bench_##_name_{ \
+		static const char* name(){ return #_name_; } \
+		static double low(){ return _low_; } \
+		static double high(){ return _high_; } \
+		template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy> \
+		static FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> apply(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& x, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& y){ \
+			(void)y; \
+			return _fixed_; \
+		} \
+		template<typename Float> \
+		static Float apply(Float x, Float y){ \
+			(void)y; \
+			return _libm_; \
+		} \
+		static long double reference(long double x, long double y){ \
+			(void)y; \
+			return _libm_; \
+		} \
+	};
+
+FP_BENCH_FUNCTION(sqrt, fp_sqrt(x), std::sqrt(x), 0.01, 7.0)
+FP_BENCH_FUNCTION(rsqrt, fp_rsqrt(x), 1 / std::sqrt(x), 0.25, 7.0)
+FP_BENCH_FUNCTION(exp2, fp_exp2(x), std::exp2(x), -4.0, 2.9)
+FP_BENCH_FUNCTION(log2, fp_log2(x), std::log2(x), 0.01, 7.0)
+FP_BENCH_FUNCTION(sin, fp_sin(x), std::sin(x), -3.0, 3.0)
+FP_BENCH_FUNCTION(cos, fp_cos(x), std::cos(x), -3.0, 3.0)
+FP_BENCH_FUNCTION(atan2, fp_atan2(x, y), std::atan2(x, y), -3.0, 3.0)
+#undef FP_BENCH_FUNCTION
+
+template<typename Type>
+Type _bench_from_double(double value, Type*){
+	return Type::from_float(value);
+}
+
+inline float _bench_from_double(double value, float*){
+	return float(value);
+}
+
+inline double _bench_from_double(double value, double*){
+	return value;
+}
+
+// Throughput over inputs spread across the domain, and the largest error against a long double reference
+template<typename Function, typename Type>
+void _bench_function(FpBench& bench, const char* type){
+	if (!bench.selected("math", type, Function::name())){
+		return;
+	}
+	static const size_t count = 1024;
+	std::vector<Type> x(count), y(count);
+	_BenchRandom random;
+	for (size_t i = 0; i < count; i++){
+		x[i] = _bench_from_double(random.uniform(Function::low(), Function::high()), (Type*)0);
+		y[i] = _bench_from_double(random.uniform(Function::low(), Function::high()), (Type*)0);
+	}
+
+	double error = 0;
+	for (size_t i = 0; i < count; i++){
+		const double e = _bench_ulp_error(Function::apply(x[i], y[i]), Function::reference(_bench_value(x[i]), _bench_value(y[i])));
+		error = e > error ? e : error;
+	}
+
+	const size_t iterations = bench.iterations();
+	const FpBenchTimer timer;
+	for (size_t i = 0; i < iterations; i++){
+		fp_bench_keep(Function::apply(x[i & (count - 1)], y[i & (count - 1)]));
+	}
+	bench.add("math", type, Function::name(), "throughput", timer.seconds(), double(iterations), error, "max_ulp");
+}
+
+template<typename Type>
+void _bench_functions(FpBench& bench, const char* type){
+	_bench_function<_bench_sqrt, Type>(bench, type);
+	_bench_function<_bench_rsqrt, Type>(bench, type);
+	_bench_function<_bench_exp2, Type>(bench, type);
+	_bench_function<_bench_log2, Type>(bench, type);
+	_bench_function<_bench_sin, Type>(bench, type);
+	_bench_function<_bench_cos, Type>(bench, type);
+	_bench_function<_bench_atan2, Type>(bench, type);
+}
+
+// Element-wise operations over arrays, wrapping against saturating
+template<typename Type>
+void _bench_batch(FpBench& bench, const char* type){
+	static const size_t count = 4096;
+	std::vector<Type> a(count), b(count), out(count);
+	_BenchRandom random;
+	for (size_t i = 0; i < count; i++){
+		a[i] = Type::from_float(random.uniform(-100, 100));
+		b[i] = Type::from_float(random.uniform(-100, 100));
+	}
+	const size_t repeats = bench.iterations() / count + 1;
+
+	if (bench.selected("batch", type, "add")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			fp_add(&out[0], &a[0], &b[0], count);
+			fp_bench_keep(out[r & (count - 1)]);
+		}
+		bench.add("batch", type, "add", "throughput", timer.seconds(), double(repeats * count));
+	}
+	if (bench.selected("batch", type, "mul")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			fp_mul(&out[0], &a[0], &b[0], count);
+			fp_bench_keep(out[r & (count - 1)]);
+		}
+		bench.add("batch", type, "mul", "throughput", timer.seconds(), double(repeats * count));
+	}
+}
+
+// Array conversions from and to float and double, one operation being one value, against the scalar loop of the same conversion
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+void _bench_conversions(FpBench& bench, const char* type){
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits> value_type;
+	typedef _fp_convert_scalar<IntegerType, IntegerBits, FractionalBits, fp_wrap, fp_nan_zero> scalar;
+	static const size_t count = 4096;
+	std::vector<value_type> values(count);
+	std::vector<float> floats(count);
+	std::vector<double> doubles(count);
+	_BenchRandom random;
+	for (size_t i = 0; i < count; i++){
+		doubles[i] = random.uniform(-0.9, 0.9) * std::ldexp(1.0, int(IntegerBits));
+		floats[i] = float(doubles[i]);
+	}
+	const double scale = std::ldexp(1.0, int(FractionalBits));
+	const size_t repeats = bench.iterations() / count + 1;
+
+	if (bench.selected("convert", type, "from_float")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			fp_from_float(&values[0], &floats[0], count);
+			fp_bench_keep(values[r & (count - 1)]);
+		}
+		bench.add("convert", type, "from_float", "throughput", timer.seconds(), double(repeats * count));
+	}
+	if (bench.selected("convert", type, "from_float_scalar")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			scalar::from(_fp_raw(&values[0]), &floats[0], count, scale);
+			fp_bench_keep(values[r & (count - 1)]);
+		}
+		bench.add("convert", type, "from_float_scalar", "throughput", timer.seconds(), double(repeats * count));
+	}
+	if (bench.selected("convert", type, "from_double")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			fp_from_float(&values[0], &doubles[0], count);
+			fp_bench_keep(values[r & (count - 1)]);
+		}
+		bench.add("convert", type, "from_double", "throughput", timer.seconds(), double(repeats * count));
+	}
+	if (bench.selected("convert", type, "from_double_scalar")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			scalar::from(_fp_raw(&values[0]), &doubles[0], count, scale);
+			fp_bench_keep(values[r & (count - 1)]);
+		}
+		bench.add("convert", type, "from_double_scalar", "throughput", timer.seconds(), double(repeats * count));
+	}
+	if (bench.selected("convert", type, "to_float")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			fp_to_float(&floats[0], &values[0], count);
+			fp_bench_keep(floats[r & (count - 1)]);
+		}
+		bench.add("convert", type, "to_float", "throughput", timer.seconds(), double(repeats * count));
+	}
+	if (bench.selected("convert", type, "to_float_scalar")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			scalar::to(&floats[0], _fp_raw(&values[0]), count, float(1 / scale));
+			fp_bench_keep(floats[r & (count - 1)]);
+		}
+		bench.add("convert", type, "to_float_scalar", "throughput", timer.seconds(), double(repeats * count));
+	}
+	if (bench.selected("convert", type, "to_double")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			fp_to_float(&doubles[0], &values[0], count);
+			fp_bench_keep(doubles[r & (count - 1)]);
+		}
+		bench.add("convert", type, "to_double", "throughput", timer.seconds(), double(repeats * count));
+	}
+	if (bench.selected("convert", type, "to_double_scalar")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			scalar::to(&doubles[0], _fp_raw(&values[0]), count, 1 / scale);
+			fp_bench_keep(doubles[r & (count - 1)]);
+		}
+		bench.add("convert", type, "to_double_scalar", "throughput", timer.seconds(), double(repeats * count));
+	}
+}
+
+// The float baseline, a plain loop ordered for sequential access, which the compiler vectorizes
+inline void fp_gemm(float* out, const float* a, const float* b, size_t rows, size_t inner, size_t columns){
+	for (size_t i = 0; i < rows; i++){
+		float* const row = out + i * columns;
+		for (size_t j = 0; j < columns; j++){
+			row[j] = 0;
+		}
+		for (size_t k = 0; k < inner; k++){
+			const float scale = a[i * inner + k];
+			for (size_t j = 0; j < columns; j++){
+				row[j] += scale * b[k * columns + j];
+			}
+		}
+	}
+}
+
+inline void fp_gemm_parallel(float* out, const float* a, const float* b, size_t rows, size_t inner, size_t columns){
+	fp_gemm(out, a, b, rows, inner, columns);
+}
+
+// Matrix products of size x size matrices, one operation being a multiply-add
+template<typename Type>
+void _bench_gemm(FpBench& bench, const char* type, size_t size){
+	const bool serial = bench.selected("gemm", type, "gemm"), parallel = bench.selected("gemm", type, "gemm_parallel");
+	if (!serial && !parallel){
+		return;
+	}
+	std::vector<Type> a(size * size), b(size * size), out(size * size);
+	_BenchRandom random;
+	for (size_t i = 0; i < size * size; i++){
+		a[i] = _bench_from_double(random.uniform(-0.5, 0.5) / double(size), (Type*)0);
+		b[i] = _bench_from_double(random.uniform(-0.5, 0.5), (Type*)0);
+	}
+	const double operations = double(size) * double(size) * double(size);
+	const size_t repeats = size_t(double(bench.iterations()) / operations) + 1;
+
+	if (serial){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			fp_gemm(&out[0], &a[0], &b[0], size, size, size);
+			fp_bench_keep(out[r % out.size()]);
+		}
+		const double seconds = timer.seconds();
+		bench.add("gemm", type, "gemm", "throughput", seconds, repeats * operations, 2 * repeats * operations / seconds * 1e-9, "gops");
+	}
+	if (parallel){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			fp_gemm_parallel(&out[0], &a[0], &b[0], size, size, size);
+			fp_bench_keep(out[r % out.size()]);
+		}
+		const double seconds = timer.seconds();
+		bench.add("gemm", type, "gemm_parallel", "throughput", seconds, repeats * operations, 2 * repeats * operations / seconds * 1e-9, "gops");
+	}
+}
+
+// FIR filtering and biquad cascades over a block of samples, one operation being one input sample
+template<typename IntegerType>
+void _bench_fir(FpBench& bench, const char* type, size_t taps){
+	typedef FixedPointFir<IntegerType, 0> filter_type;
+	typedef typename filter_type::value_type value_type;
+	typedef typename filter_type::coefficient_type coefficient_type;
+
+	char operation[32];
+	std::snprintf(operation, sizeof(operation), "fir%lu", (unsigned long)taps);
+	if (!bench.selected("filter", type, operation)){
+		return;
+	}
+	static const size_t count = 4096;
+	std::vector<coefficient_type> coefficients(taps);
+	std::vector<value_type> in(count), out(count);
+	_BenchRandom random;
+	for (size_t i = 0; i < taps; i++){
+		coefficients[i] = coefficient_type::from_float(random.uniform(-1, 1) / double(taps));
+	}
+	for (size_t i = 0; i < count; i++){
+		in[i] = value_type::from_float(random.uniform(-0.9, 0.9));
+	}
+	filter_type filter(&coefficients[0], taps);
+	const size_t repeats = bench.iterations() / count + 1;
+
+	const FpBenchTimer timer;
+	for (size_t r = 0; r < repeats; r++){
+		filter.process(&out[0], &in[0], count);
+		fp_bench_keep(out[r & (count - 1)]);
+	}
+	bench.add("filter", type, operation, "throughput", timer.seconds(), double(repeats * count));
+}
+
+inline void _bench_fir_float(FpBench& bench, size_t taps){
+	char operation[32];
+	std::snprintf(operation, sizeof(operation), "fir%lu", (unsigned long)taps);
+	if (!bench.selected("filter", "float", operation)){
+		return;
+	}
+	static const size_t count = 4096;
+	std::vector<float> coefficients(taps), history(taps - 1 + count), out(count);
+	_BenchRandom random;
+	for (size_t i = 0; i < taps; i++){
+		coefficients[i] = float(random.uniform(-1, 1) / double(taps));
+	}
+	for (size_t i = 0; i < history.size(); i++){
+		history[i] = float(random.uniform(-0.9, 0.9));
+	}
+	const size_t repeats = bench.iterations() / count + 1;
+
+	const FpBenchTimer timer;
+	for (size_t r = 0; r < repeats; r++){
+		for (size_t i = 0; i < count; i++){
+			float sum = 0;
+			for (size_t k = 0; k < taps; k++){
+				sum += coefficients[k] * history[i + taps - 1 - k];
+			}
+			out[i] = sum;
+		}
+		fp_bench_keep(out[r & (count - 1)]);
+	}
+	bench.add("filter", "float", operation, "throughput", timer.seconds(), double(repeats * count));
+}
+
+template<typename IntegerType>
+void _bench_biquad(FpBench& bench, const char* type, size_t channels){
+	typedef FixedPointBiquad<IntegerType, 0, std::numeric_limits<IntegerType>::digits, fp_wrap, std::numeric_limits<IntegerType>::digits - 1> filter_type;
+	typedef typename filter_type::value_type value_type;
+	typedef typename filter_type::coefficient_type coefficient_type;
+
+	char operation[32];
+	std::snprintf(operation, sizeof(operation), "biquad4x%lu", (unsigned long)channels);
+	if (!bench.selected("filter", type, operation)){
+		return;
+	}
+	static const size_t sections = 4, frames = 1024;
+	static const double section[5] = {0.2, 0.4, 0.2, -0.5, 0.3};
+	coefficient_type coefficients[5 * sections];
+	for (size_t i = 0; i < 5 * sections; i++){
+		coefficients[i] = coefficient_type::from_float(section[i % 5]);
+	}
+	std::vector<value_type> in(frames * channels), out(frames * channels);
+	_BenchRandom random;
+	for (size_t i = 0; i < in.size(); i++){
+		in[i] = value_type::from_float(random.uniform(-0.5, 0.5));
+	}
+	filter_type filter(coefficients, sections, channels);
+	const size_t repeats = bench.iterations() / in.size() + 1;
+
+	const FpBenchTimer timer;
+	for (size_t r = 0; r < repeats; r++){
+		filter.process(&out[0], &in[0], frames);
+		fp_bench_keep(out[r % out.size()]);
+	}
+	bench.add("filter", type, operation, "throughput", timer.seconds(), double(repeats * in.size()));
+}
+
+// Radix 2 float FFT with a twiddle table, the baseline for FixedPointFft
+class _BenchFloatFft{
+	std::vector<std::complex<float> > _twiddles;
+	size_t _size;
+
+public:
+	explicit _BenchFloatFft(size_t size) : _twiddles(size / 2), _size(size){
+		for (size_t k = 0; k < size / 2; k++){
+			_twiddles[k] = std::polar(1.0f, float(-2 * 3.14159265358979323846 * double(k) / double(size)));
+		}
+	}
+
+	void forward(std::complex<float>* out, const std::complex<float>* in) const{
+		for (size_t i = 0, j = 0; i < _size; i++){
+			out[j] = in[i];
+			size_t bit = _size >> 1;
+			for (; j & bit; bit >>= 1){
+				j ^= bit;
+			}
+			j |= bit;
+		}
+		for (size_t h = 1; h < _size; h *= 2){
+			const size_t stride = _size / (2 * h);
+			for (size_t start = 0; start < _size; start += 2 * h){
+				for (size_t k = 0; k < h; k++){
+					const std::complex<float> t = _twiddles[k * stride] * out[start + h + k];
+					out[start + h + k] = out[start + k] - t;
+					out[start + k] += t;
+				}
+			}
+		}
+	}
+};
+
+// Transforms per second, and the conventional 5 N log2 N floating point operations per transform
+template<typename IntegerType>
+void _bench_fft(FpBench& bench, const char* type, size_t size){
+	typedef FixedPointFft<IntegerType, 0> fft_type;
+	typedef typename fft_type::value_type value_type;
+	typedef typename value_type::value_type component_type;
+
+	char operation[32];
+	std::snprintf(operation, sizeof(operation), "forward%lu", (unsigned long)size);
+	if (!bench.selected("fft", type, operation)){
+		return;
+	}
+	std::vector<value_type> in(size), out(size);
+	_BenchRandom random;
+	for (size_t i = 0; i < size; i++){
+		in[i] = value_type(component_type::from_float(random.uniform(-0.5, 0.5)), component_type::from_float(random.uniform(-0.5, 0.5)));
+	}
+	const fft_type fft(size);
+	const size_t repeats = bench.iterations() / size + 1;
+
+	const FpBenchTimer timer;
+	for (size_t r = 0; r < repeats; r++){
+		fp_bench_keep(fft.forward(&out[0], &in[0]));
+	}
+	const double seconds = timer.seconds();
+	bench.add("fft", type, operation, "throughput", seconds, double(repeats), 5 * double(size) * std::log2(double(size)) * repeats / seconds * 1e-6, "mflops");
+}
+
+inline void _bench_fft_float(FpBench& bench, size_t size){
+	char operation[32];
+	std::snprintf(operation, sizeof(operation), "forward%lu", (unsigned long)size);
+	if (!bench.selected("fft", "float", operation)){
+		return;
+	}
+	std::vector<std::complex<float> > in(size), out(size);
+	_BenchRandom random;
+	for (size_t i = 0; i < size; i++){
+		in[i] = std::complex<float>(float(random.uniform(-0.5, 0.5)), float(random.uniform(-0.5, 0.5)));
+	}
+	const _BenchFloatFft fft(size);
+	const size_t repeats = bench.iterations() / size + 1;
+
+	const FpBenchTimer timer;
+	for (size_t r = 0; r < repeats; r++){
+		fft.forward(&out[0], &in[0]);
+		fp_bench_keep(out[r % size].real());
+	}
+	const double seconds = timer.seconds();
+	bench.add("fft", "float", operation, "throughput", seconds, double(repeats), 5 * double(size) * std::log2(double(size)) * repeats / seconds * 1e-6, "mflops");
+}
+
+// Formatting and parsing a comma separated list, one operation being one value, against snprintf and strtod on doubles
+template<typename Type>
+void _bench_chars(FpBench& bench, const char* type){
+	static const size_t count = 16384;
+	std::vector<Type> values(count), parsed(count);
+	std::vector<double> doubles(count);
+	_BenchRandom random;
+	for (size_t i = 0; i < count; i++){
+		values[i] = Type::from_float(random.uniform(-1000, 1000));
+		doubles[i] = double(_bench_value(values[i]));
+	}
+	std::vector<char> text(count * 40);
+	char* const first = &text[0];
+	char* const last = first + text.size();
+	const size_t repeats = bench.iterations() / count + 1;
+
+	// Formatted length, for the GB/s figures
+	char* end = first;
+	for (size_t i = 0; i < count; i++){
+		end = fp_to_chars(end, last, values[i]).ptr;
+		*end++ = ',';
+	}
+	const double bytes = double(end - first) * repeats;
+
+	if (bench.selected("chars", type, "to_chars")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			char* position = first;
+			for (size_t i = 0; i < count; i++){
+				position = fp_to_chars(position, last, values[i]).ptr;
+				*position++ = ',';
+			}
+			fp_bench_keep(position);
+		}
+		const double seconds = timer.seconds();
+		bench.add("chars", type, "to_chars", "throughput", seconds, double(repeats * count), bytes / seconds * 1e-9, "gb_per_second");
+	}
+	if (bench.selected("chars", type, "from_chars")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			const char* position = first;
+			for (size_t i = 0; i < count; i++){
+				position = fp_from_chars(position, end, parsed[i]).ptr + 1;
+			}
+			fp_bench_keep(parsed[r & (count - 1)]);
+		}
+		const double seconds = timer.seconds();
+		bench.add("chars", type, "from_chars", "throughput", seconds, double(repeats * count), bytes / seconds * 1e-9, "gb_per_second");
+	}
+	if (bench.selected("chars", type, "from_chars_bulk")){
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			size_t read = 0;
+			fp_from_chars(first, end, &parsed[0], count, read);
+			fp_bench_keep(read);
+		}
+		const double seconds = timer.seconds();
+		bench.add("chars", type, "from_chars_bulk", "throughput", seconds, double(repeats * count), bytes / seconds * 1e-9, "gb_per_second");
+	}
+
+	// The C library on the same values, printed with enough digits to read them back
+	if (bench.selected("chars", "double", "snprintf")){
+		end = first;
+		for (size_t i = 0; i < count; i++){
+			end += std::snprintf(end, size_t(last - end), "%.17g,", doubles[i]);
+		}
+		const double c_bytes = double(end - first) * repeats;
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			char* position = first;
+			for (size_t i = 0; i < count; i++){
+				position += std::snprintf(position, size_t(last - position), "%.17g,", doubles[i]);
+			}
+			fp_bench_keep(position);
+		}
+		const double seconds = timer.seconds();
+		bench.add("chars", "double", "snprintf", "throughput", seconds, double(repeats * count), c_bytes / seconds * 1e-9, "gb_per_second");
+	}
+	if (bench.selected("chars", "double", "strtod")){
+		end = first;
+		for (size_t i = 0; i < count; i++){
+			end += std::snprintf(end, size_t(last - end), "%.17g,", doubles[i]);
+		}
+		const double c_bytes = double(end - first) * repeats;
+		const FpBenchTimer timer;
+		for (size_t r = 0; r < repeats; r++){
+			char* position = first;
+			for (size_t i = 0; i < count; i++){
+				doubles[i] = std::strtod(position, &position);
+				position++;
+			}
+			fp_bench_keep(doubles[r & (count - 1)]);
+		}
+		const double seconds = timer.seconds();
+		bench.add("chars", "double", "strtod", "throughput", seconds, double(repeats * count), c_bytes / seconds * 1e-9, "gb_per_second");
+	}
+}
+
+// A BigFraction does not fit in a register, its inline numerator and denominator do, and its sign once it has spilled to limbs
+inline void fp_bench_opaque(BigFraction& value){
+	long long int numerator, denominator;
+	if (value.get(numerator, denominator)){
+		fp_bench_opaque(numerator);
+		fp_bench_opaque(denominator);
+		value = BigFraction(numerator, denominator);
+	}else{
+		int sign = value.sign();
+		fp_bench_opaque(sign);
+	}
+}
+
+// Harmonic sums 1/1 + ... + 1/terms, whose denominators grow to lcm(1, ..., terms), one operation being one term.
+// lcm(1, ..., 40) fits in 53 bits, so BigFraction stays inline up to 40 terms, and needs 3 to 5 limbs for 100.
+// Built with FIXEDPOINT_FRACTION_LAZY, fp_bench_lazy gives the cost with reduction deferred
+template<typename FractionType>
+void _bench_fraction_chain(FpBench& bench, const char* type, long long int terms, const char* op){
+	if (!bench.selected("fraction", type, op)){
+		return;
+	}
+	const size_t repeats = bench.iterations() / size_t(terms) + 1;
+
+	const FpBenchTimer timer;
+	for (size_t r = 0; r < repeats; r++){
+		FractionType sum(0, 1);
+		for (long long int k = 1; k <= terms; k++){
+			long long int denominator = k;
+			fp_bench_opaque(denominator);
+			sum += FractionType(1, denominator);
+		}
+		fp_bench_keep(sum);
+	}
+	bench.add("fraction", type, op, "latency", timer.seconds(), double(repeats * size_t(terms)));
+}
+
+void fp_bench_kernels(FpBench& bench){
+	_bench_roundings<int>(bench, "q15_16", 16);
+	_bench_roundings<long long int>(bench, "q31_32", 32);
+
+	_bench_functions<FixedPoint<short, 3, 12> >(bench, "q3_12");
+	_bench_functions<FixedPoint<int, 15, 16> >(bench, "q15_16");
+	_bench_functions<FixedPoint<long long int, 31, 32> >(bench, "q31_32");
+	_bench_functions<float>(bench, "float");
+	_bench_functions<double>(bench, "double");
+
+	_bench_batch<FixedPoint<short, 7, 8, fp_wrap> >(bench, "q7_8_wrap");
+	_bench_batch<FixedPoint<short, 7, 8, fp_saturate> >(bench, "q7_8_saturate");
+	_bench_batch<FixedPoint<int, 15, 16, fp_wrap> >(bench, "q15_16_wrap");
+	_bench_batch<FixedPoint<int, 15, 16, fp_saturate> >(bench, "q15_16_saturate");
+
+	_bench_conversions<short, 7, 8>(bench, "q7_8");
+	_bench_conversions<int, 15, 16>(bench, "q15_16");
+	_bench_conversions<long long int, 31, 32>(bench, "q31_32");
+
+	_bench_gemm<FixedPoint<signed char, 0, 7> >(bench, "q0_7", 256);
+	_bench_gemm<FixedPoint<short, 0, 15> >(bench, "q0_15", 256);
+	_bench_gemm<FixedPoint<int, 0, 31> >(bench, "q0_31", 256);
+	_bench_gemm<float>(bench, "float", 256);
+
+	static const size_t taps[3] = {16, 64, 256};
+	for (size_t i = 0; i < 3; i++){
+		_bench_fir<short>(bench, "q0_15", taps[i]);
+		_bench_fir<int>(bench, "q0_31", taps[i]);
+		_bench_fir_float(bench, taps[i]);
+	}
+	_bench_biquad<short>(bench, "q0_15", 1);
+	_bench_biquad<short>(bench, "q0_15", 8);
+	_bench_biquad<int>(bench, "q0_31", 1);
+	_bench_biquad<int>(bench, "q0_31", 8);
+
+	for (size_t size = 64; size <= 65536; size *= 4){
+		_bench_fft<short>(bench, "q0_15", size);
+		_bench_fft<int>(bench, "q0_31", size);
+		_bench_fft_float(bench, size);
+	}
+
+	_bench_chars<FixedPoint<int, 15, 16> >(bench, "q15_16");
+
+	_bench_fraction_chain<Fraction<long long int> >(bench, "Fraction<int64_t>", 40, "harmonic40");
+	_bench_fraction_chain<BigFraction>(bench, "BigFraction", 40, "harmonic40");
+	_bench_fraction_chain<BigFraction>(bench, "BigFraction", 100, "harmonic100");
+}
@@ -0,0 +1,644 @@
+/**
+ *	@file fp_array.h
+ *	Adds containers of FixedPoints with aligned storage and element-wise operations
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_ARRAY
+#define H_FP_ARRAY
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "fp_batch.h"
+#include "fp_fused.h"
+
+// Add the following line to your code before any #include "fp_*.h"
+// to change the alignment of FixedPointArray storage, a power of two. A cache line by default,
+// which also keeps the widest vectors from straddling two lines
+//#define FIXEDPOINT_ARRAY_ALIGNMENT 64
+#ifndef FIXEDPOINT_ARRAY_ALIGNMENT
+	#define FIXEDPOINT_ARRAY_ALIGNMENT 64
+#endif
+
+// Allocates size bytes aligned to FIXEDPOINT_ARRAY_ALIGNMENT, throws std::bad_alloc on failure.
+// The pointer given by malloc is kept just before the aligned block
+inline void* _fp_aligned_alloc(size_t size){
+	void* const block = std::malloc(size + FIXEDPOINT_ARRAY_ALIGNMENT + sizeof(void*));
+	if (!block){
+		throw std::bad_alloc();
+	}
+	const size_t address = reinterpret_cast<size_t>(static_cast<char*>(block) + sizeof(void*));
+	void** const aligned = reinterpret_cast<void**>((address + FIXEDPOINT_ARRAY_ALIGNMENT - 1) & ~size_t(FIXEDPOINT_ARRAY_ALIGNMENT - 1));
+	aligned[-1] = block;
+	return aligned;
+}
+
+inline void _fp_aligned_free(void* aligned){
+	if (aligned){
+		std::free(static_cast<void**>(aligned)[-1]);
+	}
+}
+
+// Number of elements of size bytes that fill whole alignment blocks, at least count
+inline size_t _fp_aligned_count(size_t count, size_t size){
+	const size_t per_block = FIXEDPOINT_ARRAY_ALIGNMENT > size ? FIXEDPOINT_ARRAY_ALIGNMENT / size : 1;
+	return (count + per_block - 1) / per_block * per_block;
+}
+
+///	A read-only view of consecutive FixedPoints that does not own them
+/**
+ *	Returned by the const members of views, arrays and files, so that const values cannot be changed through a view.
+ *	Every FixedPointView converts to one
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits, typename OverflowPolicy = fp_wrap>
+class FixedPointConstView{
+public:
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	typedef const value_type* const_iterator;
+
+private:
+	const value_type* _values;
+	size_t _size;
+
+public:
+	/// Empty view
+	FixedPointConstView() : _values(0), _size(0){}
+
+	/// View of existing values
+	/**
+	 *	@param values First value
+	 *	@param size Number of values
+	 */
+	FixedPointConstView(const value_type* values, size_t size) : _values(values), _size(size){}
+
+	size_t size() const{
+		return _size;
+	}
+
+	bool empty() const{
+		return _size == 0;
+	}
+
+	const value_type* data() const{
+		return _values;
+	}
+
+	const_iterator begin() const{
+		return _values;
+	}
+
+	const_iterator end() const{
+		return _values + _size;
+	}
+
+	const value_type& operator[](size_t index) const{
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (index >= _size){
+				_fp_event<value_type>(fp_event_range, "FixedPointConstView::operator[]");
+			}
+		#endif
+		return _values[index];
+	}
+
+	/// Returns a view of part of the values, without copying them
+	/**
+	 *	@param offset Index of the first value of the slice
+	 *	@param count Number of values in the slice
+	 *	@return View of the slice
+	 */
+	FixedPointConstView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> slice(size_t offset, size_t count) const{
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (offset > _size || count > _size - offset){
+				_fp_event<value_type>(fp_event_range, "FixedPointConstView::slice");
+			}
+		#endif
+		return FixedPointConstView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(_values + offset, count);
+	}
+};
+
+///	A view of consecutive FixedPoints that does not own them
+/**
+ *	Views are cheap to copy and slice, and copying one copies the view, not the values.
+ *	Views cannot be assigned, since an array is a view of its own storage: construct another view to look elsewhere,
+ *	and use assign() to copy values. The const members give a FixedPointConstView.
+ *	Element-wise operations work in place and use the vector loops of fp_batch.h. Arrays given
+ *	to them must have at least size() elements, which is reported as a range event if FIXEDPOINT_INSTRUMENT is defined
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits, typename OverflowPolicy = fp_wrap>
+class FixedPointView{
+public:
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	typedef FixedPointConstView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> const_view_type;
+	typedef value_type* iterator;
+	typedef const value_type* const_iterator;
+
+protected:
+	value_type* _values;
+	size_t _size;
+
+	// Rebinding a view through a reference to an array would leave the array freeing storage it does not own
+	FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator=(const FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+		_values = other._values;
+		_size = other._size;
+		return *this;
+	}
+
+	void _check(size_t size, const char* operation) const{
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (size < _size){
+				_fp_event<value_type>(fp_event_range, operation);
+			}
+		#else
+			(void)size;
+			(void)operation;
+		#endif
+	}
+
+public:
+	/// Empty view
+	FixedPointView() : _values(0), _size(0){}
+
+	/// View of existing values
+	/**
+	 *	@param values First value
+	 *	@param size Number of values
+	 */
+	FixedPointView(value_type* values, size_t size) : _values(values), _size(size){}
+
+	/// Copy constructor, views the same values
+	/**
+	 *	@param other View to copy
+	 */
+	FixedPointView(const FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) : _values(other._values), _size(other._size){}
+
+	/// Read-only view of the same values
+	operator const_view_type() const{
+		return const_view_type(_values, _size);
+	}
+
+	size_t size() const{
+		return _size;
+	}
+
+	bool empty() const{
+		return _size == 0;
+	}
+
+	value_type* data(){
+		return _values;
+	}
+
+	const value_type* data() const{
+		return _values;
+	}
+
+	iterator begin(){
+		return _values;
+	}
+
+	iterator end(){
+		return _values + _size;
+	}
+
+	const_iterator begin() const{
+		return _values;
+	}
+
+	const_iterator end() const{
+		return _values + _size;
+	}
+
+	value_type& operator[](size_t index){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (index >= _size){
+				_fp_event<value_type>(fp_event_range, "FixedPointView::operator[]");
+			}
+		#endif
+		return _values[index];
+	}
+
+	const value_type& operator[](size_t index) const{
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (index >= _size){
+				_fp_event<value_type>(fp_event_range, "FixedPointView::operator[]");
+			}
+		#endif
+		return _values[index];
+	}
+
+	/// Returns a view of part of the values, without copying them
+	/**
+	 *	@param offset Index of the first value of the slice
+	 *	@param count Number of values in the slice
+	 *	@return View of the slice
+	 */
+	FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> slice(size_t offset, size_t count){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (offset > _size || count > _size - offset){
+				_fp_event<value_type>(fp_event_range, "FixedPointView::slice");
+			}
+		#endif
+		return FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(_values + offset, count);
+	}
+
+	const_view_type slice(size_t offset, size_t count) const{
+		return const_view_type(*this).slice(offset, count);
+	}
+
+	/// Copies the values of another view into this one
+	/**
+	 *	@param other Values to copy
+	 */
+	void assign(const const_view_type& other){
+		_check(other.size(), "FixedPointView::assign");
+		for (size_t i = 0; i < _size; i++){
+			_values[i] = other[i];
+		}
+	}
+
+	/// Sets every value
+	/**
+	 *	@param value Value to set
+	 */
+	void fill(const value_type& value){
+		for (size_t i = 0; i < _size; i++){
+			_values[i] = value;
+		}
+	}
+
+	/// Evaluates a fused expression into the values in one pass
+	/**
+	 *	e.g. y = fp_fused(a) * x + b, with x, b, and y views of the same size
+	 *	@param expression Expression of arrays and single values
+	 *	@return This view
+	 */
+	template<typename Node>
+	FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator=(const FixedPointExpression<Node>& expression){
+		fp_eval(_values, expression, _size);
+		return *this;
+	}
+
+	FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator+=(const const_view_type& other){
+		_check(other.size(), "FixedPointView::operator+=");
+		fp_add(_values, _values, other.data(), _size);
+		return *this;
+	}
+
+	FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator-=(const const_view_type& other){
+		_check(other.size(), "FixedPointView::operator-=");
+		fp_sub(_values, _values, other.data(), _size);
+		return *this;
+	}
+
+	FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator*=(const const_view_type& other){
+		_check(other.size(), "FixedPointView::operator*=");
+		fp_mul(_values, _values, other.data(), _size);
+		return *this;
+	}
+
+	FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator*=(const value_type& factor){
+		fp_scale(_values, _values, factor, _size);
+		return *this;
+	}
+
+	/// Adds other scaled by factor, e.g. position.add_scaled(velocity, dt)
+	/**
+	 *	Each product is rounded to the format by the rounding policy before the addition, as with fp_fma
+	 *	@param other Values to scale and add
+	 *	@param factor Scale factor
+	 *	@return This view
+	 */
+	FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& add_scaled(const const_view_type& other, const value_type& factor){
+		_check(other.size(), "FixedPointView::add_scaled");
+		_fp_batch_kernel<IntegerType, OverflowPolicy>::mul_add(_fp_raw(_values), _fp_raw(other.data()), 0, factor(), _fp_raw(_values), _size, FractionalBits);
+		return *this;
+	}
+};
+
+///	A resizable array of FixedPoints in storage aligned to FIXEDPOINT_ARRAY_ALIGNMENT
+/**
+ *	The array is a view of its own values, so it has all of the element-wise operations and can be passed
+ *	wherever a view is expected. Copying an array copies the values
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits, typename OverflowPolicy = fp_wrap>
+class FixedPointArray : public FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>{
+	typedef FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> _view_type;
+
+	void _allocate(size_t size){
+		this->_values = size ? static_cast<typename _view_type::value_type*>(_fp_aligned_alloc(size * sizeof(typename _view_type::value_type))) : 0;
+		this->_size = size;
+	}
+
+public:
+	typedef typename _view_type::value_type value_type;
+
+	/// Empty array
+	FixedPointArray(){}
+
+	/// Array of zeros
+	/**
+	 *	@param size Number of values
+	 */
+	explicit FixedPointArray(size_t size){
+		_allocate(size);
+		this->fill(value_type());
+	}
+
+	/// Array of copies of a value
+	/**
+	 *	@param size Number of values
+	 *	@param value Value to copy
+	 */
+	FixedPointArray(size_t size, const value_type& value){
+		_allocate(size);
+		this->fill(value);
+	}
+
+	/// Array of raw fixed point numbers
+	/**
+	 *	@param raw Raw contents, in this format
+	 *	@param size Number of values
+	 */
+	FixedPointArray(const IntegerType* raw, size_t size){
+		_allocate(size);
+		for (size_t i = 0; i < size; i++){
+			this->_values[i] = value_type(raw[i]);
+		}
+	}
+
+	/// Array converted from floats, rounded to nearest
+	/**
+	 *	@param values Values to convert, must fit in the format
+	 *	@param size Number of values
+	 */
+	FixedPointArray(const float* values, size_t size){
+		_allocate(size);
+		for (size_t i = 0; i < size; i++){
+			this->_values[i] = value_type::from_float(values[i]);
+		}
+	}
+
+	/// Array converted from doubles, rounded to nearest
+	/**
+	 *	@param values Values to convert, must fit in the format
+	 *	@param size Number of values
+	 */
+	FixedPointArray(const double* values, size_t size){
+		_allocate(size);
+		for (size_t i = 0; i < size; i++){
+			this->_values[i] = value_type::from_float(values[i]);
+		}
+	}
+
+	/// Array copied from a view
+	/**
+	 *	@param other Values to copy
+	 */
+	explicit FixedPointArray(const typename _view_type::const_view_type& other){
+		_allocate(other.size());
+		this->assign(other);
+	}
+
+	FixedPointArray(const FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) : _view_type(){
+		_allocate(other.size());
+		this->assign(other);
+	}
+
+	#ifdef FIXEDPOINT_CPP0X
+		FixedPointArray(FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>&& other) : _view_type(){
+			swap(other);
+		}
+
+		FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator=(FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>&& other){
+			swap(other);
+			return *this;
+		}
+	#endif
+
+	~FixedPointArray(){
+		_fp_aligned_free(this->_values);
+	}
+
+	FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator=(const FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+		if (this != &other){
+			FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> copy(other);
+			swap(copy);
+		}
+		return *this;
+	}
+
+	template<typename Node>
+	FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator=(const FixedPointExpression<Node>& expression){
+		_view_type::operator=(expression);
+		return *this;
+	}
+
+	void swap(FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+		value_type* const values = this->_values;
+		const size_t size = this->_size;
+		this->_values = other._values;
+		this->_size = other._size;
+		other._values = values;
+		other._size = size;
+	}
+
+	/// Changes the number of values, keeping the first ones
+	/**
+	 *	New values are zero
+	 *	@param size New number of values
+	 */
+	void resize(size_t size){
+		FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> resized(size);
+		resized.slice(0, size < this->_size ? size : this->_size).assign(this->slice(0, size < this->_size ? size : this->_size));
+		swap(resized);
+	}
+
+	/// Returns a view of all of the values
+	/**
+	 *	@return View of the array
+	 */
+	_view_type view(){
+		return _view_type(this->_values, this->_size);
+	}
+
+	typename _view_type::const_view_type view() const{
+		return typename _view_type::const_view_type(this->_values, this->_size);
+	}
+};
+
+/// Starts a fused expression from a view, evaluated element by element
+/**
+ *	@param values Values to use in the expression
+ *	@return Expression of the values
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPointExpression<_fp_fused_array<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> > fp_fused(const FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& values){
+	return fp_fused(values.data());
+}
+
+/// Starts a fused expression from a read-only view, evaluated element by element
+/**
+ *	@param values Values to use in the expression
+ *	@return Expression of the values
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPointExpression<_fp_fused_array<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> > fp_fused(const FixedPointConstView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& values){
+	return fp_fused(values.data());
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator+(const FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& a, const FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& b){
+	FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> result(a);
+	result += b;
+	return result;
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator-(const FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& a, const FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& b){
+	FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> result(a);
+	result -= b;
+	return result;
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator*(const FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& a, const FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& b){
+	FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> result(a);
+	result *= b;
+	return result;
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator*(const FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& a, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& factor){
+	FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> result(a);
+	result *= factor;
+	return result;
+}
+
+///	Records of several FixedPoint components (e.g. x, y, z) stored as one aligned array per component
+/**
+ *	Operations on one component, such as x += vx * dt, stream through consecutive memory instead of
+ *	striding over whole records. Every component starts on an alignment boundary
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, count_type Components, typename OverflowPolicy = fp_wrap>
+class FixedPointSoA{
+public:
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	typedef FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> view_type;
+	typedef FixedPointConstView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> const_view_type;
+
+private:
+	value_type* _values;
+	size_t _size;
+	size_t _stride;
+
+	void _allocate(size_t size){
+		_size = size;
+		_stride = _fp_aligned_count(size, sizeof(value_type));
+		_values = _stride ? static_cast<value_type*>(_fp_aligned_alloc(_stride * Components * sizeof(value_type))) : 0;
+	}
+
+public:
+	/// Records of zeros
+	/**
+	 *	@param size Number of records
+	 */
+	explicit FixedPointSoA(size_t size = 0){
+		_allocate(size);
+		for (size_t i = 0; i < _stride * Components; i++){
+			_values[i] = value_type();
+		}
+	}
+
+	FixedPointSoA(const FixedPointSoA<IntegerType, IntegerBits, FractionalBits, Components, OverflowPolicy>& other){
+		_allocate(other._size);
+		for (size_t i = 0; i < _stride * Components; i++){
+			_values[i] = other._values[i];
+		}
+	}
+
+	#ifdef FIXEDPOINT_CPP0X
+		FixedPointSoA(FixedPointSoA<IntegerType, IntegerBits, FractionalBits, Components, OverflowPolicy>&& other) : _values(0), _size(0), _stride(0){
+			swap(other);
+		}
+
+		FixedPointSoA<IntegerType, IntegerBits, FractionalBits, Components, OverflowPolicy>& operator=(FixedPointSoA<IntegerType, IntegerBits, FractionalBits, Components, OverflowPolicy>&& other){
+			swap(other);
+			return *this;
+		}
+	#endif
+
+	~FixedPointSoA(){
+		_fp_aligned_free(_values);
+	}
+
+	FixedPointSoA<IntegerType, IntegerBits, FractionalBits, Components, OverflowPolicy>& operator=(const FixedPointSoA<IntegerType, IntegerBits, FractionalBits, Components, OverflowPolicy>& other){
+		if (this != &other){
+			FixedPointSoA<IntegerType, IntegerBits, FractionalBits, Components, OverflowPolicy> copy(other);
+			swap(copy);
+		}
+		return *this;
+	}
+
+	void swap(FixedPointSoA<IntegerType, IntegerBits, FractionalBits, Components, OverflowPolicy>& other){
+		value_type* const values = _values;
+		const size_t size = _size;
+		const size_t stride = _stride;
+		_values = other._values;
+		_size = other._size;
+		_stride = other._stride;
+		other._values = values;
+		other._size = size;
+		other._stride = stride;
+	}
+
+	/// Returns the number of records
+	size_t size() const{
+		return _size;
+	}
+
+	/// Returns the number of components of each record
+	static count_type components(){
+		return Components;
+	}
+
+	/// Returns a view of one component of every record
+	/**
+	 *	@param component Index of the component
+	 *	@return View of the component
+	 */
+	view_type component(count_type component){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (component >= Components){
+				_fp_event<value_type>(fp_event_range, "FixedPointSoA::component");
+			}
+		#endif
+		return view_type(_values + component * _stride, _size);
+	}
+
+	const_view_type component(count_type component) const{
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (component >= Components){
+				_fp_event<value_type>(fp_event_range, "FixedPointSoA::component");
+			}
+		#endif
+		return const_view_type(_values + component * _stride, _size);
+	}
+
+	/// Returns one component of one record
+	/**
+	 *	@param index Index of the record
+	 *	@param component Index of the component
+	 *	@return Component value
+	 */
+	value_type& operator()(size_t index, count_type component){
+		return _values[component * _stride + index];
+	}
+
+	const value_type& operator()(size_t index, count_type component) const{
+		return _values[component * _stride + index];
+	}
+};
+
+#endif//H_FP_ARRAY
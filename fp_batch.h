@@ -0,0 +1,384 @@
+/**
+ *	@file fp_batch.h
+ *	Adds arithmetic over arrays of FixedPoints
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_BATCH
+#define H_FP_BATCH
+
+#include <cstddef>
+
+#include "fp_fixedpoint.h"
+
+// Add the following line to your code before any #include "fp_*.h"
+// to only use the scalar loops, e.g. to compare results against them
+//#define FIXEDPOINT_NO_SIMD
+
+#ifndef FIXEDPOINT_NO_SIMD
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define FIXEDPOINT_SSE2
+		#include <emmintrin.h>
+	#endif
+
+	// AVX2 kernels are compiled in regardless of the target flags and picked at run time,
+	// unless the whole program is built for AVX2 anyway
+	#ifdef __AVX2__
+		#define FIXEDPOINT_AVX2
+		#include <immintrin.h>
+	#elif defined(FIXEDPOINT_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+		#define FIXEDPOINT_AVX2
+		#define FIXEDPOINT_AVX2_DISPATCH
+		#include <immintrin.h>
+	#endif
+#endif
+
+#ifdef FIXEDPOINT_AVX2_DISPATCH
+	#define FIXEDPOINT_AVX2_TARGET __attribute__((target("avx2")))
+#else
+	#define FIXEDPOINT_AVX2_TARGET
+#endif
+
+// Whether the AVX2 kernels may be used on this processor
+inline bool _fp_has_avx2(){
+	#ifdef FIXEDPOINT_AVX2_DISPATCH
+		return __builtin_cpu_supports("avx2");
+	#elif defined(FIXEDPOINT_AVX2)
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+// FixedPoint is a plain wrapper over its content, so arrays of it are arrays of IntegerType
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+IntegerType* _fp_raw(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* values){
+	#ifdef FIXEDPOINT_CPP0X
+		static_assert(sizeof(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>) == sizeof(IntegerType), "FixedPoint must have the size of its content");
+	#endif
+	return reinterpret_cast<IntegerType*>(values);
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+const IntegerType* _fp_raw(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* values){
+	#ifdef FIXEDPOINT_CPP0X
+		static_assert(sizeof(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>) == sizeof(IntegerType), "FixedPoint must have the size of its content");
+	#endif
+	return reinterpret_cast<const IntegerType*>(values);
+}
+
+// Kernels on raw content
+// mul_add computes out = ((a * b) >> shift) + c, where b == 0 multiplies by scalar instead and c == 0 adds nothing.
+// Every kernel handles out aliasing a, b, or c, and gives the same results as the overflow policy
+template<typename IntegerType, typename OverflowPolicy = fp_wrap>
+struct _fp_batch_scalar{
+	static void add(IntegerType* out, const IntegerType* a, const IntegerType* b, size_t count){
+		for (size_t i = 0; i < count; i++){
+			out[i] = OverflowPolicy::add(a[i], b[i]);
+		}
+	}
+
+	static void sub(IntegerType* out, const IntegerType* a, const IntegerType* b, size_t count){
+		for (size_t i = 0; i < count; i++){
+			out[i] = OverflowPolicy::sub(a[i], b[i]);
+		}
+	}
+
+	static void mul_add(IntegerType* out, const IntegerType* a, const IntegerType* b, IntegerType scalar, const IntegerType* c, size_t count, count_type shift){
+		for (size_t i = 0; i < count; i++){
+			const IntegerType product = OverflowPolicy::mul(a[i], b ? b[i] : scalar, shift);
+			out[i] = c ? OverflowPolicy::add(product, c[i]) : product;
+		}
+	}
+};
+
+template<typename IntegerType, typename OverflowPolicy>
+struct _fp_batch_kernel : _fp_batch_scalar<IntegerType, OverflowPolicy>{};
+
+#ifdef FIXEDPOINT_SSE2
+	// 16 bit content, 8 lanes per vector (16 with AVX2).
+	// The shifted product is rebuilt from the high and low halves (pmulhw and pmullw), which truncates it.
+	// The vector product kernels are only used when the rounding policy truncates, so they are bit-exact with
+	// FixedPoint::operator*, and the scalar loop rounds otherwise
+	template<typename IntegerType, bool _Signed>
+	struct _fp_batch_kernel16 : _fp_batch_scalar<IntegerType>{
+		static __m128i _mulhi(__m128i a, __m128i b){
+			return _Signed ? _mm_mulhi_epi16(a, b) : _mm_mulhi_epu16(a, b);
+		}
+
+		#ifdef FIXEDPOINT_AVX2
+			FIXEDPOINT_AVX2_TARGET
+			static size_t _mul_add_avx2(IntegerType* out, const IntegerType* a, const IntegerType* b, IntegerType scalar, const IntegerType* c, size_t count, count_type shift){
+				const __m128i high_shift = _mm_cvtsi32_si128(16 - shift);
+				const __m128i low_shift = _mm_cvtsi32_si128(shift);
+				const __m256i broadcast = _mm256_set1_epi16(short(scalar));
+
+				size_t i = 0;
+				for (; i + 16 <= count; i += 16){
+					const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+					const __m256i vb = b ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)) : broadcast;
+					const __m256i high = _Signed ? _mm256_mulhi_epi16(va, vb) : _mm256_mulhi_epu16(va, vb);
+
+					__m256i result = _mm256_or_si256(_mm256_sll_epi16(high, high_shift), _mm256_srl_epi16(_mm256_mullo_epi16(va, vb), low_shift));
+					if (c){
+						result = _mm256_add_epi16(result, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + i)));
+					}
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+				}
+				return i;
+			}
+		#endif
+
+		static void mul_add(IntegerType* out, const IntegerType* a, const IntegerType* b, IntegerType scalar, const IntegerType* c, size_t count, count_type shift){
+			const __m128i high_shift = _mm_cvtsi32_si128(16 - shift);
+			const __m128i low_shift = _mm_cvtsi32_si128(shift);
+			const __m128i broadcast = _mm_set1_epi16(short(scalar));
+
+			size_t i = 0;
+			#ifdef FIXEDPOINT_AVX2
+				if (_fp_has_avx2()){
+					i = _mul_add_avx2(out, a, b, scalar, c, count, shift);
+				}
+			#endif
+			for (; i + 8 <= count; i += 8){
+				const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+				const __m128i vb = b ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)) : broadcast;
+
+				__m128i result = _mm_or_si128(_mm_sll_epi16(_mulhi(va, vb), high_shift), _mm_srl_epi16(_mm_mullo_epi16(va, vb), low_shift));
+				if (c){
+					result = _mm_add_epi16(result, _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i)));
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+			}
+
+			_fp_batch_scalar<IntegerType>::mul_add(out + i, a + i, b ? b + i : 0, scalar, c ? c + i : 0, count - i, shift);
+		}
+	};
+
+	template<>
+	struct _fp_batch_kernel<short int, fp_wrap> : _fp_select<_fp_rounding::truncates, _fp_batch_kernel16<short int, true>, _fp_batch_scalar<short int> >::type{};
+
+	template<>
+	struct _fp_batch_kernel<unsigned short int, fp_wrap> : _fp_select<_fp_rounding::truncates, _fp_batch_kernel16<unsigned short int, false>, _fp_batch_scalar<unsigned short int> >::type{};
+
+	// Saturating 16 bit sums and differences map directly to paddsw and psubsw (paddusw and psubusw if unsigned).
+	// Products still go through the scalar loop, which saturates the full product before the addition
+	template<typename IntegerType, bool _Signed>
+	struct _fp_batch_saturate16 : _fp_batch_scalar<IntegerType, fp_saturate>{
+		static __m128i _add(__m128i a, __m128i b){
+			return _Signed ? _mm_adds_epi16(a, b) : _mm_adds_epu16(a, b);
+		}
+
+		static __m128i _sub(__m128i a, __m128i b){
+			return _Signed ? _mm_subs_epi16(a, b) : _mm_subs_epu16(a, b);
+		}
+
+		#ifdef FIXEDPOINT_AVX2
+			FIXEDPOINT_AVX2_TARGET
+			static size_t _add_sub_avx2(IntegerType* out, const IntegerType* a, const IntegerType* b, size_t count, bool subtract){
+				size_t i = 0;
+				for (; i + 16 <= count; i += 16){
+					const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+					const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+
+					__m256i result;
+					if (subtract){
+						result = _Signed ? _mm256_subs_epi16(va, vb) : _mm256_subs_epu16(va, vb);
+					}else{
+						result = _Signed ? _mm256_adds_epi16(va, vb) : _mm256_adds_epu16(va, vb);
+					}
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+				}
+				return i;
+			}
+		#endif
+
+		static void _add_sub(IntegerType* out, const IntegerType* a, const IntegerType* b, size_t count, bool subtract){
+			size_t i = 0;
+			#ifdef FIXEDPOINT_AVX2
+				if (_fp_has_avx2()){
+					i = _add_sub_avx2(out, a, b, count, subtract);
+				}
+			#endif
+			for (; i + 8 <= count; i += 8){
+				const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+				const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), subtract ? _sub(va, vb) : _add(va, vb));
+			}
+
+			if (subtract){
+				_fp_batch_scalar<IntegerType, fp_saturate>::sub(out + i, a + i, b + i, count - i);
+			}else{
+				_fp_batch_scalar<IntegerType, fp_saturate>::add(out + i, a + i, b + i, count - i);
+			}
+		}
+
+		static void add(IntegerType* out, const IntegerType* a, const IntegerType* b, size_t count){
+			_add_sub(out, a, b, count, false);
+		}
+
+		static void sub(IntegerType* out, const IntegerType* a, const IntegerType* b, size_t count){
+			_add_sub(out, a, b, count, true);
+		}
+	};
+
+	template<>
+	struct _fp_batch_kernel<short int, fp_saturate> : _fp_batch_saturate16<short int, true>{};
+
+	template<>
+	struct _fp_batch_kernel<unsigned short int, fp_saturate> : _fp_batch_saturate16<unsigned short int, false>{};
+
+	// 32 bit content, 4 lanes per vector (8 with AVX2).
+	// Even and odd lanes are multiplied into 64 bit products (pmuludq), shifted, and interleaved back.
+	// Only the low 32 bits of each shifted product are kept, so a logical shift works for signed values too.
+	// Signed products are corrected from the unsigned ones, which leaves SSE2 enough for both
+	template<typename IntegerType, bool _Signed>
+	struct _fp_batch_kernel32 : _fp_batch_scalar<IntegerType>{
+		static __m128i _mul_shift(__m128i a, __m128i b, __m128i shift){
+			const __m128i low_mask = _mm_set_epi32(0, -1, 0, -1);
+
+			__m128i even = _mm_mul_epu32(a, b);
+			__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+			if (_Signed){
+				const __m128i correction = _mm_add_epi32(_mm_and_si128(_mm_srai_epi32(a, 31), b), _mm_and_si128(_mm_srai_epi32(b, 31), a));
+				even = _mm_sub_epi64(even, _mm_slli_epi64(correction, 32));
+				odd = _mm_sub_epi64(odd, _mm_andnot_si128(low_mask, correction));
+			}
+
+			even = _mm_srl_epi64(even, shift);
+			odd = _mm_srl_epi64(odd, shift);
+			return _mm_or_si128(_mm_and_si128(even, low_mask), _mm_slli_epi64(odd, 32));
+		}
+
+		#ifdef FIXEDPOINT_AVX2
+			FIXEDPOINT_AVX2_TARGET
+			static __m256i _mul_shift(__m256i a, __m256i b, __m128i shift){
+				__m256i even = _Signed ? _mm256_mul_epi32(a, b) : _mm256_mul_epu32(a, b);
+				__m256i odd = _mm256_srli_epi64(a, 32);
+				odd = _Signed ? _mm256_mul_epi32(odd, _mm256_srli_epi64(b, 32)) : _mm256_mul_epu32(odd, _mm256_srli_epi64(b, 32));
+
+				even = _mm256_srl_epi64(even, shift);
+				odd = _mm256_srl_epi64(odd, shift);
+				return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+			}
+
+			FIXEDPOINT_AVX2_TARGET
+			static size_t _mul_add_avx2(IntegerType* out, const IntegerType* a, const IntegerType* b, IntegerType scalar, const IntegerType* c, size_t count, count_type shift){
+				const __m128i vshift = _mm_cvtsi32_si128(shift);
+				const __m256i broadcast = _mm256_set1_epi32(int(scalar));
+
+				size_t i = 0;
+				for (; i + 8 <= count; i += 8){
+					const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+					const __m256i vb = b ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)) : broadcast;
+
+					__m256i result = _mul_shift(va, vb, vshift);
+					if (c){
+						result = _mm256_add_epi32(result, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + i)));
+					}
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+				}
+				return i;
+			}
+		#endif
+
+		static void mul_add(IntegerType* out, const IntegerType* a, const IntegerType* b, IntegerType scalar, const IntegerType* c, size_t count, count_type shift){
+			const __m128i vshift = _mm_cvtsi32_si128(shift);
+			const __m128i broadcast = _mm_set1_epi32(int(scalar));
+
+			size_t i = 0;
+			#ifdef FIXEDPOINT_AVX2
+				if (_fp_has_avx2()){
+					i = _mul_add_avx2(out, a, b, scalar, c, count, shift);
+				}
+			#endif
+			for (; i + 4 <= count; i += 4){
+				const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+				const __m128i vb = b ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)) : broadcast;
+
+				__m128i result = _mul_shift(va, vb, vshift);
+				if (c){
+					result = _mm_add_epi32(result, _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i)));
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+			}
+
+			_fp_batch_scalar<IntegerType>::mul_add(out + i, a + i, b ? b + i : 0, scalar, c ? c + i : 0, count - i, shift);
+		}
+	};
+
+	template<>
+	struct _fp_batch_kernel<int, fp_wrap> : _fp_select<_fp_rounding::truncates, _fp_batch_kernel32<int, true>, _fp_batch_scalar<int> >::type{};
+
+	template<>
+	struct _fp_batch_kernel<unsigned int, fp_wrap> : _fp_select<_fp_rounding::truncates, _fp_batch_kernel32<unsigned int, false>, _fp_batch_scalar<unsigned int> >::type{};
+#endif
+
+/// Adds two arrays of FixedPoints element by element
+/**
+ *	out may be the same array as a or b
+ *	@param out Array receiving a[i] + b[i]
+ *	@param a First operands
+ *	@param b Second operands
+ *	@param count Number of elements in each array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_add(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* out, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* a, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* b, size_t count){
+	_fp_batch_kernel<IntegerType, OverflowPolicy>::add(_fp_raw(out), _fp_raw(a), _fp_raw(b), count);
+}
+
+/// Subtracts two arrays of FixedPoints element by element
+/**
+ *	out may be the same array as a or b
+ *	@param out Array receiving a[i] - b[i]
+ *	@param a First operands
+ *	@param b Second operands
+ *	@param count Number of elements in each array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_sub(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* out, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* a, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* b, size_t count){
+	_fp_batch_kernel<IntegerType, OverflowPolicy>::sub(_fp_raw(out), _fp_raw(a), _fp_raw(b), count);
+}
+
+/// Multiplies two arrays of FixedPoints element by element
+/**
+ *	Gives the same results as FixedPoint::operator*. out may be the same array as a or b
+ *	@param out Array receiving a[i] * b[i]
+ *	@param a First operands
+ *	@param b Second operands
+ *	@param count Number of elements in each array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_mul(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* out, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* a, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* b, size_t count){
+	_fp_batch_kernel<IntegerType, OverflowPolicy>::mul_add(_fp_raw(out), _fp_raw(a), _fp_raw(b), IntegerType(0), 0, count, FractionalBits);
+}
+
+/// Multiplies an array of FixedPoints by a single FixedPoint
+/**
+ *	out may be the same array as a
+ *	@param out Array receiving a[i] * factor
+ *	@param a Values to scale
+ *	@param factor Scale factor
+ *	@param count Number of elements in each array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_scale(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* out, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* a, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& factor, size_t count){
+	_fp_batch_kernel<IntegerType, OverflowPolicy>::mul_add(_fp_raw(out), _fp_raw(a), 0, factor(), 0, count, FractionalBits);
+}
+
+/// Multiplies two arrays of FixedPoints and adds a third, element by element
+/**
+ *	The product is rounded to the format by the rounding policy before the addition, like a * b + c would be.
+ *	out may be the same array as a, b, or c
+ *	@param out Array receiving a[i] * b[i] + c[i]
+ *	@param a First factors
+ *	@param b Second factors
+ *	@param c Addends
+ *	@param count Number of elements in each array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_fma(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* out, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* a, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* b, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* c, size_t count){
+	_fp_batch_kernel<IntegerType, OverflowPolicy>::mul_add(_fp_raw(out), _fp_raw(a), _fp_raw(b), IntegerType(0), _fp_raw(c), count, FractionalBits);
+}
+
+#endif//H_FP_BATCH
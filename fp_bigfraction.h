@@ -0,0 +1,1049 @@
+/**
+ *	@file fp_bigfraction.h
+ *	Adds an arbitrary precision fraction class, stored inline while its numerator and denominator fit in a long long
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_BIGFRACTION
+#define H_FP_BIGFRACTION
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "fp_fraction.h"
+#include "fp_chars.h"
+
+// Add the following line to your code before any #include "fp_*.h"
+// to change the largest block of limbs, a power of two, that each thread keeps for reuse once BigFractions release it.
+// Larger blocks always go back to the heap, and nothing is kept without C++11 thread_local
+//#define FIXEDPOINT_LIMB_POOL_MAX 1024
+#ifndef FIXEDPOINT_LIMB_POOL_MAX
+	#define FIXEDPOINT_LIMB_POOL_MAX 1024
+#endif
+
+// Smallest block of limbs, and number of blocks of each capacity kept for reuse
+static const size_t _fp_limb_block_min = 4;
+static const size_t _fp_limb_pool_depth = 32;
+
+#ifdef FIXEDPOINT_CPP0X
+	// Set once the calling thread's pool is destroyed, so that blocks released later (e.g. by static BigFractions) go back to the heap
+	inline bool& _fp_limb_pool_closed(){
+		static thread_local bool closed = false;
+		return closed;
+	}
+#endif
+
+// Blocks of limbs released on the calling thread, kept in one free list per power of two capacity,
+// linked through the first bytes of the blocks
+class _fp_limb_pool{
+	static const size_t _classes = std::numeric_limits<size_t>::digits;
+
+	void* _free[_classes];
+	size_t _count[_classes];
+
+	_fp_limb_pool(){
+		for (size_t i = 0; i < _classes; i++){
+			_free[i] = 0;
+			_count[i] = 0;
+		}
+	}
+
+	static _fp_limb_pool* _instance(){
+		#ifdef FIXEDPOINT_CPP0X
+			if (!_fp_limb_pool_closed()){
+				static thread_local _fp_limb_pool pool;
+				return &pool;
+			}
+		#endif
+		return 0;
+	}
+
+	static void* _next(void* block){
+		void* next;
+		std::memcpy(&next, block, sizeof(void*));
+		return next;
+	}
+
+public:
+	~_fp_limb_pool(){
+		for (size_t i = 0; i < _classes; i++){
+			while (_free[i]){
+				void* const next = _next(_free[i]);
+				std::free(_free[i]);
+				_free[i] = next;
+			}
+		}
+		#ifdef FIXEDPOINT_CPP0X
+			_fp_limb_pool_closed() = true;
+		#endif
+	}
+
+	/// Returns the capacity of the blocks allocated for a number of limbs
+	static size_t capacity(size_t limbs){
+		return size_t(1) << _fp_bit_length((limbs < _fp_limb_block_min ? _fp_limb_block_min : limbs) - 1);
+	}
+
+	/// Returns a block of at least capacity limbs
+	/**
+	 *	@param capacity Number of limbs needed, set to the capacity of the block
+	 *	@return Block, uninitialized
+	 */
+	static unsigned int* allocate(size_t& capacity){
+		capacity = _fp_limb_pool::capacity(capacity);
+		const count_type shift = _fp_bit_length(capacity - 1);
+		_fp_limb_pool* const pool = capacity <= FIXEDPOINT_LIMB_POOL_MAX ? _instance() : 0;
+		if (pool && pool->_free[shift]){
+			void* const block = pool->_free[shift];
+			pool->_free[shift] = _next(block);
+			--pool->_count[shift];
+			return static_cast<unsigned int*>(block);
+		}
+		void* const block = std::malloc(capacity * sizeof(unsigned int));
+		if (!block){
+			throw std::bad_alloc();
+		}
+		return static_cast<unsigned int*>(block);
+	}
+
+	/// Releases a block returned by allocate
+	/**
+	 *	@param limbs Block, or 0
+	 *	@param capacity Capacity of the block, as set by allocate
+	 */
+	static void release(unsigned int* limbs, size_t capacity){
+		if (!limbs){
+			return;
+		}
+		const count_type shift = _fp_bit_length(capacity - 1);
+		_fp_limb_pool* const pool = capacity <= FIXEDPOINT_LIMB_POOL_MAX ? _instance() : 0;
+		if (pool && pool->_count[shift] < _fp_limb_pool_depth){
+			std::memcpy(limbs, &pool->_free[shift], sizeof(void*));
+			pool->_free[shift] = limbs;
+			++pool->_count[shift];
+			return;
+		}
+		std::free(limbs);
+	}
+};
+
+// Compares two magnitudes in little endian limbs without leading zero limbs
+inline int _fp_limbs_compare(const unsigned int* a, size_t a_size, const unsigned int* b, size_t b_size){
+	if (a_size != b_size){
+		return a_size < b_size ? -1 : 1;
+	}
+	for (size_t i = a_size; i--;){
+		if (a[i] != b[i]){
+			return a[i] < b[i] ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+// result = a + b with a_size >= b_size, result has room for a_size + 1 limbs and may be a
+inline size_t _fp_limbs_add(unsigned int* result, const unsigned int* a, size_t a_size, const unsigned int* b, size_t b_size){
+	unsigned long long int carry = 0;
+	for (size_t i = 0; i < a_size; i++){
+		carry += (unsigned long long int)a[i] + (i < b_size ? b[i] : 0);
+		result[i] = static_cast<unsigned int>(carry);
+		carry >>= 32;
+	}
+	result[a_size] = static_cast<unsigned int>(carry);
+	return a_size + size_t(carry != 0);
+}
+
+// result = a - b with a >= b, result may be a
+inline void _fp_limbs_sub(unsigned int* result, const unsigned int* a, size_t a_size, const unsigned int* b, size_t b_size){
+	unsigned int borrow = 0;
+	for (size_t i = 0; i < a_size; i++){
+		const unsigned long long int difference = (unsigned long long int)a[i] - (i < b_size ? b[i] : 0) - borrow;
+		result[i] = static_cast<unsigned int>(difference);
+		borrow = static_cast<unsigned int>(difference >> 63);
+	}
+}
+
+/// Arbitrary precision integer used by BigFraction, a sign and a magnitude in little endian 32-bit limbs from the limb pool
+/**
+ *	The results of the static functions must be other objects than their arguments
+ */
+class _fp_bigint{
+	unsigned int* _limbs;
+	size_t _size;
+	size_t _capacity;
+	bool _negative;
+
+	// Makes room for capacity limbs, keeping the value
+	void _reserve(size_t capacity){
+		if (capacity <= _capacity){
+			return;
+		}
+		unsigned int* const limbs = _fp_limb_pool::allocate(capacity);
+		if (_size){
+			std::memcpy(limbs, _limbs, _size * sizeof(unsigned int));
+		}
+		_fp_limb_pool::release(_limbs, _capacity);
+		_limbs = limbs;
+		_capacity = capacity;
+	}
+
+	void _trim(){
+		while (_size && !_limbs[_size - 1]){
+			--_size;
+		}
+		if (!_size){
+			_negative = false;
+		}
+	}
+
+	count_type _trailing_zeros() const{
+		size_t i = 0;
+		while (!_limbs[i]){
+			++i;
+		}
+		return count_type(i * 32 + _fp_trailing_zeros(_limbs[i]));
+	}
+
+	void _shift_right(size_t bits){
+		const size_t limbs = bits / 32;
+		const count_type shift = count_type(bits % 32);
+		for (size_t i = 0; i + limbs < _size; i++){
+			const unsigned long long int pair = _limbs[i + limbs] | (i + limbs + 1 < _size ? (unsigned long long int)_limbs[i + limbs + 1] << 32 : 0);
+			_limbs[i] = static_cast<unsigned int>(pair >> shift);
+		}
+		_size -= limbs;
+		_trim();
+	}
+
+	void _shift_left(size_t bits){
+		if (!_size){
+			return;
+		}
+		const size_t limbs = bits / 32;
+		const count_type shift = count_type(bits % 32);
+		_reserve(_size + limbs + 1);
+		_limbs[_size + limbs] = 0;
+		for (size_t i = _size; i--;){
+			const unsigned long long int shifted = (unsigned long long int)_limbs[i] << shift;
+			_limbs[i + limbs + 1] |= static_cast<unsigned int>(shifted >> 32);
+			_limbs[i + limbs] = static_cast<unsigned int>(shifted);
+		}
+		for (size_t i = 0; i < limbs; i++){
+			_limbs[i] = 0;
+		}
+		_size += limbs + 1;
+		_trim();
+	}
+
+	// Knuth's algorithm D on magnitudes (Seminumerical Algorithms 4.3.1), with a.size() >= b.size() > 1
+	static void _divide(const _fp_bigint& a, const _fp_bigint& b, _fp_bigint& quotient, _fp_bigint& remainder){
+		const size_t m = a._size;
+		const size_t n = b._size;
+		const count_type shift = count_type(32 - _fp_bit_length(b._limbs[n - 1]));
+		_fp_bigint divisor(b);
+		divisor._shift_left(shift);
+		remainder = a;
+		remainder._negative = false;
+		remainder._shift_left(shift);
+		remainder._reserve(m + 1);
+		for (size_t i = remainder._size; i <= m; i++){
+			remainder._limbs[i] = 0;
+		}
+		quotient._reserve(m - n + 1);
+		const unsigned int* const v = divisor._limbs;
+		unsigned int* const u = remainder._limbs;
+		for (size_t j = m - n + 1; j--;){
+			const unsigned long long int top = ((unsigned long long int)u[j + n] << 32) | u[j + n - 1];
+			unsigned long long int estimate = top / v[n - 1];
+			unsigned long long int rest = top % v[n - 1];
+			while (estimate >> 32 || estimate * v[n - 2] > ((rest << 32) | u[j + n - 2])){
+				--estimate;
+				rest += v[n - 1];
+				if (rest >> 32){
+					break;
+				}
+			}
+			unsigned long long int carry = 0;
+			unsigned int borrow = 0;
+			for (size_t i = 0; i < n; i++){
+				const unsigned long long int product = estimate * v[i] + carry;
+				carry = product >> 32;
+				const unsigned long long int difference = (unsigned long long int)u[i + j] - static_cast<unsigned int>(product) - borrow;
+				u[i + j] = static_cast<unsigned int>(difference);
+				borrow = static_cast<unsigned int>(difference >> 63);
+			}
+			const unsigned long long int difference = (unsigned long long int)u[j + n] - carry - borrow;
+			u[j + n] = static_cast<unsigned int>(difference);
+			if (difference >> 63){
+				--estimate;
+				carry = 0;
+				for (size_t i = 0; i < n; i++){
+					carry += (unsigned long long int)u[i + j] + v[i];
+					u[i + j] = static_cast<unsigned int>(carry);
+					carry >>= 32;
+				}
+				u[j + n] += static_cast<unsigned int>(carry);
+			}
+			quotient._limbs[j] = static_cast<unsigned int>(estimate);
+		}
+		quotient._size = m - n + 1;
+		quotient._trim();
+		remainder._size = n;
+		remainder._trim();
+		remainder._shift_right(shift);
+	}
+
+public:
+	_fp_bigint() : _limbs(0), _size(0), _capacity(0), _negative(false){}
+
+	explicit _fp_bigint(long long int value) : _limbs(0), _size(0), _capacity(0), _negative(false){
+		set(_fp_magnitude(value), _fp_negative(value));
+	}
+
+	_fp_bigint(const _fp_bigint& other) : _limbs(0), _size(0), _capacity(0), _negative(false){
+		*this = other;
+	}
+
+	~_fp_bigint(){
+		_fp_limb_pool::release(_limbs, _capacity);
+	}
+
+	_fp_bigint& operator=(const _fp_bigint& other){
+		if (this != &other){
+			_size = 0;
+			_reserve(other._size);
+			if (other._size){
+				std::memcpy(_limbs, other._limbs, other._size * sizeof(unsigned int));
+			}
+			_size = other._size;
+			_negative = other._negative;
+		}
+		return *this;
+	}
+
+	void swap(_fp_bigint& other){
+		std::swap(_limbs, other._limbs);
+		std::swap(_size, other._size);
+		std::swap(_capacity, other._capacity);
+		std::swap(_negative, other._negative);
+	}
+
+	void set(unsigned long long int magnitude, bool negative){
+		_size = 0;
+		_reserve(2);
+		_limbs[0] = static_cast<unsigned int>(magnitude);
+		_limbs[1] = static_cast<unsigned int>(magnitude >> 32);
+		_size = 2;
+		_negative = negative;
+		_trim();
+	}
+
+	/// Gets the value if it fits in a long long int other than the most negative value, which has no opposite
+	bool get(long long int& value) const{
+		if (_size > 2){
+			return false;
+		}
+		const unsigned long long int magnitude = (_size > 0 ? _limbs[0] : 0) | (_size > 1 ? (unsigned long long int)_limbs[1] << 32 : 0);
+		if (magnitude > (unsigned long long int)std::numeric_limits<long long int>::max()){
+			return false;
+		}
+		value = _negative ? -(long long int)magnitude : (long long int)magnitude;
+		return true;
+	}
+
+	bool zero() const{
+		return _size == 0;
+	}
+
+	bool one() const{
+		return _size == 1 && _limbs[0] == 1 && !_negative;
+	}
+
+	bool negative() const{
+		return _negative;
+	}
+
+	void negate(){
+		_negative = _size && !_negative;
+	}
+
+	void abs(){
+		_negative = false;
+	}
+
+	int compare(const _fp_bigint& other) const{
+		if (_negative != other._negative){
+			return _negative ? -1 : 1;
+		}
+		const int magnitude = _fp_limbs_compare(_limbs, _size, other._limbs, other._size);
+		return _negative ? -magnitude : magnitude;
+	}
+
+	/// Returns the top 96 bits as a double, the value being about that times 2^exponent
+	double to_double(long int& exponent) const{
+		double value = 0;
+		const size_t first = _size > 3 ? _size - 3 : 0;
+		for (size_t i = _size; i-- > first;){
+			value = value * 4294967296.0 + _limbs[i];
+		}
+		exponent = long(first * 32);
+		return _negative ? -value : value;
+	}
+
+	/// result = a + b, or a - b
+	static void add(const _fp_bigint& a, const _fp_bigint& b, bool subtract, _fp_bigint& result){
+		const bool b_negative = b._size && b._negative != subtract;
+		const _fp_bigint* larger = &a;
+		const _fp_bigint* smaller = &b;
+		const int order = _fp_limbs_compare(a._limbs, a._size, b._limbs, b._size);
+		if (order < 0){
+			larger = &b;
+			smaller = &a;
+		}
+		result._size = 0;
+		result._reserve(larger->_size + 1);
+		if (a._negative == b_negative){
+			result._size = _fp_limbs_add(result._limbs, larger->_limbs, larger->_size, smaller->_limbs, smaller->_size);
+			result._negative = a._negative;
+		}else{
+			if (larger->_size){
+				_fp_limbs_sub(result._limbs, larger->_limbs, larger->_size, smaller->_limbs, smaller->_size);
+			}
+			result._size = larger->_size;
+			result._negative = order < 0 ? b_negative : a._negative;
+		}
+		result._trim();
+	}
+
+	/// result = a * b
+	static void mul(const _fp_bigint& a, const _fp_bigint& b, _fp_bigint& result){
+		result._size = 0;
+		if (!a._size || !b._size){
+			result._negative = false;
+			return;
+		}
+		result._reserve(a._size + b._size);
+		std::memset(result._limbs, 0, (a._size + b._size) * sizeof(unsigned int));
+		for (size_t i = 0; i < a._size; i++){
+			unsigned long long int carry = 0;
+			for (size_t j = 0; j < b._size; j++){
+				carry += (unsigned long long int)a._limbs[i] * b._limbs[j] + result._limbs[i + j];
+				result._limbs[i + j] = static_cast<unsigned int>(carry);
+				carry >>= 32;
+			}
+			result._limbs[i + b._size] = static_cast<unsigned int>(carry);
+		}
+		result._size = a._size + b._size;
+		result._negative = a._negative != b._negative;
+		result._trim();
+	}
+
+	/// quotient = a / b truncated toward zero, remainder = a - quotient * b, b must not be zero
+	static void divide(const _fp_bigint& a, const _fp_bigint& b, _fp_bigint& quotient, _fp_bigint& remainder){
+		if (_fp_limbs_compare(a._limbs, a._size, b._limbs, b._size) < 0){
+			remainder = a;
+			quotient._size = 0;
+			quotient._negative = false;
+			return;
+		}
+		if (b._size == 1){
+			quotient._size = 0;
+			quotient._reserve(a._size);
+			unsigned long long int rest = 0;
+			for (size_t i = a._size; i--;){
+				rest = (rest << 32) | a._limbs[i];
+				quotient._limbs[i] = static_cast<unsigned int>(rest / b._limbs[0]);
+				rest %= b._limbs[0];
+			}
+			quotient._size = a._size;
+			remainder.set(rest, false);
+		}else{
+			_divide(a, b, quotient, remainder);
+		}
+		quotient._negative = a._negative != b._negative;
+		quotient._trim();
+		remainder._negative = remainder._size && a._negative;
+	}
+
+	/// result = gcd(|a|, |b|), by Stein's binary algorithm after one division if the sizes differ
+	static void gcd(const _fp_bigint& a, const _fp_bigint& b, _fp_bigint& result){
+		_fp_bigint u(a);
+		_fp_bigint v(b);
+		u._negative = false;
+		v._negative = false;
+		if (u._size > v._size + 1 && v._size){
+			_fp_bigint quotient;
+			divide(a, b, quotient, u);
+			u._negative = false;
+		}else if (v._size > u._size + 1 && u._size){
+			_fp_bigint quotient;
+			divide(b, a, quotient, v);
+			v._negative = false;
+		}
+		if (!u._size || !v._size){
+			result = u._size ? u : v;
+			return;
+		}
+		const count_type u_zeros = u._trailing_zeros();
+		const count_type v_zeros = v._trailing_zeros();
+		u._shift_right(u_zeros);
+		do{
+			v._shift_right(v._trailing_zeros());
+			if (_fp_limbs_compare(u._limbs, u._size, v._limbs, v._size) > 0){
+				u.swap(v);
+			}
+			_fp_limbs_sub(v._limbs, v._limbs, v._size, u._limbs, u._size);
+			v._trim();
+		}while (v._size);
+		u._shift_left(u_zeros < v_zeros ? u_zeros : v_zeros);
+		result.swap(u);
+	}
+
+	/// Writes the value in decimal, returns one past the last character or 0 if it does not fit
+	char* to_chars(char* first, char* last) const{
+		if (!_size){
+			if (first == last){
+				return 0;
+			}
+			*first = '0';
+			return first + 1;
+		}
+		// Groups of 9 digits, least significant first
+		_fp_bigint groups;
+		groups._reserve(_size * 32 / 29 + 1);
+		_fp_bigint rest(*this);
+		while (rest._size){
+			unsigned long long int remainder = 0;
+			for (size_t i = rest._size; i--;){
+				remainder = (remainder << 32) | rest._limbs[i];
+				rest._limbs[i] = static_cast<unsigned int>(remainder / 1000000000);
+				remainder %= 1000000000;
+			}
+			rest._trim();
+			groups._limbs[groups._size++] = static_cast<unsigned int>(remainder);
+		}
+		char top[9];
+		size_t top_digits = 0;
+		for (unsigned int value = groups._limbs[groups._size - 1]; value; value /= 10){
+			top[top_digits++] = char('0' + value % 10);
+		}
+		const size_t length = size_t(_negative) + top_digits + (groups._size - 1) * 9;
+		if (size_t(last - first) < length){
+			return 0;
+		}
+		if (_negative){
+			*first++ = '-';
+		}
+		while (top_digits){
+			*first++ = top[--top_digits];
+		}
+		for (size_t i = groups._size - 1; i--;){
+			unsigned int value = groups._limbs[i];
+			for (size_t digit = 9; digit--; value /= 10){
+				first[digit] = char('0' + value % 10);
+			}
+			first += 9;
+		}
+		return first;
+	}
+};
+
+// Numerator and denominator of a BigFraction that does not fit inline
+struct _fp_bigrational{
+	_fp_bigint numerator;
+	_fp_bigint denominator;
+};
+
+/// A fraction of arbitrary precision, always in lowest terms with a positive denominator
+/**
+ *	While the numerator and the denominator fit in a long long int, they are stored inline and the arithmetic is that of
+ *	Fraction<long long int>, checked for overflow. Results that do not fit spill to limbs from a pool kept by each thread,
+ *	and return inline as soon as they fit again.
+ *	sizeof(BigFraction) == 2 * sizeof(long long int) + sizeof(void*)
+ */
+class BigFraction{
+	typedef _fp_int_traits<long long int>::wide_type wide_type;
+
+	long long int _numerator;
+	long long int _denominator;
+	_fp_bigrational* _big;
+
+	// Whether a magnitude fits inline, the most negative value is excluded so that every inline value has an opposite
+	static bool _fits(unsigned long long int magnitude){
+		return magnitude <= (unsigned long long int)std::numeric_limits<long long int>::max();
+	}
+
+	// Whether products of two magnitudes below this bound, and their sums, fit in a long long int
+	static bool _small(unsigned long long int magnitude){
+		return (magnitude >> ((std::numeric_limits<long long int>::digits - 1) / 2)) == 0;
+	}
+
+	static bool _fits(wide_type value){
+		return value <= wide_type(std::numeric_limits<long long int>::max()) && value >= -wide_type(std::numeric_limits<long long int>::max());
+	}
+
+	static _fp_bigrational* _new_big(){
+		size_t capacity = (sizeof(_fp_bigrational) + sizeof(unsigned int) - 1) / sizeof(unsigned int);
+		return new (_fp_limb_pool::allocate(capacity)) _fp_bigrational();
+	}
+
+	static void _delete_big(_fp_bigrational* big){
+		if (big){
+			big->~_fp_bigrational();
+			_fp_limb_pool::release(reinterpret_cast<unsigned int*>(big), _fp_limb_pool::capacity((sizeof(_fp_bigrational) + sizeof(unsigned int) - 1) / sizeof(unsigned int)));
+		}
+	}
+
+	// Sets an inline value from magnitudes already in lowest terms, or returns false if they do not fit
+	bool _set(unsigned long long int numer, bool negative, unsigned long long int denom){
+		if (!_fits(numer) || !_fits(denom)){
+			return false;
+		}
+		_delete_big(_big);
+		_big = 0;
+		_numerator = negative ? -(long long int)numer : (long long int)numer;
+		_denominator = (long long int)denom;
+		return true;
+	}
+
+	// Sets a value from magnitudes in any terms
+	void _assign(unsigned long long int numer, bool negative, unsigned long long int denom){
+		const unsigned long long int divisor = _fp_gcd(numer, denom);
+		if (divisor > 1){
+			numer /= divisor;
+			denom /= divisor;
+		}
+		if (!_set(numer, negative && numer, denom)){
+			_fp_bigrational* const big = _big ? _big : _new_big();
+			big->numerator.set(numer, negative && numer);
+			big->denominator.set(denom, false);
+			_big = big;
+		}
+	}
+
+	// Sets the value from a wide intermediate in lowest terms, or returns false if it does not fit inline
+	bool _set(wide_type numer, wide_type denom){
+		if (!_fits(numer) || !_fits(denom)){
+			return false;
+		}
+		_numerator = (long long int)numer;
+		_denominator = (long long int)denom;
+		return true;
+	}
+
+	// Returns the value as limbs, in temporary if inline
+	const _fp_bigrational& _limbs(_fp_bigrational& temporary) const{
+		if (_big){
+			return *_big;
+		}
+		temporary.numerator.set(_fp_magnitude(_numerator), _numerator < 0);
+		temporary.denominator.set((unsigned long long int)_denominator, false);
+		return temporary;
+	}
+
+	// Takes a result computed in limbs, back inline if it fits
+	void _take(_fp_bigrational& result){
+		long long int numer = 0;
+		long long int denom = 0;
+		if (result.numerator.get(numer) && result.denominator.get(denom)){
+			_delete_big(_big);
+			_big = 0;
+			_numerator = numer;
+			_denominator = denom;
+			return;
+		}
+		if (!_big){
+			_big = _new_big();
+		}
+		_big->numerator.swap(result.numerator);
+		_big->denominator.swap(result.denominator);
+	}
+
+	// Whether an operation with numer / denom can be computed directly, as by Fraction<long long int>
+	bool _small(long long int numer, long long int denom) const{
+		return !_big && _small(_fp_magnitude(_numerator) | (unsigned long long int)_denominator | _fp_magnitude(numer) | (unsigned long long int)denom);
+	}
+
+	// Sets the value from a numerator and a positive denominator that fit inline
+	void _reduce(long long int numer, long long int denom){
+		const unsigned long long int divisor = _fp_gcd(_fp_magnitude(numer), (unsigned long long int)denom);
+		_numerator = divisor > 1 ? numer / (long long int)divisor : numer;
+		_denominator = divisor > 1 ? denom / (long long int)divisor : denom;
+	}
+
+	// Inline a/b + c/d while the operands are small
+	void _add_small(long long int numer, long long int denom, bool subtract){
+		if (_denominator == denom){
+			_reduce(subtract ? _numerator - numer : _numerator + numer, denom);
+		}else{
+			_reduce(subtract ? _numerator * denom - numer * _denominator : _numerator * denom + numer * _denominator, _denominator * denom);
+		}
+	}
+
+	// Inline a/b + c/d in the wide type as in Knuth 4.5.1, returns false if the result does not fit inline
+	bool _add_wide(long long int numer, long long int denom, bool subtract){
+		if (_big || !_fp_int_traits<long long int>::native_wide){
+			return false;
+		}
+		const unsigned long long int common = _fp_gcd((unsigned long long int)_denominator, (unsigned long long int)denom);
+		const long long int left = _denominator / (long long int)common;
+		const long long int right = denom / (long long int)common;
+		wide_type sum = subtract ? wide_type(_numerator) * right - wide_type(numer) * left : wide_type(_numerator) * right + wide_type(numer) * left;
+		const unsigned long long int divisor = common > 1 ? _fp_gcd((unsigned long long int)(_fp_magnitude(sum) % common), common) : 1;
+		if (divisor > 1){
+			sum /= wide_type(divisor);
+			denom /= (long long int)divisor;
+		}
+		return _set(sum, wide_type(left) * denom);
+	}
+
+	// Inline a/b * c/d in the wide type, cancelling across as in Knuth 4.5.1. Returns false if the result does not fit inline
+	bool _mul_wide(long long int numer, long long int denom){
+		if (_big || !_fp_int_traits<long long int>::native_wide){
+			return false;
+		}
+		const unsigned long long int first = _fp_gcd(_fp_magnitude(_numerator), (unsigned long long int)denom);
+		const unsigned long long int second = _fp_gcd(_fp_magnitude(numer), (unsigned long long int)_denominator);
+		return _set(wide_type(_numerator / (long long int)first) * (numer / (long long int)second), wide_type(_denominator / (long long int)second) * (denom / (long long int)first));
+	}
+
+	static void _add(const _fp_bigrational& a, const _fp_bigrational& b, bool subtract, _fp_bigrational& result){
+		_fp_bigint common;
+		_fp_bigint::gcd(a.denominator, b.denominator, common);
+		_fp_bigint left;
+		_fp_bigint right;
+		_fp_bigint remainder;
+		_fp_bigint::divide(a.denominator, common, left, remainder);
+		_fp_bigint::divide(b.denominator, common, right, remainder);
+		_fp_bigint first;
+		_fp_bigint second;
+		_fp_bigint::mul(a.numerator, right, first);
+		_fp_bigint::mul(b.numerator, left, second);
+		_fp_bigint sum;
+		_fp_bigint::add(first, second, subtract, sum);
+		_fp_bigint divisor;
+		_fp_bigint::gcd(sum, common, divisor);
+		if (divisor.one()){
+			result.numerator.swap(sum);
+			_fp_bigint::mul(left, b.denominator, result.denominator);
+		}else{
+			_fp_bigint::divide(sum, divisor, result.numerator, remainder);
+			_fp_bigint::divide(b.denominator, divisor, right, remainder);
+			_fp_bigint::mul(left, right, result.denominator);
+		}
+		if (result.numerator.zero()){
+			result.denominator.set(1, false);
+		}
+	}
+
+	static void _mul(const _fp_bigrational& a, const _fp_bigint& numer, const _fp_bigint& denom, _fp_bigrational& result){
+		_fp_bigint first;
+		_fp_bigint second;
+		_fp_bigint::gcd(a.numerator, denom, first);
+		_fp_bigint::gcd(numer, a.denominator, second);
+		_fp_bigint left;
+		_fp_bigint right;
+		_fp_bigint remainder;
+		_fp_bigint::divide(a.numerator, first, left, remainder);
+		_fp_bigint::divide(numer, second, right, remainder);
+		_fp_bigint::mul(left, right, result.numerator);
+		_fp_bigint::divide(a.denominator, second, left, remainder);
+		_fp_bigint::divide(denom, first, right, remainder);
+		_fp_bigint::mul(left, right, result.denominator);
+		if (result.denominator.negative()){
+			result.numerator.negate();
+			result.denominator.negate();
+		}
+		if (result.numerator.zero()){
+			result.denominator.set(1, false);
+		}
+	}
+
+	void _add(const BigFraction& other, bool subtract){
+		if (!other._big && _add_wide(other._numerator, other._denominator, subtract)){
+			return;
+		}
+		_fp_bigrational left;
+		_fp_bigrational right;
+		_fp_bigrational result;
+		_add(_limbs(left), other._limbs(right), subtract, result);
+		_take(result);
+	}
+
+	void _mul(const BigFraction& other){
+		if (!other._big && _mul_wide(other._numerator, other._denominator)){
+			return;
+		}
+		_fp_bigrational left;
+		_fp_bigrational right;
+		_fp_bigrational result;
+		const _fp_bigrational& operand = other._limbs(right);
+		_mul(_limbs(left), operand.numerator, operand.denominator, result);
+		_take(result);
+	}
+
+	void _div(const BigFraction& other){
+		// The reciprocal of an inline value is inline, its numerator is never the most negative value
+		if (!other._big && _mul_wide(other._numerator < 0 ? -other._denominator : other._denominator, other._numerator < 0 ? -other._numerator : other._numerator)){
+			return;
+		}
+		_fp_bigrational left;
+		_fp_bigrational right;
+		_fp_bigrational result;
+		const _fp_bigrational& operand = other._limbs(right);
+		_mul(_limbs(left), operand.denominator, operand.numerator, result);
+		_take(result);
+	}
+
+	int _compare(const BigFraction& other) const{
+		if (!_big && !other._big){
+			if (_denominator == other._denominator){
+				return _numerator < other._numerator ? -1 : (_numerator > other._numerator ? 1 : 0);
+			}
+			if (_fp_int_traits<long long int>::native_wide){
+				const wide_type left = wide_type(_numerator) * other._denominator;
+				const wide_type right = wide_type(other._numerator) * _denominator;
+				return left < right ? -1 : (left > right ? 1 : 0);
+			}
+		}
+		_fp_bigrational left;
+		_fp_bigrational right;
+		const _fp_bigrational& a = _limbs(left);
+		const _fp_bigrational& b = other._limbs(right);
+		_fp_bigint first;
+		_fp_bigint second;
+		_fp_bigint::mul(a.numerator, b.denominator, first);
+		_fp_bigint::mul(b.numerator, a.denominator, second);
+		return first.compare(second);
+	}
+
+public:
+	/// Construct 0
+	BigFraction() : _numerator(0), _denominator(1), _big(0){}
+
+	/// Construct a BigFraction from a numerator and a denominator, reduced to lowest terms
+	/**
+	 *	@param numer Numerator
+	 *	@param denom Denominator, a denominator of zero is undefined
+	 */
+	BigFraction(long long int numer, long long int denom = 1) : _numerator(0), _denominator(1), _big(0){
+		_assign(_fp_magnitude(numer), _fp_negative(numer) != _fp_negative(denom), _fp_magnitude(denom));
+	}
+
+	/// Construct a BigFraction with the value of a Fraction of at most 64 bits
+	/**
+	 *	@param other Fraction to copy, a denominator of zero is undefined
+	 */
+	template<typename IntegerType>
+	explicit BigFraction(const Fraction<IntegerType>& other) : _numerator(0), _denominator(1), _big(0){
+		_assign((unsigned long long int)_fp_magnitude(other.numerator()), _fp_negative(other.numerator()) != _fp_negative(other.denominator()), (unsigned long long int)_fp_magnitude(other.denominator()));
+	}
+
+	BigFraction(const BigFraction& other) : _numerator(other._numerator), _denominator(other._denominator), _big(0){
+		if (other._big){
+			_big = _new_big();
+			*_big = *other._big;
+		}
+	}
+
+	#ifdef FIXEDPOINT_CPP0X
+		BigFraction(BigFraction&& other) : _numerator(other._numerator), _denominator(other._denominator), _big(other._big){
+			other._big = 0;
+		}
+
+		BigFraction& operator=(BigFraction&& other){
+			swap(other);
+			return *this;
+		}
+	#endif
+
+	~BigFraction(){
+		_delete_big(_big);
+	}
+
+	BigFraction& operator=(const BigFraction& other){
+		if (this != &other){
+			if (!other._big){
+				_delete_big(_big);
+				_big = 0;
+			}else if (_big){
+				*_big = *other._big;
+			}else{
+				BigFraction copy(other);
+				swap(copy);
+				return *this;
+			}
+			_numerator = other._numerator;
+			_denominator = other._denominator;
+		}
+		return *this;
+	}
+
+	void swap(BigFraction& other){
+		std::swap(_numerator, other._numerator);
+		std::swap(_denominator, other._denominator);
+		std::swap(_big, other._big);
+	}
+
+	/// Whether the numerator and the denominator are stored inline
+	bool is_inline() const{
+		return !_big;
+	}
+
+	/// Gets the numerator and the denominator if they are stored inline
+	/**
+	 *	@param numer Set to the numerator
+	 *	@param denom Set to the denominator, always positive
+	 *	@return False if they do not fit in a long long int, then nothing is set
+	 */
+	bool get(long long int& numer, long long int& denom) const{
+		if (_big){
+			return false;
+		}
+		numer = _numerator;
+		denom = _denominator;
+		return true;
+	}
+
+	/// Returns -1, 0 or 1 as the value is negative, zero or positive
+	int sign() const{
+		if (_big){
+			return _big->numerator.negative() ? -1 : (_big->numerator.zero() ? 0 : 1);
+		}
+		return _numerator < 0 ? -1 : (_numerator > 0 ? 1 : 0);
+	}
+
+	/// Returns the value as a double, from the top 64 to 96 bits of the numerator and the denominator
+	double to_double() const{
+		if (_big){
+			long int numerator_exponent = 0;
+			long int denominator_exponent = 0;
+			const double quotient = _big->numerator.to_double(numerator_exponent) / _big->denominator.to_double(denominator_exponent);
+			const long int exponent = numerator_exponent - denominator_exponent;
+			return std::ldexp(quotient, int(exponent < -100000 ? -100000 : (exponent > 100000 ? 100000 : exponent)));
+		}
+		return double(_numerator) / double(_denominator);
+	}
+
+	BigFraction& operator+=(const BigFraction& other){
+		if (!other._big && _small(other._numerator, other._denominator)){
+			_add_small(other._numerator, other._denominator, false);
+		}else{
+			_add(other, false);
+		}
+		return *this;
+	}
+
+	BigFraction& operator-=(const BigFraction& other){
+		if (!other._big && _small(other._numerator, other._denominator)){
+			_add_small(other._numerator, other._denominator, true);
+		}else{
+			_add(other, true);
+		}
+		return *this;
+	}
+
+	BigFraction& operator*=(const BigFraction& other){
+		if (!other._big && _small(other._numerator, other._denominator)){
+			_reduce(_numerator * other._numerator, _denominator * other._denominator);
+		}else{
+			_mul(other);
+		}
+		return *this;
+	}
+
+	/// Divides by other, dividing by zero is undefined
+	BigFraction& operator/=(const BigFraction& other){
+		if (!other._big && _small(other._numerator, other._denominator)){
+			_reduce(other._numerator < 0 ? -_numerator * other._denominator : _numerator * other._denominator, _denominator * (other._numerator < 0 ? -other._numerator : other._numerator));
+		}else{
+			_div(other);
+		}
+		return *this;
+	}
+
+	BigFraction operator+(const BigFraction& other) const{
+		return BigFraction(*this) += other;
+	}
+
+	BigFraction operator-(const BigFraction& other) const{
+		return BigFraction(*this) -= other;
+	}
+
+	BigFraction operator*(const BigFraction& other) const{
+		return BigFraction(*this) *= other;
+	}
+
+	BigFraction operator/(const BigFraction& other) const{
+		return BigFraction(*this) /= other;
+	}
+
+	BigFraction operator-() const{
+		BigFraction result(*this);
+		if (result._big){
+			result._big->numerator.negate();
+		}else{
+			result._numerator = -result._numerator;
+		}
+		return result;
+	}
+
+	bool operator==(const BigFraction& other) const{
+		if (!_big && !other._big){
+			return _numerator == other._numerator && _denominator == other._denominator;
+		}
+		return _compare(other) == 0;
+	}
+
+	bool operator!=(const BigFraction& other) const{
+		return !operator==(other);
+	}
+
+	bool operator<(const BigFraction& other) const{
+		return _compare(other) < 0;
+	}
+
+	bool operator<=(const BigFraction& other) const{
+		return _compare(other) <= 0;
+	}
+
+	bool operator>(const BigFraction& other) const{
+		return _compare(other) > 0;
+	}
+
+	bool operator>=(const BigFraction& other) const{
+		return _compare(other) >= 0;
+	}
+
+	friend fp_to_chars_result fp_to_chars(char* first, char* last, const BigFraction& value);
+};
+
+/// Writes a BigFraction exactly as "numerator/denominator", or only the numerator if the denominator is 1
+/**
+ *	@param first Start of the buffer
+ *	@param last End of the buffer
+ *	@param value Value to write
+ *	@return One past the last character written, and fp_chars_ok or fp_chars_buffer_too_small
+ */
+inline fp_to_chars_result fp_to_chars(char* first, char* last, const BigFraction& value){
+	fp_to_chars_result result = {last, fp_chars_buffer_too_small};
+	_fp_bigrational temporary;
+	const _fp_bigrational& limbs = value._limbs(temporary);
+	char* end = limbs.numerator.to_chars(first, last);
+	if (end && !limbs.denominator.one()){
+		if (end == last){
+			return result;
+		}
+		*end = '/';
+		end = limbs.denominator.to_chars(end + 1, last);
+	}
+	if (end){
+		result.ptr = end;
+		result.status = fp_chars_ok;
+	}
+	return result;
+}
+
+#endif//H_FP_BIGFRACTION
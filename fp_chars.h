@@ -0,0 +1,403 @@
+/**
+ *	@file fp_chars.h
+ *	Adds exact conversions between FixedPoints and decimal text, without allocating
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_CHARS
+#define H_FP_CHARS
+
+#include <cstddef>
+
+#include "fp_batch.h"
+
+/// Outcome of a conversion to or from text
+enum fp_chars_status{
+	fp_chars_ok,
+	fp_chars_invalid,			///< No number at the start of the text
+	fp_chars_out_of_range,		///< The number does not fit in the format, the value was given by the overflow policy
+	fp_chars_buffer_too_small	///< The text does not fit in the buffer, nothing was written
+};
+
+/// Result of fp_to_chars
+struct fp_to_chars_result{
+	char* ptr;					///< One past the last character written, or the end of the buffer if it was too small
+	fp_chars_status status;
+};
+
+/// Result of fp_from_chars
+struct fp_from_chars_result{
+	const char* ptr;			///< One past the last character read, or the start of the text if there was no number
+	fp_chars_status status;
+};
+
+// Decimal digits of the fraction kept when parsing. A midpoint between two values with F fractional bits
+// has F + 1 decimal digits, so F + 1 digits and whether any later digit is non-zero always round correctly
+static const size_t _fp_chars_fraction_digits = std::numeric_limits<unsigned long long int>::digits + 1;
+
+// The fraction is kept as base 10^8 limbs, most significant first
+static const unsigned int _fp_chars_limb = 100000000;
+static const size_t _fp_chars_limbs = (_fp_chars_fraction_digits + 7) / 8;
+
+inline bool _fp_chars_digit(char c){
+	return c >= '0' && c <= '9';
+}
+
+// Reads 8 digits at text into value, returns false without reading if they are not all digits. text must have 8 readable characters
+inline bool _fp_chars_digits8(const char* text, unsigned int& value){
+	#ifdef FIXEDPOINT_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i digits = _mm_sub_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(text)), _mm_set1_epi8('0'));
+		// Characters below '0' wrap to large unsigned values, so one saturated subtraction checks both ends
+		if ((_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(digits, _mm_set1_epi8(9)), zero)) & 0xFF) != 0xFF){
+			return false;
+		}
+
+		// Pairs of digits, then pairs of pairs, each by a multiply-add of adjacent lanes
+		const __m128i pairs = _mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), _mm_set_epi16(1, 10, 1, 10, 1, 10, 1, 10));
+		const __m128i quads = _mm_madd_epi16(_mm_packs_epi32(pairs, pairs), _mm_set_epi16(1, 100, 1, 100, 1, 100, 1, 100));
+		value = static_cast<unsigned int>(_mm_cvtsi128_si32(quads)) * 10000 + static_cast<unsigned int>(_mm_cvtsi128_si32(_mm_srli_si128(quads, 4)));
+		return true;
+	#else
+		unsigned int result = 0;
+		for (size_t i = 0; i < 8; i++){
+			if (!_fp_chars_digit(text[i])){
+				return false;
+			}
+			result = result * 10 + static_cast<unsigned int>(text[i] - '0');
+		}
+		value = result;
+		return true;
+	#endif
+}
+
+// Multiplies the fraction in (0, 1) given by limbs by 2^shift, 0 < shift <= 32, and returns the integer part that comes out
+inline unsigned long long int _fp_chars_double(unsigned int* limbs, size_t count, count_type shift){
+	unsigned long long int carry = 0;
+	for (size_t i = count; i--;){
+		const unsigned long long int scaled = (static_cast<unsigned long long int>(limbs[i]) << shift) + carry;
+		limbs[i] = static_cast<unsigned int>(scaled % _fp_chars_limb);
+		carry = scaled / _fp_chars_limb;
+	}
+	return carry;
+}
+
+// Multiplies the fraction / 2^FractionalBits by 10, returns the digit that comes out and keeps the rest in fraction
+template<typename UnsignedType>
+inline char _fp_chars_next_digit(UnsignedType& fraction, count_type fractional_bits){
+	const count_type bits = std::numeric_limits<UnsignedType>::digits;
+	UnsignedType high = 0, low = 0;
+	_fp_wide_arith<UnsignedType>::mul_full(fraction, UnsignedType(10), high, low);
+	if (fractional_bits == bits){
+		fraction = low;
+		return char('0' + high);
+	}
+	fraction = UnsignedType(low & ((UnsignedType(1) << fractional_bits) - 1));
+	return char('0' + ((high << (bits - fractional_bits)) | (low >> fractional_bits)));
+}
+
+// Adds one to the last of count digits, returns whether it carried out of the first
+inline bool _fp_chars_increment(char* digits, size_t count){
+	for (char* digit = digits + count; digit != digits;){
+		if (*--digit != '9'){
+			++*digit;
+			return false;
+		}
+		*digit = '0';
+	}
+	return true;
+}
+
+// Writes the shortest text that reads back as value, or the text with precision decimals if fixed
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+fp_to_chars_result _fp_to_chars(char* first, char* last, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& value, bool fixed, size_t precision){
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+	const count_type bits = std::numeric_limits<unsigned_type>::digits;
+
+	const unsigned_type magnitude = _fp_magnitude(value());
+	unsigned_type integer = FractionalBits < bits ? unsigned_type(magnitude >> (FractionalBits % bits)) : unsigned_type(0);
+	unsigned_type fraction = FractionalBits ? unsigned_type(magnitude & unsigned_type(unsigned_type(~unsigned_type(0)) >> (bits - FractionalBits))) : unsigned_type(0);
+
+	// Every digit of the exact value is generated, since it has at most FractionalBits of them
+	char digits[FractionalBits + 1];
+	size_t count = 0;
+	bool carry = false;
+	if (fixed){
+		const size_t generated = precision < FractionalBits ? precision : FractionalBits;
+		while (count < generated){
+			digits[count++] = _fp_chars_next_digit(fraction, FractionalBits);
+		}
+
+		// Halves round to an even last digit, which is the integer part if there are no decimals
+		if (fraction){
+			const unsigned_type half = unsigned_type(1) << ((FractionalBits + bits - 1) % bits);
+			const bool odd = count ? ((digits[count - 1] - '0') & 1) != 0 : (integer & 1) != 0;
+			if (fraction > half || (fraction == half && odd)){
+				carry = _fp_chars_increment(digits, count);
+			}
+		}
+	}else if (fraction){
+		// Stops at the first length where the value rounded down or up is strictly within half a unit in the last place of the format.
+		// tolerance is that half unit, in units of 2^-FractionalBits scaled by 10^count, and saturates once it exceeds half of the range
+		const unsigned_type half = unsigned_type(1) << ((FractionalBits + bits - 1) % bits);
+		unsigned_type tolerance = 5;
+		bool saturated = tolerance > half;
+		for (;;){
+			digits[count++] = _fp_chars_next_digit(fraction, FractionalBits);
+			// 2^FractionalBits - fraction, which wraps correctly when FractionalBits is the full width
+			const unsigned_type above = unsigned_type((FractionalBits < bits ? (unsigned_type(1) << (FractionalBits % bits)) : unsigned_type(0)) - fraction);
+			const bool down = fraction == 0 || saturated || fraction < tolerance;
+			const bool up = fraction != 0 && (saturated || above < tolerance);
+			if (down || up){
+				if (up && (!down || above < fraction)){
+					carry = _fp_chars_increment(digits, count);
+				}
+				break;
+			}
+			if (tolerance > half / 10){
+				saturated = true;
+			}else{
+				tolerance = unsigned_type(tolerance * 10);
+			}
+		}
+		// Rounding up may leave trailing zeros
+		while (count && digits[count - 1] == '0'){
+			--count;
+		}
+	}
+	if (carry){
+		++integer;
+	}
+
+	char integer_digits[std::numeric_limits<unsigned_type>::digits10 + 1];
+	size_t integer_count = 0;
+	do{
+		integer_digits[integer_count++] = char('0' + integer % 10);
+		integer /= 10;
+	}while (integer);
+
+	const size_t decimals = fixed ? precision : count;
+	const size_t length = size_t(_fp_negative(value())) + integer_count + (decimals ? decimals + 1 : 0);
+	if (size_t(last - first) < length){
+		fp_to_chars_result result = {last, fp_chars_buffer_too_small};
+		return result;
+	}
+
+	char* out = first;
+	if (_fp_negative(value())){
+		*out++ = '-';
+	}
+	while (integer_count){
+		*out++ = integer_digits[--integer_count];
+	}
+	if (decimals){
+		*out++ = '.';
+		// Without fractional bits only padding zeros are written, and digits is never read
+		for (size_t i = 0; i < decimals; i++){
+			*out++ = FractionalBits && i < count ? digits[i] : '0';
+		}
+	}
+	fp_to_chars_result result = {out, fp_chars_ok};
+	return result;
+}
+
+/// Writes a FixedPoint as the shortest decimal text that reads back as the same value
+/**
+ *	The text is in fixed notation, e.g. "-12.375" or "3", and fp_from_chars gives back exactly the same value.
+ *	Nothing is written if it does not fit between first and last
+ *	@param first Start of the buffer
+ *	@param last End of the buffer
+ *	@param value Value to write
+ *	@return One past the last character written, and the status
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+fp_to_chars_result fp_to_chars(char* first, char* last, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& value){
+	return _fp_to_chars(first, last, value, false, 0);
+}
+
+/// Writes a FixedPoint with a fixed number of decimals
+/**
+ *	The exact value is rounded to the nearest decimal, with halves to even as by printf, e.g. 2.5 with no decimals is "2".
+ *	With at least FractionalBits decimals, the text is the exact value
+ *	@param first Start of the buffer
+ *	@param last End of the buffer
+ *	@param value Value to write
+ *	@param precision Number of decimals
+ *	@return One past the last character written, and the status
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+fp_to_chars_result fp_to_chars(char* first, char* last, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& value, size_t precision){
+	return _fp_to_chars(first, last, value, true, precision);
+}
+
+/// Reads a FixedPoint from decimal text
+/**
+ *	The text is an optional '-', then digits with an optional '.', e.g. "-12.375", "3", "0.5", or ".5", without exponent.
+ *	The value is rounded to the nearest one of the format, with halves to even, whatever the rounding policy.
+ *	Numbers that do not fit are given by the overflow policy, with fp_chars_out_of_range. Runs of 8 digits are read with SSE2 if it is available
+ *	@param first Start of the text
+ *	@param last End of the text
+ *	@param value Set to the value read, unchanged if there is no number
+ *	@return One past the last character read, and the status
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+fp_from_chars_result fp_from_chars(const char* first, const char* last, FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& value){
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+	const count_type bits = std::numeric_limits<unsigned_type>::digits;
+	const unsigned long long int max_integer = ~0ULL;
+
+	const char* text = first;
+	const bool negative = text != last && *text == '-';
+	if (negative){
+		++text;
+	}
+
+	// Integer part, overflow is only recorded
+	unsigned long long int integer = 0;
+	bool overflow = false;
+	const char* const integer_start = text;
+	while (text != last && _fp_chars_digit(*text)){
+		unsigned int chunk = 0;
+		if (last - text >= 8 && _fp_chars_digits8(text, chunk)){
+			overflow = overflow || integer > (max_integer - chunk) / _fp_chars_limb;
+			integer = integer * _fp_chars_limb + chunk;
+			text += 8;
+		}else{
+			const unsigned int digit = static_cast<unsigned int>(*text++ - '0');
+			overflow = overflow || integer > (max_integer - digit) / 10;
+			integer = integer * 10 + digit;
+		}
+	}
+	bool any_digit = text != integer_start;
+
+	// Fraction, as limbs of its first FractionalBits + 1 digits and whether any later digit is not zero
+	unsigned int limbs[_fp_chars_limbs] = {0};
+	size_t count = 0;
+	bool sticky = false;
+	if (text != last && *text == '.'){
+		const char* const fraction_start = ++text;
+		const size_t kept = FractionalBits + 1;
+		while (text != last && _fp_chars_digit(*text)){
+			unsigned int chunk = 0;
+			if ((count % 8 == 0 || count >= kept) && last - text >= 8 && _fp_chars_digits8(text, chunk)){
+				if (count + 8 <= kept){
+					limbs[count / 8] = chunk;
+					count += 8;
+				}else if (count < kept){
+					// Only the leading digits of the chunk are kept
+					unsigned int scale = 1;
+					for (size_t i = count + 8; i > kept; i--){
+						scale *= 10;
+					}
+					limbs[count / 8] = chunk / scale;
+					sticky = sticky || chunk % scale != 0;
+					count = kept;
+				}else{
+					sticky = sticky || chunk != 0;
+				}
+				text += 8;
+			}else{
+				const unsigned int digit = static_cast<unsigned int>(*text++ - '0');
+				if (count < kept){
+					limbs[count / 8] = (count % 8 ? limbs[count / 8] * 10 : 0) + digit;
+					++count;
+				}else{
+					sticky = sticky || digit != 0;
+				}
+			}
+		}
+		any_digit = any_digit || text != fraction_start;
+	}
+	if (!any_digit){
+		fp_from_chars_result result = {first, fp_chars_invalid};
+		return result;
+	}
+
+	// Left aligns the last limb, then takes the bits of the fraction up to 32 at a time, and one more to round
+	const size_t limb_count = (count + 7) / 8;
+	for (size_t i = count; i % 8; i++){
+		limbs[limb_count - 1] *= 10;
+	}
+	unsigned long long int fraction = 0;
+	for (count_type remaining = FractionalBits; remaining;){
+		const count_type shift = remaining < 32 ? remaining : 32;
+		fraction = (fraction << shift) | _fp_chars_double(limbs, limb_count, shift);
+		remaining = count_type(remaining - shift);
+	}
+	const bool round = _fp_chars_double(limbs, limb_count, 1) != 0;
+	for (size_t i = 0; i < limb_count; i++){
+		sticky = sticky || limbs[i] != 0;
+	}
+	if (round && (sticky || ((FractionalBits ? fraction : integer) & 1))){
+		++fraction;
+		// A fraction of all ones carries into the integer part
+		if (FractionalBits == std::numeric_limits<unsigned long long int>::digits ? fraction == 0 : (fraction >> (FractionalBits % std::numeric_limits<unsigned long long int>::digits)) != 0){
+			fraction = 0;
+			overflow = overflow || integer == max_integer;
+			++integer;
+		}
+	}
+
+	// Magnitude of the value, which must not go past the largest value, or past the smallest one if negative
+	const unsigned_type largest = unsigned_type(unsigned_type(std::numeric_limits<IntegerType>::max()) + unsigned_type(negative && std::numeric_limits<IntegerType>::is_signed));
+	overflow = overflow || (FractionalBits < bits ? integer > (unsigned long long int)(unsigned_type(~unsigned_type(0)) >> (FractionalBits % bits)) : integer != 0);
+	const unsigned_type magnitude = unsigned_type((FractionalBits < bits ? unsigned_type(unsigned_type(integer) << (FractionalBits % bits)) : unsigned_type(0)) | unsigned_type(fraction));
+	overflow = overflow || magnitude > largest || (negative && !std::numeric_limits<IntegerType>::is_signed && magnitude != 0);
+
+	const IntegerType content = IntegerType(negative ? unsigned_type(unsigned_type(0) - magnitude) : magnitude);
+	#ifdef FIXEDPOINT_INSTRUMENT
+		if (overflow){
+			_fp_event<FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(negative ? fp_event_underflow : fp_event_overflow, "fp_from_chars");
+		}
+	#endif
+	value() = OverflowPolicy::fit(content, overflow, negative);
+
+	fp_from_chars_result result = {text, overflow ? fp_chars_out_of_range : fp_chars_ok};
+	return result;
+}
+
+inline bool _fp_chars_separator(char c, char delimiter){
+	return c == delimiter || c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/// Reads delimited FixedPoints from a buffer
+/**
+ *	Values are separated by the delimiter and any spaces, tabs, and line breaks, e.g. a column of numbers or a line of CSV.
+ *	Reading stops after count values, at the end of the buffer, or at text that is not a number followed by a separator,
+ *	which gives fp_chars_invalid. Values that do not fit are given by the overflow policy and give fp_chars_out_of_range,
+ *	but reading goes on. The buffer should end with a separator, or with the end of a value
+ *	@param first Start of the buffer
+ *	@param last End of the buffer
+ *	@param values Array receiving the values
+ *	@param count Size of values
+ *	@param read Set to the number of values read
+ *	@param delimiter Character between values, in addition to whitespace
+ *	@return One past the last character read, and the status
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+fp_from_chars_result fp_from_chars(const char* first, const char* last, FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* values, size_t count, size_t& read, char delimiter = ','){
+	fp_from_chars_result result = {first, fp_chars_ok};
+	read = 0;
+	while (read < count){
+		while (result.ptr != last && _fp_chars_separator(*result.ptr, delimiter)){
+			++result.ptr;
+		}
+		if (result.ptr == last){
+			break;
+		}
+
+		const fp_from_chars_result parsed = fp_from_chars(result.ptr, last, values[read]);
+		if (parsed.status == fp_chars_invalid || (parsed.ptr != last && !_fp_chars_separator(*parsed.ptr, delimiter))){
+			result.status = fp_chars_invalid;
+			return result;
+		}
+		if (parsed.status == fp_chars_out_of_range){
+			result.status = fp_chars_out_of_range;
+		}
+		result.ptr = parsed.ptr;
+		++read;
+	}
+	return result;
+}
+
+#endif//H_FP_CHARS
@@ -0,0 +1,152 @@
+/**
+ *	@file fp_complex.h
+ *	Adds complex numbers made of two FixedPoints
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_COMPLEX
+#define H_FP_COMPLEX
+
+#include "fp_fused.h"
+
+///	A complex number with FixedPoint real and imaginary parts
+/**
+ *	The real part is stored first and then the imaginary part, with nothing around them, so an array of
+ *	FixedPointComplex is an array of interleaved raw fixed point numbers.
+ *	Products sum the two full products of each part before rescaling once, through the rounding policy and then the overflow policy
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits, typename OverflowPolicy = fp_wrap>
+class FixedPointComplex{
+public:
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+
+private:
+	value_type _real;
+	value_type _imag;
+
+	// a * b + c * d, or a * b - c * d if Subtract, rescaled once
+	template<bool Subtract>
+	static FIXEDPOINT_CONSTEXPR value_type _products(const value_type& a, const value_type& b, const value_type& c, const value_type& d){
+		_fp_accumulator<IntegerType> accumulator;
+		accumulator.template mul_add<false>(a(), b());
+		accumulator.template mul_add<Subtract>(c(), d());
+
+		value_type result;
+		_fp_accumulated(result, accumulator, FractionalBits, "FixedPointComplex");
+		return result;
+	}
+
+public:
+	/// Zero
+	FIXEDPOINT_CONSTEXPR FixedPointComplex() : _real(), _imag(){}
+
+	/// Complex number from its parts
+	/**
+	 *	@param real Real part
+	 *	@param imag Imaginary part
+	 */
+	FIXEDPOINT_CONSTEXPR FixedPointComplex(const value_type& real, const value_type& imag = value_type()) : _real(real), _imag(imag){}
+
+	/// Returns the real part
+	/**
+	 *	@return Real part
+	 */
+	FIXEDPOINT_CONSTEXPR const value_type& real() const{
+		return _real;
+	}
+
+	/// Returns the real part, for writing
+	/**
+	 *	@return Real part
+	 */
+	FIXEDPOINT_CONSTEXPR value_type& real(){
+		return _real;
+	}
+
+	/// Returns the imaginary part
+	/**
+	 *	@return Imaginary part
+	 */
+	FIXEDPOINT_CONSTEXPR const value_type& imag() const{
+		return _imag;
+	}
+
+	/// Returns the imaginary part, for writing
+	/**
+	 *	@return Imaginary part
+	 */
+	FIXEDPOINT_CONSTEXPR value_type& imag(){
+		return _imag;
+	}
+
+	FIXEDPOINT_CONSTEXPR FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator+=(const FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+		_real += other._real;
+		_imag += other._imag;
+		return *this;
+	}
+
+	FIXEDPOINT_CONSTEXPR FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator-=(const FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+		_real -= other._real;
+		_imag -= other._imag;
+		return *this;
+	}
+
+	FIXEDPOINT_CONSTEXPR FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator*=(const FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+		const value_type real = _products<true>(_real, other._real, _imag, other._imag);
+		_imag = _products<false>(_real, other._imag, _imag, other._real);
+		_real = real;
+		return *this;
+	}
+
+	FIXEDPOINT_CONSTEXPR FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator*=(const value_type& other){
+		_real *= other;
+		_imag *= other;
+		return *this;
+	}
+
+	FIXEDPOINT_CONSTEXPR FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator+(const FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
+		return FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) += other;
+	}
+
+	FIXEDPOINT_CONSTEXPR FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator-(const FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
+		return FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) -= other;
+	}
+
+	FIXEDPOINT_CONSTEXPR FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator*(const FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
+		return FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) *= other;
+	}
+
+	FIXEDPOINT_CONSTEXPR FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator*(const value_type& other) const{
+		return FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) *= other;
+	}
+
+	FIXEDPOINT_CONSTEXPR FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator-() const{
+		return FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(-_real, -_imag);
+	}
+
+	FIXEDPOINT_CONSTEXPR bool operator==(const FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
+		return _real == other._real && _imag == other._imag;
+	}
+
+	FIXEDPOINT_CONSTEXPR bool operator!=(const FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
+		return !(operator==(other));
+	}
+
+	/// Returns the complex conjugate
+	/**
+	 *	@return Number with the imaginary part negated
+	 */
+	FIXEDPOINT_CONSTEXPR FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> conj() const{
+		return FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(_real, -_imag);
+	}
+
+	/// Returns the squared magnitude
+	/**
+	 *	@return real^2 + imag^2, rescaled once
+	 */
+	FIXEDPOINT_CONSTEXPR value_type norm() const{
+		return _products<false>(_real, _real, _imag, _imag);
+	}
+};
+
+#endif//H_FP_COMPLEX
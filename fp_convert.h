@@ -0,0 +1,442 @@
+/**
+ *	@file fp_convert.h
+ *	Adds conversions between arrays of FixedPoints and arrays of float, double or Fraction
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_CONVERT
+#define H_FP_CONVERT
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include "fp_batch.h"
+#include "fp_fraction.h"
+
+/// NaN policies, given as the last argument of fp_from_float
+/**
+ *	Each policy returns the content that a NaN converts to. Infinities are out of range and go through the overflow policy instead
+ */
+
+/// Converts NaN to zero, the default
+struct fp_nan_zero{
+	template<typename IntegerType>
+	static IntegerType nan(){
+		return IntegerType(0);
+	}
+};
+
+/// Calls FIXEDPOINT_TRAP() on NaN
+struct fp_nan_trap{
+	template<typename IntegerType>
+	static IntegerType nan(){
+		FIXEDPOINT_TRAP();
+		return IntegerType(0);
+	}
+};
+
+// Rounds to the nearest integer, halves to even, which is what cvtps2dq does in the default rounding mode.
+// Doubles of 2^52 and more are integers already, smaller ones are truncated to an integer and the exact rest decides
+inline double _fp_convert_round(double value){
+	if (!(std::fabs(value) < 4503599627370496.0)){
+		return value;
+	}
+	long long int result = static_cast<long long int>(value);
+	const double rest = value - double(result);
+	if (rest > 0.5 || (rest == 0.5 && (result & 1))){
+		++result;
+	}else if (rest < -0.5 || (rest == -0.5 && (result & 1))){
+		--result;
+	}
+	return double(result);
+}
+
+// Conversion kernels on raw content. from takes values and a scale of 2^FractionalBits, to takes content and a scale of 2^-FractionalBits.
+// Scaling by a power of two is exact, so values are rounded once, to the nearest content or to the nearest Float.
+// The vector kernels hand every block with a NaN or a value out of range to the scalar loop, so all kernels give the same results
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy, typename NanPolicy>
+struct _fp_convert_scalar{
+	static IntegerType _from(double scaled, double upper){
+		if (scaled != scaled){
+			#ifdef FIXEDPOINT_INSTRUMENT
+				_fp_event<FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(fp_event_domain, "fp_from_float");
+			#endif
+			return NanPolicy::template nan<IntegerType>();
+		}
+
+		const double rounded = _fp_convert_round(scaled);
+		const double lower = std::numeric_limits<IntegerType>::is_signed ? -upper : 0.0;
+		if (rounded >= upper || rounded < lower){
+			const bool negative = rounded < 0;
+			#ifdef FIXEDPOINT_INSTRUMENT
+				_fp_event<FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(negative ? fp_event_underflow : fp_event_overflow, "fp_from_float");
+			#endif
+			// A float has no low bits to wrap, so the policy settles the closest content
+			return OverflowPolicy::fit(_fp_limit<IntegerType>(negative), true, negative);
+		}
+		return IntegerType(rounded);
+	}
+
+	template<typename Float>
+	static void from(IntegerType* out, const Float* in, size_t count, double scale){
+		// 2^digits is just past the largest content, and its negation is the smallest one if signed
+		const double upper = std::ldexp(1.0, std::numeric_limits<IntegerType>::digits);
+		for (size_t i = 0; i < count; i++){
+			out[i] = _from(double(in[i]) * scale, upper);
+		}
+	}
+
+	template<typename Float>
+	static void to(Float* out, const IntegerType* in, size_t count, Float scale){
+		for (size_t i = 0; i < count; i++){
+			out[i] = Float(in[i]) * scale;
+		}
+	}
+};
+
+#ifdef FIXEDPOINT_SSE2
+	// Content of 8, 16 or 32 bits goes through 32 bit lanes, rounded by cvtps2dq (cvtpd2dq for double) and packed down.
+	// Unsigned 32 bit content is offset by 2^31 when it does not fit a signed lane.
+	// 64 bit content is rounded by adding 2^52 + 2^51 in double, which leaves the integer in the low bits of the mantissa,
+	// so the vector loop takes values below 2^51 and leaves larger ones to the scalar loop
+	template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy, typename NanPolicy>
+	struct _fp_convert_sse2 : _fp_convert_scalar<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, NanPolicy>{
+		typedef _fp_convert_scalar<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, NanPolicy> scalar;
+
+		static const bool _signed = std::numeric_limits<IntegerType>::is_signed;
+		static const count_type _bits = std::numeric_limits<IntegerType>::digits + _signed;
+
+		// Whether every int32 lane lies in the range of IntegerType
+		static bool _fits(__m128i lanes){
+			if (_bits >= 32){
+				return true;
+			}
+			const __m128i below = _mm_cmplt_epi32(lanes, _mm_set1_epi32(int(std::numeric_limits<IntegerType>::min())));
+			const __m128i above = _mm_cmpgt_epi32(lanes, _mm_set1_epi32(int(std::numeric_limits<IntegerType>::max())));
+			return _mm_movemask_epi8(_mm_or_si128(below, above)) == 0;
+		}
+
+		// The two 64 bit masks of a double comparison as the two low int32 lanes
+		static __m128i _narrow(__m128d mask){
+			return _mm_shuffle_epi32(_mm_castpd_si128(mask), _MM_SHUFFLE(2, 0, 2, 0));
+		}
+
+		// Rounds 4 scaled values into int32 lanes, returns whether they are all in range
+		static bool _round4(const float* in, double scale, __m128i& lanes){
+			const __m128 scaled = _mm_mul_ps(_mm_loadu_ps(in), _mm_set1_ps(float(scale)));
+			if (!_signed && _bits == 32){
+				const __m128 offset = _mm_set1_ps(2147483648.0f);
+				const __m128 high = _mm_cmpge_ps(scaled, offset);
+				const __m128 valid = _mm_and_ps(_mm_cmpge_ps(scaled, _mm_setzero_ps()), _mm_cmplt_ps(scaled, _mm_set1_ps(4294967296.0f)));
+				lanes = _mm_cvtps_epi32(_mm_sub_ps(scaled, _mm_and_ps(high, offset)));
+				lanes = _mm_xor_si128(lanes, _mm_slli_epi32(_mm_castps_si128(high), 31));
+				return _mm_movemask_ps(valid) == 0xF;
+			}
+			const __m128 valid = _mm_and_ps(_mm_cmpge_ps(scaled, _mm_set1_ps(-2147483648.0f)), _mm_cmplt_ps(scaled, _mm_set1_ps(2147483648.0f)));
+			lanes = _mm_cvtps_epi32(scaled);
+			return _mm_movemask_ps(valid) == 0xF && _fits(lanes);
+		}
+
+		static bool _round4(const double* in, double scale, __m128i& lanes){
+			const __m128d low = _mm_mul_pd(_mm_loadu_pd(in), _mm_set1_pd(scale));
+			const __m128d high = _mm_mul_pd(_mm_loadu_pd(in + 2), _mm_set1_pd(scale));
+			if (!_signed && _bits == 32){
+				// Unlike floats, doubles just below 2^31 and 2^32 may round up to them
+				const __m128d offset = _mm_set1_pd(2147483648.0);
+				const __m128d limit = _mm_set1_pd(4294967295.5);
+				const __m128d low_high = _mm_cmpge_pd(low, _mm_set1_pd(2147483647.5));
+				const __m128d high_high = _mm_cmpge_pd(high, _mm_set1_pd(2147483647.5));
+				const __m128d low_valid = _mm_and_pd(_mm_cmpge_pd(low, _mm_setzero_pd()), _mm_cmplt_pd(low, limit));
+				const __m128d high_valid = _mm_and_pd(_mm_cmpge_pd(high, _mm_setzero_pd()), _mm_cmplt_pd(high, limit));
+				lanes = _mm_unpacklo_epi64(_mm_cvtpd_epi32(_mm_sub_pd(low, _mm_and_pd(low_high, offset))), _mm_cvtpd_epi32(_mm_sub_pd(high, _mm_and_pd(high_high, offset))));
+				lanes = _mm_xor_si128(lanes, _mm_slli_epi32(_mm_unpacklo_epi64(_narrow(low_high), _narrow(high_high)), 31));
+				return (_mm_movemask_pd(low_valid) & _mm_movemask_pd(high_valid)) == 0x3;
+			}
+			const __m128d lower = _mm_set1_pd(-2147483648.5);
+			const __m128d upper = _mm_set1_pd(2147483647.5);
+			const __m128d low_valid = _mm_and_pd(_mm_cmpgt_pd(low, lower), _mm_cmplt_pd(low, upper));
+			const __m128d high_valid = _mm_and_pd(_mm_cmpgt_pd(high, lower), _mm_cmplt_pd(high, upper));
+			lanes = _mm_unpacklo_epi64(_mm_cvtpd_epi32(low), _mm_cvtpd_epi32(high));
+			return (_mm_movemask_pd(low_valid) & _mm_movemask_pd(high_valid)) == 0x3 && _fits(lanes);
+		}
+
+		// Packs 8 int32 lanes already in range down to IntegerType
+		static void _store8(IntegerType* out, __m128i low, __m128i high){
+			if (_bits == 32){
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out), low);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), high);
+			}else if (_bits == 16){
+				if (_signed){
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packs_epi32(low, high));
+				}else{
+					// SSE2 only packs with signed saturation, so the lanes are moved to the signed range and back
+					const __m128i bias = _mm_set1_epi32(32768);
+					const __m128i packed = _mm_packs_epi32(_mm_sub_epi32(low, bias), _mm_sub_epi32(high, bias));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_xor_si128(packed, _mm_set1_epi16(short(-32768))));
+				}
+			}else{
+				const __m128i words = _mm_packs_epi32(low, high);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(out), _signed ? _mm_packs_epi16(words, words) : _mm_packus_epi16(words, words));
+			}
+		}
+
+		// Rounds 2 scaled values into int64 lanes, returns whether they are both in [-2^51, 2^51) and in range
+		static bool _round2(__m128d scaled, __m128i& lanes){
+			const __m128d magic = _mm_set1_pd(6755399441055744.0);
+			const __m128d limit = _mm_set1_pd(2251799813685248.0);
+			const __m128d lower = _signed ? _mm_sub_pd(_mm_setzero_pd(), limit) : _mm_setzero_pd();
+			const __m128d valid = _mm_and_pd(_mm_cmpge_pd(scaled, lower), _mm_cmplt_pd(scaled, limit));
+			lanes = _mm_sub_epi64(_mm_castpd_si128(_mm_add_pd(scaled, magic)), _mm_castpd_si128(magic));
+			return _mm_movemask_pd(valid) == 0x3;
+		}
+
+		static __m128d _load2(const float* in){
+			return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in))));
+		}
+
+		static __m128d _load2(const double* in){
+			return _mm_loadu_pd(in);
+		}
+
+		template<typename Float>
+		static void from(IntegerType* out, const Float* in, size_t count, double scale){
+			size_t i = 0;
+			if (_bits <= 32){
+				for (; i + 8 <= count; i += 8){
+					__m128i low, high;
+					const bool low_valid = _round4(in + i, scale, low);
+					const bool high_valid = _round4(in + i + 4, scale, high);
+					if (low_valid && high_valid){
+						_store8(out + i, low, high);
+					}else{
+						scalar::from(out + i, in + i, 8, scale);
+					}
+				}
+			}else if (_bits == 64){
+				const __m128d vscale = _mm_set1_pd(scale);
+				for (; i + 2 <= count; i += 2){
+					__m128i lanes;
+					if (_round2(_mm_mul_pd(_load2(in + i), vscale), lanes)){
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lanes);
+					}else{
+						scalar::from(out + i, in + i, 2, scale);
+					}
+				}
+			}
+			scalar::from(out + i, in + i, count - i, scale);
+		}
+
+		// Loads 4 values of at most 32 bits as int32 lanes
+		static __m128i _load4(const IntegerType* in){
+			if (_bits == 32){
+				return _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+			}
+			if (_bits == 16){
+				const __m128i words = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in));
+				return _signed ? _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16) : _mm_unpacklo_epi16(words, _mm_setzero_si128());
+			}
+			int packed = 0;
+			std::memcpy(&packed, in, 4);
+			const __m128i bytes = _mm_cvtsi32_si128(packed);
+			if (_signed){
+				const __m128i words = _mm_unpacklo_epi8(bytes, bytes);
+				return _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 24);
+			}
+			return _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, _mm_setzero_si128()), _mm_setzero_si128());
+		}
+
+		static void _convert4(float* out, __m128i lanes, float scale){
+			__m128 values;
+			if (!_signed && _bits == 32){
+				// Both halves convert exactly, so only their sum rounds
+				const __m128 high = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(lanes, 16)), _mm_set1_ps(65536.0f));
+				values = _mm_add_ps(high, _mm_cvtepi32_ps(_mm_and_si128(lanes, _mm_set1_epi32(0xFFFF))));
+			}else{
+				values = _mm_cvtepi32_ps(lanes);
+			}
+			_mm_storeu_ps(out, _mm_mul_ps(values, _mm_set1_ps(scale)));
+		}
+
+		static void _convert4(double* out, __m128i lanes, double scale){
+			__m128d low, high;
+			if (!_signed && _bits == 32){
+				const __m128i flipped = _mm_xor_si128(lanes, _mm_set1_epi32(int(0x80000000u)));
+				const __m128d offset = _mm_set1_pd(2147483648.0);
+				low = _mm_add_pd(_mm_cvtepi32_pd(flipped), offset);
+				high = _mm_add_pd(_mm_cvtepi32_pd(_mm_srli_si128(flipped, 8)), offset);
+			}else{
+				low = _mm_cvtepi32_pd(lanes);
+				high = _mm_cvtepi32_pd(_mm_srli_si128(lanes, 8));
+			}
+			_mm_storeu_pd(out, _mm_mul_pd(low, _mm_set1_pd(scale)));
+			_mm_storeu_pd(out + 2, _mm_mul_pd(high, _mm_set1_pd(scale)));
+		}
+
+		// 64 bit content to double. The high and low halves go into the mantissas of 2^84 and 2^52 (signed content is offset by 2^63 first),
+		// the biases cancel exactly and only the final sum rounds. Going on to float would round twice, so float is left to the scalar loop
+		static size_t _convert64(double* out, const IntegerType* in, size_t count, double scale){
+			const __m128i low_mask = _mm_set_epi32(0, -1, 0, -1);
+			const __m128i high_exponent = _mm_castpd_si128(_mm_set1_pd(19342813113834066795298816.0));
+			const __m128i low_exponent = _mm_castpd_si128(_mm_set1_pd(4503599627370496.0));
+			const __m128d bias = _mm_set1_pd(_signed ? 19342813113834066795298816.0 + 9223372036854775808.0 + 4503599627370496.0 : 19342813113834066795298816.0 + 4503599627370496.0);
+			const __m128i sign = _signed ? _mm_set_epi32(int(0x80000000u), 0, int(0x80000000u), 0) : _mm_setzero_si128();
+
+			size_t i = 0;
+			for (; i + 2 <= count; i += 2){
+				const __m128i lanes = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), sign);
+				const __m128d high = _mm_castsi128_pd(_mm_or_si128(_mm_srli_epi64(lanes, 32), high_exponent));
+				const __m128d low = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(lanes, low_mask), low_exponent));
+				_mm_storeu_pd(out + i, _mm_mul_pd(_mm_add_pd(_mm_sub_pd(high, bias), low), _mm_set1_pd(scale)));
+			}
+			return i;
+		}
+
+		static size_t _convert64(float*, const IntegerType*, size_t, float){
+			return 0;
+		}
+
+		template<typename Float>
+		static void to(Float* out, const IntegerType* in, size_t count, Float scale){
+			size_t i = 0;
+			if (_bits <= 32){
+				for (; i + 4 <= count; i += 4){
+					_convert4(out + i, _load4(in + i), scale);
+				}
+			}else if (_bits == 64){
+				i = _convert64(out, in, count, scale);
+			}
+			scalar::to(out + i, in + i, count - i, scale);
+		}
+	};
+
+	template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy, typename NanPolicy>
+	struct _fp_convert_kernel : _fp_select<std::numeric_limits<IntegerType>::digits + std::numeric_limits<IntegerType>::is_signed <= 64,
+		_fp_convert_sse2<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, NanPolicy>,
+		_fp_convert_scalar<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, NanPolicy> >::type{};
+#else
+	template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy, typename NanPolicy>
+	struct _fp_convert_kernel : _fp_convert_scalar<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, NanPolicy>{};
+#endif
+
+/// Converts an array of float to FixedPoints
+/**
+ *	Values are rounded to the nearest content, with halves to even, whatever the rounding policy. Values out of range and infinities
+ *	are given by the overflow policy, which keeps the closest value under fp_wrap and fp_saturate, and NaN by NanPolicy.
+ *	The vector loops round with cvtps2dq and assume the default rounding mode of the processor
+ *	@param out Array receiving the FixedPoints
+ *	@param in Values to convert
+ *	@param count Number of elements in each array
+ *	@param policy How NaN is converted, fp_nan_zero or fp_nan_trap
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy, typename NanPolicy>
+void fp_from_float(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* out, const float* in, size_t count, NanPolicy policy){
+	(void)policy;
+	_fp_convert_kernel<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, NanPolicy>::from(_fp_raw(out), in, count, std::ldexp(1.0, FractionalBits));
+}
+
+/// Converts an array of double to FixedPoints
+/**
+ *	Same as the float overload
+ *	@param out Array receiving the FixedPoints
+ *	@param in Values to convert
+ *	@param count Number of elements in each array
+ *	@param policy How NaN is converted, fp_nan_zero or fp_nan_trap
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy, typename NanPolicy>
+void fp_from_float(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* out, const double* in, size_t count, NanPolicy policy){
+	(void)policy;
+	_fp_convert_kernel<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, NanPolicy>::from(_fp_raw(out), in, count, std::ldexp(1.0, FractionalBits));
+}
+
+/// Converts an array of float to FixedPoints, NaN converting to zero
+/**
+ *	@param out Array receiving the FixedPoints
+ *	@param in Values to convert
+ *	@param count Number of elements in each array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_from_float(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* out, const float* in, size_t count){
+	fp_from_float(out, in, count, fp_nan_zero());
+}
+
+/// Converts an array of double to FixedPoints, NaN converting to zero
+/**
+ *	@param out Array receiving the FixedPoints
+ *	@param in Values to convert
+ *	@param count Number of elements in each array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_from_float(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* out, const double* in, size_t count){
+	fp_from_float(out, in, count, fp_nan_zero());
+}
+
+/// Converts an array of FixedPoints to float
+/**
+ *	Each value is rounded once to the nearest float. Formats of 24 bits or less convert exactly
+ *	@param out Array receiving the values
+ *	@param in FixedPoints to convert
+ *	@param count Number of elements in each array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_to_float(float* out, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* in, size_t count){
+	_fp_convert_kernel<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, fp_nan_zero>::to(out, _fp_raw(in), count, float(std::ldexp(1.0, -int(FractionalBits))));
+}
+
+/// Converts an array of FixedPoints to double
+/**
+ *	Each value is rounded once to the nearest double. Formats of 53 bits or less convert exactly
+ *	@param out Array receiving the values
+ *	@param in FixedPoints to convert
+ *	@param count Number of elements in each array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_to_float(double* out, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* in, size_t count){
+	_fp_convert_kernel<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, fp_nan_zero>::to(out, _fp_raw(in), count, std::ldexp(1.0, -int(FractionalBits)));
+}
+
+/// Converts an array of Fractions to FixedPoints
+/**
+ *	Each value is rounded toward zero with one shift and one double-width division, as by the Fraction constructor of FixedPoint
+ *	@param out Array receiving the FixedPoints
+ *	@param in Fractions to convert
+ *	@param count Number of elements in each array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_from_fraction(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* out, const Fraction<IntegerType>* in, size_t count){
+	for (size_t i = 0; i < count; i++){
+		out[i] = FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(in[i]);
+	}
+}
+
+/// Converts an array of FixedPoints to Fractions
+/**
+ *	Exact, each Fraction is the content over a power of two in lowest terms, found with shifts alone.
+ *	Only formats whose fractional bits are all the value bits of IntegerType may need an approximation, as by the Fraction constructor
+ *	@param out Array receiving the Fractions
+ *	@param in FixedPoints to convert
+ *	@param count Number of elements in each array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_to_fraction(Fraction<IntegerType>* out, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* in, size_t count){
+	for (size_t i = 0; i < count; i++){
+		out[i] = Fraction<IntegerType>(in[i]);
+	}
+}
+
+/// Converts an array of FixedPoints to the closest Fractions with a bounded denominator
+/**
+ *	Each value is approximated from its continued fraction, with one division per term
+ *	@param out Array receiving the Fractions
+ *	@param in FixedPoints to convert
+ *	@param count Number of elements in each array
+ *	@param max_denominator Largest denominator allowed, at least 1
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_to_fraction(Fraction<IntegerType>* out, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* in, size_t count, IntegerType max_denominator){
+	for (size_t i = 0; i < count; i++){
+		out[i] = Fraction<IntegerType>(in[i], max_denominator);
+	}
+}
+
+#endif//H_FP_CONVERT
@@ -63,36 +63,36 @@ private:
 	}
 
 	const _group_type& _integer_group(count_type _pos) const{
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_pos >= _integer_groups){
-				// Error
+				_fp_event<Decimal<_Signed, _StorageType> >(fp_event_range, "Decimal::_integer_group");
 			}
 		#endif
 		return _integer[_pos];
 	}
 
 	_group_type& _integer_group(count_type _pos){
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_pos >= _integer_groups){
-				// Error
+				_fp_event<Decimal<_Signed, _StorageType> >(fp_event_range, "Decimal::_integer_group");
 			}
 		#endif
 		return _integer[_pos];
 	}
 
 	const _group_type& _decimal_group(count_type _pos) const{
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_pos >= _decimal_groups){
-				// Error
+				_fp_event<Decimal<_Signed, _StorageType> >(fp_event_range, "Decimal::_decimal_group");
 			}
 		#endif
 		return _decimal[_pos];
 	}
 
 	_group_type& _decimal_group(count_type _pos){
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_pos >= _decimal_groups){
-				// Error
+				_fp_event<Decimal<_Signed, _StorageType> >(fp_event_range, "Decimal::_decimal_group");
 			}
 		#endif
 		return _decimal[_pos];
@@ -107,9 +107,9 @@ private:
 	}
 
 	_digit_type _decimal_digit(count_type _pos) const{
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_pos >= _DecimalCount){
-				// Error
+				_fp_event<Decimal<_Signed, _StorageType> >(fp_event_range, "Decimal::_decimal_digit");
 			}
 		#endif
 		
@@ -139,45 +139,45 @@ class FixedDecimal{
 	_group_type _decimal[_decimal_groups];
 
 	const _group_type& _integer_group(count_type _pos) const{
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_pos >= _integer_groups){
-				// Error
+				_fp_event<FixedDecimal<_IntegerCount, _DecimalCount, _Signed, _StorageType> >(fp_event_range, "FixedDecimal::_integer_group");
 			}
 		#endif
 		return _integer[_pos];
 	}
 
 	_group_type& _integer_group(count_type _pos){
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_pos >= _integer_groups){
-				// Error
+				_fp_event<FixedDecimal<_IntegerCount, _DecimalCount, _Signed, _StorageType> >(fp_event_range, "FixedDecimal::_integer_group");
 			}
 		#endif
 		return _integer[_pos];
 	}
 
 	const _group_type& _decimal_group(count_type _pos) const{
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_pos >= _decimal_groups){
-				// Error
+				_fp_event<FixedDecimal<_IntegerCount, _DecimalCount, _Signed, _StorageType> >(fp_event_range, "FixedDecimal::_decimal_group");
 			}
 		#endif
 		return _decimal[_pos];
 	}
 
 	_group_type& _decimal_group(count_type _pos){
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_pos >= _decimal_groups){
-				// Error
+				_fp_event<FixedDecimal<_IntegerCount, _DecimalCount, _Signed, _StorageType> >(fp_event_range, "FixedDecimal::_decimal_group");
 			}
 		#endif
 		return _decimal[_pos];
 	}
 
 	_digit_type _integer_digit(count_type _pos) const{
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_pos >= _DecimalCount){
-				// Error
+				_fp_event<FixedDecimal<_IntegerCount, _DecimalCount, _Signed, _StorageType> >(fp_event_range, "FixedDecimal::_integer_digit");
 			}
 		#endif
 		
@@ -185,9 +185,9 @@ class FixedDecimal{
 	}
 
 	_digit_type _decimal_digit(count_type _pos) const{
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_pos >= _DecimalCount){
-				// Error
+				_fp_event<FixedDecimal<_IntegerCount, _DecimalCount, _Signed, _StorageType> >(fp_event_range, "FixedDecimal::_decimal_digit");
 			}
 		#endif
 		
@@ -222,9 +222,9 @@ class FixedDecimal{
 				_integer_digit(i, _result % _digit_capacity);
 			}
 
-			#ifdef FIXEDPOINT_DEBUG
+			#ifdef FIXEDPOINT_INSTRUMENT
 				if (_carrybit){
-					// Error overflow
+					_fp_event<FixedDecimal<_IntegerCount, _DecimalCount, _Signed, _StorageType> >(fp_event_overflow, "FixedDecimal::_digit_add");
 				}
 			#endif
 		}
@@ -241,9 +241,9 @@ class FixedDecimal{
 				_integer_digit(i, _integer_digit(i) + (_borrowbit * _digit_capacity - _difference));
 			}
 
-			#ifdef FIXEDPOINT_DEBUG
+			#ifdef FIXEDPOINT_INSTRUMENT
 				if (_borrowbit){
-					// Error underflow
+					_fp_event<FixedDecimal<_IntegerCount, _DecimalCount, _Signed, _StorageType> >(fp_event_underflow, "FixedDecimal::_digit_subtract");
 				}
 			#endif
 		}
@@ -306,9 +306,9 @@ public:
 	}
 	template<count_type _OtherIntegerCount, count_type _OtherDecimalCount>
 	FixedDecimal(const FixedDecimal<_OtherIntegerCount, _OtherDecimalCount>& other){
-		#ifdef FIXEDPOINT_DEBUG
+		#ifdef FIXEDPOINT_INSTRUMENT
 			if (_OtherIntegerCount > _IntegerCount){
-				// Error
+				_fp_event<FixedDecimal<_IntegerCount, _DecimalCount, _Signed, _StorageType> >(fp_event_overflow, "FixedDecimal::FixedDecimal");
 			}
 		#endif
 
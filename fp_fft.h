@@ -0,0 +1,377 @@
+/**
+ *	@file fp_fft.h
+ *	Adds fast Fourier transforms of FixedPointComplex arrays with block floating point scaling
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_FFT
+#define H_FP_FFT
+
+#include <cstddef>
+
+#include "fp_array.h"
+#include "fp_complex.h"
+#include "fp_math.h"
+
+// Butterflies on raw interleaved (real, imaginary) content. Twiddles have digits - 1 fractional bits, so that 1 is exact,
+// and are conjugated for inverse transforms. Every pass shifts its results right by scale, rounded by Rounding,
+// and returns the OR of their magnitudes, from which the next pass chooses its own scale
+template<typename IntegerType, typename Rounding>
+struct _fp_fft_scalar{
+	typedef typename _fp_int_traits<IntegerType>::wide_type wide_type;
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+
+	static const count_type twiddle_bits = std::numeric_limits<IntegerType>::digits - 1;
+
+	// x * w, or x * conj(w) if Inverse, rounded to the format of x
+	template<bool Inverse>
+	static void _rotate(const IntegerType* x, const IntegerType* w, wide_type& real, wide_type& imag){
+		const wide_type xr = x[0], xi = x[1], wr = w[0], wi = w[1];
+		real = _fp_round_shift<Rounding>(wide_type(Inverse ? xr * wr + xi * wi : xr * wr - xi * wi), twiddle_bits);
+		imag = _fp_round_shift<Rounding>(wide_type(Inverse ? xi * wr - xr * wi : xi * wr + xr * wi), twiddle_bits);
+	}
+
+	static IntegerType _store(wide_type value, count_type scale, unsigned_type& magnitude){
+		const IntegerType result = IntegerType(scale ? _fp_round_shift<Rounding>(value, scale) : value);
+		magnitude |= _fp_magnitude(result);
+		return result;
+	}
+
+	// Radix 2 pass with half size 1, whose only twiddle is 1
+	static unsigned_type radix2(IntegerType* data, size_t size, count_type scale){
+		unsigned_type magnitude = 0;
+		for (size_t i = 0; i < 2 * size; i += 4){
+			const wide_type ar = data[i], ai = data[i + 1], br = data[i + 2], bi = data[i + 3];
+			data[i] = _store(ar + br, scale, magnitude);
+			data[i + 1] = _store(ai + bi, scale, magnitude);
+			data[i + 2] = _store(ar - br, scale, magnitude);
+			data[i + 3] = _store(ai - bi, scale, magnitude);
+		}
+		return magnitude;
+	}
+
+	// Radix 4 butterflies of x[k], x[k + h], x[k + 2h], x[k + 3h] for k in [begin, end) of every group of 4h,
+	// the same as two radix 2 passes of half size h and 2h. twiddles holds W^2k, then W^k, then W^3k for k < h, with W = e^(-2 pi i / 4h)
+	template<bool Inverse>
+	static unsigned_type radix4(IntegerType* data, size_t size, size_t h, size_t begin, size_t end, const IntegerType* twiddles, count_type scale){
+		unsigned_type magnitude = 0;
+		for (size_t group = 0; group < size; group += 4 * h){
+			for (size_t k = begin; k < end; k++){
+				IntegerType* const x0 = data + 2 * (group + k);
+				IntegerType* const x1 = x0 + 2 * h;
+				IntegerType* const x2 = x1 + 2 * h;
+				IntegerType* const x3 = x2 + 2 * h;
+
+				wide_type br, bi, cr, ci, dr, di;
+				_rotate<Inverse>(x1, twiddles + 2 * k, br, bi);
+				_rotate<Inverse>(x2, twiddles + 2 * (h + k), cr, ci);
+				_rotate<Inverse>(x3, twiddles + 2 * (2 * h + k), dr, di);
+
+				const wide_type s0r = x0[0] + br, s0i = x0[1] + bi;
+				const wide_type s1r = x0[0] - br, s1i = x0[1] - bi;
+				const wide_type t0r = cr + dr, t0i = ci + di;
+				// Multiplied by -i, or by i if Inverse
+				const wide_type t1r = Inverse ? di - ci : ci - di, t1i = Inverse ? cr - dr : dr - cr;
+
+				x0[0] = _store(s0r + t0r, scale, magnitude);
+				x0[1] = _store(s0i + t0i, scale, magnitude);
+				x1[0] = _store(s1r + t1r, scale, magnitude);
+				x1[1] = _store(s1i + t1i, scale, magnitude);
+				x2[0] = _store(s0r - t0r, scale, magnitude);
+				x2[1] = _store(s0i - t0i, scale, magnitude);
+				x3[0] = _store(s1r - t1r, scale, magnitude);
+				x3[1] = _store(s1i - t1i, scale, magnitude);
+			}
+		}
+		return magnitude;
+	}
+
+	template<bool Inverse>
+	static unsigned_type radix4(IntegerType* data, size_t size, size_t h, const IntegerType* twiddles, count_type scale){
+		return radix4<Inverse>(data, size, h, 0, h, twiddles, scale);
+	}
+};
+
+template<typename IntegerType, typename Rounding>
+struct _fp_fft_kernel : _fp_fft_scalar<IntegerType, Rounding>{};
+
+#ifdef FIXEDPOINT_SSE2
+	// 16 bit radix 4 butterflies on four values of k at once. Each rotation is a pmaddwd of (real, imaginary) pairs,
+	// the sums are kept in 32 bit lanes. Only for the rounding policies that an add and a shift reproduce
+	template<bool _HalfUp>
+	struct _fp_fft_kernel16 : _fp_fft_scalar<short int, typename _fp_select<_HalfUp, fp_round_half_up, fp_round_truncate>::type>{
+		typedef _fp_fft_scalar<short int, typename _fp_select<_HalfUp, fp_round_half_up, fp_round_truncate>::type> _scalar;
+
+		static __m128i _shift(__m128i value, count_type shift){
+			if (_HalfUp && shift){
+				value = _mm_add_epi32(value, _mm_set1_epi32(1 << (shift - 1)));
+			}
+			return _mm_sra_epi32(value, _mm_cvtsi32_si128(int(shift)));
+		}
+
+		// Real and imaginary parts of four interleaved values of x times the twiddles, or their conjugates if Inverse
+		template<bool Inverse>
+		static void _rotate(__m128i x, const short int* twiddles, __m128i& real, __m128i& imag){
+			const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(twiddles));
+			const __m128i swapped = _mm_shufflehi_epi16(_mm_shufflelo_epi16(w, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+			const __m128i negated = _mm_sub_epi16(_mm_setzero_si128(), Inverse ? swapped : w);
+			const __m128i low = _mm_set1_epi32(0xFFFF);
+
+			// Forward: (wr, -wi) and (wi, wr). Inverse: (wr, wi) and (-wi, wr)
+			const __m128i first = Inverse ? w : _mm_or_si128(_mm_and_si128(w, low), _mm_andnot_si128(low, negated));
+			const __m128i second = Inverse ? _mm_or_si128(_mm_and_si128(negated, low), _mm_andnot_si128(low, swapped)) : swapped;
+			real = _shift(_mm_madd_epi16(x, first), _scalar::twiddle_bits);
+			imag = _shift(_mm_madd_epi16(x, second), _scalar::twiddle_bits);
+		}
+
+		static __m128i _store(short int* target, __m128i real, __m128i imag, count_type scale, __m128i magnitude){
+			real = _shift(real, scale);
+			imag = _shift(imag, scale);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target), _mm_or_si128(_mm_and_si128(real, _mm_set1_epi32(0xFFFF)), _mm_slli_epi32(imag, 16)));
+
+			const __m128i real_sign = _mm_srai_epi32(real, 31), imag_sign = _mm_srai_epi32(imag, 31);
+			magnitude = _mm_or_si128(magnitude, _mm_sub_epi32(_mm_xor_si128(real, real_sign), real_sign));
+			return _mm_or_si128(magnitude, _mm_sub_epi32(_mm_xor_si128(imag, imag_sign), imag_sign));
+		}
+
+		template<bool Inverse>
+		static unsigned short int radix4(short int* data, size_t size, size_t h, const short int* twiddles, count_type scale){
+			const size_t vector_end = h & ~size_t(3);
+			__m128i magnitude = _mm_setzero_si128();
+			for (size_t group = 0; group < size; group += 4 * h){
+				for (size_t k = 0; k < vector_end; k += 4){
+					short int* const x0 = data + 2 * (group + k);
+					short int* const x1 = x0 + 2 * h;
+					short int* const x2 = x1 + 2 * h;
+					short int* const x3 = x2 + 2 * h;
+
+					__m128i br, bi, cr, ci, dr, di;
+					_rotate<Inverse>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x1)), twiddles + 2 * k, br, bi);
+					_rotate<Inverse>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x2)), twiddles + 2 * (h + k), cr, ci);
+					_rotate<Inverse>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x3)), twiddles + 2 * (2 * h + k), dr, di);
+
+					// Sign extends the interleaved parts of x0 into 32 bit lanes
+					const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x0));
+					const __m128i ar = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16), ai = _mm_srai_epi32(a, 16);
+
+					const __m128i s0r = _mm_add_epi32(ar, br), s0i = _mm_add_epi32(ai, bi);
+					const __m128i s1r = _mm_sub_epi32(ar, br), s1i = _mm_sub_epi32(ai, bi);
+					const __m128i t0r = _mm_add_epi32(cr, dr), t0i = _mm_add_epi32(ci, di);
+					const __m128i t1r = Inverse ? _mm_sub_epi32(di, ci) : _mm_sub_epi32(ci, di);
+					const __m128i t1i = Inverse ? _mm_sub_epi32(cr, dr) : _mm_sub_epi32(dr, cr);
+
+					magnitude = _store(x0, _mm_add_epi32(s0r, t0r), _mm_add_epi32(s0i, t0i), scale, magnitude);
+					magnitude = _store(x1, _mm_add_epi32(s1r, t1r), _mm_add_epi32(s1i, t1i), scale, magnitude);
+					magnitude = _store(x2, _mm_sub_epi32(s0r, t0r), _mm_sub_epi32(s0i, t0i), scale, magnitude);
+					magnitude = _store(x3, _mm_sub_epi32(s1r, t1r), _mm_sub_epi32(s1i, t1i), scale, magnitude);
+				}
+			}
+			magnitude = _mm_or_si128(magnitude, _mm_srli_si128(magnitude, 8));
+			magnitude = _mm_or_si128(magnitude, _mm_srli_si128(magnitude, 4));
+
+			// Passes with h < 4, and the last values of k if h is not a multiple of 4
+			return static_cast<unsigned short int>(_mm_cvtsi128_si32(magnitude) | _scalar::template radix4<Inverse>(data, size, h, vector_end, h, twiddles, scale));
+		}
+	};
+
+	template<>
+	struct _fp_fft_kernel<short int, fp_round_truncate> : _fp_fft_kernel16<false>{};
+
+	template<>
+	struct _fp_fft_kernel<short int, fp_round_half_up> : _fp_fft_kernel16<true>{};
+#endif
+
+///	A plan for fast Fourier transforms of one size, with its twiddle tables
+/**
+ *	Transforms work in place on arrays of FixedPointComplex, as radix 4 passes after a radix 2 pass for sizes that are
+ *	an odd power of two. Twiddles are computed once by the plan with the integer sine and cosine of fp_math.h, so they are
+ *	the same on every platform, and a plan can be shared by any number of threads.
+ *	Each pass scales by a power of two chosen from the largest magnitude its input reached (block floating point), only as
+ *	much as needed for the pass not to overflow, and the transform returns the total: the true result is the array times 2^exponent.
+ *	The inverse transform includes the 1 / size factor in the exponent, so an inverse after a forward transform gives back the input
+ *	once both exponents are applied. IntegerType must be signed and have a built-in type of twice its width, which long long int only has with __int128
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits, typename OverflowPolicy = fp_wrap>
+class FixedPointFft{
+public:
+	typedef FixedPointComplex<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+
+private:
+	typedef _fp_fft_kernel<IntegerType, _fp_rounding> _kernel;
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type _unsigned_type;
+
+	static const count_type _digits = std::numeric_limits<IntegerType>::digits;
+
+	#ifdef FIXEDPOINT_CPP0X
+		static_assert(std::numeric_limits<IntegerType>::is_signed && _fp_int_traits<IntegerType>::native_wide, "FixedPointFft needs a signed type with a built-in type of twice its width");
+	#endif
+
+	size_t _size;
+	count_type _bits;
+	// Tables of the radix 4 passes in turn
+	FixedPointArray<IntegerType, 1, _digits - 1> _twiddles;
+
+	// Stores e^(-2 pi i * k / 2^bits) at twiddle
+	static void _twiddle(IntegerType* twiddle, size_t k, count_type bits){
+		typedef FixedPoint<long long int, 3, 60> angle_type;
+		angle_type sine, cosine;
+		fp_sincos(angle_type(_fp_math_int(_fp_math_mul(_fp_math_uint(_fp_math_pi), _fp_math_uint(k), bits - 1))), sine, cosine);
+		twiddle[0] = IntegerType(_fp_math_shift(cosine(), int(_digits) - 61));
+		twiddle[1] = IntegerType(-_fp_math_shift(sine(), int(_digits) - 61));
+	}
+
+	// Right shift for a pass that grows magnitudes by less than 2^growth, so that its results fit
+	static count_type _scale(_unsigned_type magnitude, count_type growth){
+		const count_type length = _fp_bit_length(magnitude);
+		return length + growth > _digits ? count_type(length + growth - _digits) : 0;
+	}
+
+	// Swaps every element with the one at the bit-reversed index, returns the OR of the magnitudes
+	_unsigned_type _reorder(IntegerType* data) const{
+		_unsigned_type magnitude = 0;
+		for (size_t i = 0, j = 0; i < _size; i++){
+			if (i < j){
+				for (size_t part = 0; part < 2; part++){
+					const IntegerType swapped = data[2 * i + part];
+					data[2 * i + part] = data[2 * j + part];
+					data[2 * j + part] = swapped;
+				}
+			}
+			magnitude |= _fp_magnitude(data[2 * i]) | _fp_magnitude(data[2 * i + 1]);
+
+			size_t bit = _size >> 1;
+			for (; j & bit; bit >>= 1){
+				j ^= bit;
+			}
+			j |= bit;
+		}
+		return magnitude;
+	}
+
+	template<bool Inverse>
+	int _transform(value_type* values) const{
+		IntegerType* const data = _fp_raw(&values->real());
+		_unsigned_type magnitude = _reorder(data);
+		int exponent = 0;
+
+		// The radix 2 pass doubles magnitudes, and keeps one more bit so that rounding cannot reach the limit
+		size_t h = 1;
+		if (_bits & 1){
+			const count_type scale = _scale(magnitude, 2);
+			magnitude = _kernel::radix2(data, _size, scale);
+			exponent += scale;
+			h = 2;
+		}
+
+		// A radix 4 butterfly grows magnitudes by at most 1 + 3 * sqrt(2) < 8
+		const IntegerType* twiddles = _fp_raw(_twiddles.data());
+		for (; h < _size; h *= 4){
+			const count_type scale = _scale(magnitude, 3);
+			magnitude = _kernel::template radix4<Inverse>(data, _size, h, twiddles, scale);
+			exponent += scale;
+			twiddles += 6 * h;
+		}
+		return Inverse ? exponent - int(_bits) : exponent;
+	}
+
+public:
+	/// Plan for transforms of size values
+	/**
+	 *	@param size Number of values, a power of two
+	 */
+	explicit FixedPointFft(size_t size) : _size(size), _bits(_fp_bit_length(size) - 1){
+		size_t count = 0;
+		for (size_t h = (_bits & 1) ? 2 : 1; h < size; h *= 4){
+			count += 6 * h;
+		}
+		_twiddles.resize(count);
+
+		IntegerType* twiddle = _fp_raw(_twiddles.data());
+		for (size_t h = (_bits & 1) ? 2 : 1, bits = (_bits & 1) ? 3 : 2; h < size; h *= 4, bits += 2){
+			for (size_t k = 0; k < h; k++){
+				_twiddle(twiddle + 2 * k, 2 * k, count_type(bits));
+				_twiddle(twiddle + 2 * (h + k), k, count_type(bits));
+				_twiddle(twiddle + 2 * (2 * h + k), 3 * k, count_type(bits));
+			}
+			twiddle += 6 * h;
+		}
+	}
+
+	/// Returns the number of values of a transform
+	/**
+	 *	@return Size of the transforms
+	 */
+	size_t size() const{
+		return _size;
+	}
+
+	/// Forward transform in place
+	/**
+	 *	@param values size() values, replaced by their transform times 2^-exponent
+	 *	@return Exponent of the result
+	 */
+	int forward(value_type* values) const{
+		return _transform<false>(values);
+	}
+
+	/// Forward transform into another array
+	/**
+	 *	@param out Array receiving the transform times 2^-exponent
+	 *	@param in size() values to transform
+	 *	@return Exponent of the result
+	 */
+	int forward(value_type* out, const value_type* in) const{
+		for (size_t i = 0; i < _size; i++){
+			out[i] = in[i];
+		}
+		return _transform<false>(out);
+	}
+
+	/// Forward transforms of consecutive channels in place
+	/**
+	 *	@param values channels * size() values, channel c starting at values + c * size()
+	 *	@param channels Number of channels
+	 *	@param exponents Array receiving the exponent of each channel
+	 */
+	void forward(value_type* values, size_t channels, int* exponents) const{
+		for (size_t channel = 0; channel < channels; channel++){
+			exponents[channel] = _transform<false>(values + channel * _size);
+		}
+	}
+
+	/// Inverse transform in place
+	/**
+	 *	@param values size() values, replaced by their inverse transform times 2^-exponent
+	 *	@return Exponent of the result, including the 1 / size() factor
+	 */
+	int inverse(value_type* values) const{
+		return _transform<true>(values);
+	}
+
+	/// Inverse transform into another array
+	/**
+	 *	@param out Array receiving the inverse transform times 2^-exponent
+	 *	@param in size() values to transform
+	 *	@return Exponent of the result, including the 1 / size() factor
+	 */
+	int inverse(value_type* out, const value_type* in) const{
+		for (size_t i = 0; i < _size; i++){
+			out[i] = in[i];
+		}
+		return _transform<true>(out);
+	}
+
+	/// Inverse transforms of consecutive channels in place
+	/**
+	 *	@param values channels * size() values, channel c starting at values + c * size()
+	 *	@param channels Number of channels
+	 *	@param exponents Array receiving the exponent of each channel
+	 */
+	void inverse(value_type* values, size_t channels, int* exponents) const{
+		for (size_t channel = 0; channel < channels; channel++){
+			exponents[channel] = _transform<true>(values + channel * _size);
+		}
+	}
+};
+
+#endif//H_FP_FFT
@@ -0,0 +1,459 @@
+/**
+ *	@file fp_file.h
+ *	Adds a binary file format for columns of FixedPoints, read back by mapping the file into memory
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_FILE
+#define H_FP_FILE
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "fp_array.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define FIXEDPOINT_MMAP
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+/*
+ *	File layout, every number in the header little endian:
+ *	 0	8 bytes		"FIXEDPT" and a zero byte
+ *	 8	2 bytes		version, 1
+ *	10	1 byte		bits of the content type, including the sign
+ *	11	1 byte		1 if the content type is signed
+ *	12	1 byte		IntegerBits
+ *	13	1 byte		FractionalBits
+ *	14	1 byte		byte order of the values, 0 for little endian, 1 for big endian
+ *	15	1 byte		zero
+ *	16	8 bytes		number of columns
+ *	24	8 bytes		number of rows, the same for every column
+ *	32	8 bytes		bytes from the start of a column to the start of the next one
+ *	40	24 bytes	zero
+ *	The raw content of each column follows, starting at byte 64 and every stride bytes after, stride being a multiple of 64
+ */
+static const size_t _fp_file_header_size = 64;
+static const size_t _fp_file_alignment = 64;
+static const unsigned short _fp_file_version = 1;
+
+/// Results of file operations
+enum fp_file_status{
+	fp_file_ok,
+	fp_file_io_error,			///< The file could not be opened, read, written or mapped
+	fp_file_invalid,			///< Not a FixedPoint file, truncated, or columns of different lengths given to the writer
+	fp_file_format_mismatch		///< The values have another format or byte order than the FixedPoints they are read as
+};
+
+// Byte order of this platform, as stored in the header
+inline unsigned char _fp_file_byte_order(){
+	const unsigned int one = 1;
+	unsigned char first = 0;
+	std::memcpy(&first, &one, 1);
+	return first ? 0 : 1;
+}
+
+inline void _fp_file_put(unsigned char* bytes, unsigned long long int value, size_t size){
+	for (size_t i = 0; i < size; i++, value >>= 8){
+		bytes[i] = static_cast<unsigned char>(value);
+	}
+}
+
+inline unsigned long long int _fp_file_get(const unsigned char* bytes, size_t size){
+	unsigned long long int value = 0;
+	for (size_t i = size; i--;){
+		value = (value << 8) | bytes[i];
+	}
+	return value;
+}
+
+// Header fields, as written by FixedPointFileWriter and checked by FixedPointFile
+struct _fp_file_header{
+	unsigned char bits;
+	bool is_signed;
+	count_type integer_bits;
+	count_type fractional_bits;
+	unsigned char byte_order;
+	unsigned long long int columns;
+	unsigned long long int rows;
+	unsigned long long int stride;
+
+	void write(unsigned char* bytes) const{
+		std::memset(bytes, 0, _fp_file_header_size);
+		std::memcpy(bytes, "FIXEDPT", 8);
+		_fp_file_put(bytes + 8, _fp_file_version, 2);
+		bytes[10] = bits;
+		bytes[11] = is_signed ? 1 : 0;
+		bytes[12] = integer_bits;
+		bytes[13] = fractional_bits;
+		bytes[14] = byte_order;
+		_fp_file_put(bytes + 16, columns, 8);
+		_fp_file_put(bytes + 24, rows, 8);
+		_fp_file_put(bytes + 32, stride, 8);
+	}
+
+	bool read(const unsigned char* bytes){
+		if (std::memcmp(bytes, "FIXEDPT", 8) != 0 || _fp_file_get(bytes + 8, 2) != _fp_file_version){
+			return false;
+		}
+		bits = bytes[10];
+		is_signed = bytes[11] != 0;
+		integer_bits = bytes[12];
+		fractional_bits = bytes[13];
+		byte_order = bytes[14];
+		columns = _fp_file_get(bytes + 16, 8);
+		rows = _fp_file_get(bytes + 24, 8);
+		stride = _fp_file_get(bytes + 32, 8);
+		return true;
+	}
+
+	template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+	static _fp_file_header describe(){
+		_fp_file_header header;
+		header.bits = static_cast<unsigned char>(std::numeric_limits<IntegerType>::digits + std::numeric_limits<IntegerType>::is_signed);
+		header.is_signed = std::numeric_limits<IntegerType>::is_signed;
+		header.integer_bits = IntegerBits;
+		header.fractional_bits = FractionalBits;
+		header.byte_order = _fp_file_byte_order();
+		header.columns = 0;
+		header.rows = 0;
+		header.stride = 0;
+		return header;
+	}
+};
+
+///	Writes columns of FixedPoints to a file, one after the other, without holding them in memory
+/**
+ *	e.g. writer.open("prices.fp"); writer.write(bid, n); writer.next_column(); writer.write(ask, n); writer.close();
+ *	Each column may be written in any number of pieces, and every column must have as many values as the first.
+ *	The values are written in the byte order of this platform, which the header records
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits, typename OverflowPolicy = fp_wrap>
+class FixedPointFileWriter{
+public:
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	typedef FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> view_type;
+	typedef FixedPointConstView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> const_view_type;
+
+private:
+	std::FILE* _file;
+	_fp_file_header _header;
+	unsigned long long int _written;
+	fp_file_status _status;
+
+	// Not copyable
+	FixedPointFileWriter(const FixedPointFileWriter<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>&);
+	FixedPointFileWriter<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator=(const FixedPointFileWriter<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>&);
+
+	bool _zeros(size_t count){
+		const unsigned char zeros[_fp_file_alignment] = {0};
+		while (count){
+			const size_t block = count < _fp_file_alignment ? count : _fp_file_alignment;
+			if (std::fwrite(zeros, 1, block, _file) != block){
+				return false;
+			}
+			count -= block;
+		}
+		return true;
+	}
+
+	// Ends the column being written, returns false if it has another length than the first
+	bool _end_column(){
+		if (_header.columns == 0){
+			_header.rows = _written;
+			_header.stride = (_written * sizeof(value_type) + _fp_file_alignment - 1) / _fp_file_alignment * _fp_file_alignment;
+		}else if (_written != _header.rows){
+			_status = fp_file_invalid;
+			return false;
+		}
+		++_header.columns;
+		_written = 0;
+		if (!_zeros(size_t(_header.stride - _header.rows * sizeof(value_type)))){
+			_status = fp_file_io_error;
+			return false;
+		}
+		return true;
+	}
+
+public:
+	/// Writer with no file
+	FixedPointFileWriter() : _file(0), _header(_fp_file_header::describe<IntegerType, IntegerBits, FractionalBits>()), _written(0), _status(fp_file_ok){}
+
+	/// Writer of a new file
+	/**
+	 *	@param path File to create, replaced if it exists
+	 */
+	explicit FixedPointFileWriter(const char* path) : _file(0), _header(_fp_file_header::describe<IntegerType, IntegerBits, FractionalBits>()), _written(0), _status(fp_file_ok){
+		open(path);
+	}
+
+	/// Closes the file
+	~FixedPointFileWriter(){
+		close();
+	}
+
+	/// Creates a file, closing the one being written first
+	/**
+	 *	@param path File to create, replaced if it exists
+	 *	@return fp_file_ok, or fp_file_io_error if the file could not be created
+	 */
+	fp_file_status open(const char* path){
+		close();
+		_header = _fp_file_header::describe<IntegerType, IntegerBits, FractionalBits>();
+		_written = 0;
+		_file = std::fopen(path, "wb");
+		_status = _file && _zeros(_fp_file_header_size) ? fp_file_ok : fp_file_io_error;
+		return _status;
+	}
+
+	bool is_open() const{
+		return _file != 0;
+	}
+
+	/// Returns the first error met since the file was opened
+	/**
+	 *	@return fp_file_ok if there was none
+	 */
+	fp_file_status status() const{
+		return _status;
+	}
+
+	/// Appends values to the column being written
+	/**
+	 *	@param values Values to append
+	 *	@param count Number of values
+	 *	@return Status of the file
+	 */
+	fp_file_status write(const value_type* values, size_t count){
+		if (_status == fp_file_ok && (!_file || std::fwrite(values, sizeof(value_type), count, _file) != count)){
+			_status = fp_file_io_error;
+		}
+		_written += count;
+		return _status;
+	}
+
+	/// Appends the values of a view to the column being written
+	/**
+	 *	@param values Values to append
+	 *	@return Status of the file
+	 */
+	fp_file_status write(const const_view_type& values){
+		return write(values.data(), values.size());
+	}
+
+	/// Ends the column being written, the next values start another one
+	/**
+	 *	@return Status of the file, fp_file_invalid if the column has another length than the first
+	 */
+	fp_file_status next_column(){
+		if (_status == fp_file_ok && _file){
+			_end_column();
+		}
+		return _status;
+	}
+
+	/// Ends the column being written if it has values, writes the header and closes the file
+	/**
+	 *	A file that was not written completely is left without a valid header
+	 *	@return Status of the file
+	 */
+	fp_file_status close(){
+		if (!_file){
+			return _status;
+		}
+		if (_status == fp_file_ok && _written){
+			_end_column();
+		}
+		if (_status == fp_file_ok){
+			unsigned char header[_fp_file_header_size];
+			_header.write(header);
+			if (std::fseek(_file, 0, SEEK_SET) != 0 || std::fwrite(header, 1, _fp_file_header_size, _file) != _fp_file_header_size){
+				_status = fp_file_io_error;
+			}
+		}
+		if (std::fclose(_file) != 0 && _status == fp_file_ok){
+			_status = fp_file_io_error;
+		}
+		_file = 0;
+		return _status;
+	}
+};
+
+///	A file of columns of FixedPoints, mapped into memory and read in place
+/**
+ *	Opening a file maps it and checks its header, nothing is copied or parsed, so opening takes the same time whatever the size
+ *	of the file and pages are only read when they are used. The values must have the format and the byte order of the template parameters.
+ *	Columns are views of the mapping, aligned to 64 bytes. The mapping is private: values may be changed in memory, which never changes the file.
+ *	Where the system has no mmap, the file is read into memory instead
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits, typename OverflowPolicy = fp_wrap>
+class FixedPointFile{
+public:
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	typedef FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> view_type;
+	typedef FixedPointConstView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> const_view_type;
+
+private:
+	unsigned char* _data;
+	size_t _length;
+	_fp_file_header _header;
+
+	// Not copyable
+	FixedPointFile(const FixedPointFile<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>&);
+	FixedPointFile<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator=(const FixedPointFile<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>&);
+
+	// Maps or reads the whole file into _data
+	fp_file_status _load(const char* path){
+		#ifdef FIXEDPOINT_MMAP
+			const int descriptor = ::open(path, O_RDONLY);
+			if (descriptor < 0){
+				return fp_file_io_error;
+			}
+			struct stat information;
+			if (::fstat(descriptor, &information) != 0){
+				::close(descriptor);
+				return fp_file_io_error;
+			}
+			if (information.st_size < off_t(_fp_file_header_size)){
+				::close(descriptor);
+				return fp_file_invalid;
+			}
+			_length = size_t(information.st_size);
+			void* const mapping = ::mmap(0, _length, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+			::close(descriptor);
+			if (mapping == MAP_FAILED){
+				_length = 0;
+				return fp_file_io_error;
+			}
+			_data = static_cast<unsigned char*>(mapping);
+			return fp_file_ok;
+		#else
+			std::FILE* const file = std::fopen(path, "rb");
+			if (!file){
+				return fp_file_io_error;
+			}
+			long length = -1;
+			if (std::fseek(file, 0, SEEK_END) == 0){
+				length = std::ftell(file);
+			}
+			if (length < long(_fp_file_header_size) || std::fseek(file, 0, SEEK_SET) != 0){
+				std::fclose(file);
+				return length < 0 ? fp_file_io_error : fp_file_invalid;
+			}
+			_length = size_t(length);
+			_data = static_cast<unsigned char*>(_fp_aligned_alloc(_length));
+			const bool read = std::fread(_data, 1, _length, file) == _length;
+			std::fclose(file);
+			return read ? fp_file_ok : fp_file_io_error;
+		#endif
+	}
+
+	// Whether the columns described by the header lie within the file, checked without overflowing
+	bool _complete() const{
+		const unsigned long long int available = _length - _fp_file_header_size;
+		if (_header.stride % _fp_file_alignment != 0 || _header.rows > _header.stride / sizeof(value_type)){
+			return false;
+		}
+		if (_header.columns == 0){
+			return true;
+		}
+		const unsigned long long int last = _header.columns - 1;
+		return (_header.stride == 0 || last <= available / _header.stride) && last * _header.stride + _header.rows * sizeof(value_type) <= available;
+	}
+
+public:
+	/// No file
+	FixedPointFile() : _data(0), _length(0), _header(_fp_file_header::describe<IntegerType, IntegerBits, FractionalBits>()){}
+
+	/// Opens a file, see open
+	/**
+	 *	@param path File to open
+	 */
+	explicit FixedPointFile(const char* path) : _data(0), _length(0), _header(_fp_file_header::describe<IntegerType, IntegerBits, FractionalBits>()){
+		open(path);
+	}
+
+	~FixedPointFile(){
+		close();
+	}
+
+	/// Maps a file, closing the one already open first
+	/**
+	 *	@param path File to open
+	 *	@return fp_file_ok, fp_file_io_error, fp_file_invalid if it is not a complete FixedPoint file,
+	 *	or fp_file_format_mismatch if the values are not in the format or byte order of value_type. Nothing stays open on failure
+	 */
+	fp_file_status open(const char* path){
+		close();
+		fp_file_status status = _load(path);
+		if (status == fp_file_ok){
+			const _fp_file_header expected = _fp_file_header::describe<IntegerType, IntegerBits, FractionalBits>();
+			if (!_header.read(_data) || !_complete()){
+				status = fp_file_invalid;
+			}else if (_header.bits != expected.bits || _header.is_signed != expected.is_signed || _header.integer_bits != IntegerBits || _header.fractional_bits != FractionalBits || _header.byte_order != expected.byte_order){
+				status = fp_file_format_mismatch;
+			}
+		}
+		if (status != fp_file_ok){
+			close();
+		}
+		return status;
+	}
+
+	/// Unmaps the file
+	void close(){
+		if (_data){
+			#ifdef FIXEDPOINT_MMAP
+				::munmap(_data, _length);
+			#else
+				_fp_aligned_free(_data);
+			#endif
+		}
+		_data = 0;
+		_length = 0;
+		_header = _fp_file_header::describe<IntegerType, IntegerBits, FractionalBits>();
+	}
+
+	bool is_open() const{
+		return _data != 0;
+	}
+
+	/// Returns the number of columns
+	size_t columns() const{
+		return size_t(_header.columns);
+	}
+
+	/// Returns the number of values in each column
+	size_t rows() const{
+		return size_t(_header.rows);
+	}
+
+	/// Returns a view of a column, valid until the file is closed
+	/**
+	 *	@param index Index of the column
+	 *	@return View of the values of the column
+	 */
+	view_type column(size_t index){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (index >= columns()){
+				_fp_event<value_type>(fp_event_range, "FixedPointFile::column");
+			}
+		#endif
+		return view_type(reinterpret_cast<value_type*>(_data + _fp_file_header_size + index * size_t(_header.stride)), rows());
+	}
+
+	const_view_type column(size_t index) const{
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (index >= columns()){
+				_fp_event<value_type>(fp_event_range, "FixedPointFile::column");
+			}
+		#endif
+		return const_view_type(reinterpret_cast<const value_type*>(_data + _fp_file_header_size + index * size_t(_header.stride)), rows());
+	}
+};
+
+#endif//H_FP_FILE
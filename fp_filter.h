@@ -0,0 +1,404 @@
+/**
+ *	@file fp_filter.h
+ *	Adds streaming FIR and biquad IIR filters on FixedPoint samples
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_FILTER
+#define H_FP_FILTER
+
+#include <algorithm>
+#include <cstddef>
+
+#include "fp_matrix.h"
+
+// Add the following line to your code before any #include "fp_*.h"
+// to change how many samples a FIR filter buffers after its history. Larger blocks move the
+// history less often, smaller ones keep the buffer in the level 1 cache
+//#define FIXEDPOINT_FILTER_BLOCK 256
+#ifndef FIXEDPOINT_FILTER_BLOCK
+	#define FIXEDPOINT_FILTER_BLOCK 256
+#endif
+
+///	A FIR filter over a stream of FixedPoint samples, with optional decimation
+/**
+ *	Each output is the dot product of the coefficients and the last taps samples, summed at full precision as by fp_dot
+ *	and rescaled once by CoefficientFractionalBits, through the rounding policy and then the overflow policy.
+ *	Coefficients share the integer type of the samples but may have another number of fractional bits, e.g. Q2.14 coefficients for Q1.15 samples.
+ *	Samples are appended to a linear delay line, which is moved back to its start once per FIXEDPOINT_FILTER_BLOCK samples, so every
+ *	window is contiguous for the vector loops of fp_matrix.h. Four outputs are computed together, loading each coefficient once.
+ *	With a decimation of M, only every Mth output is computed, the ones in between are never formed
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits, typename OverflowPolicy = fp_wrap, count_type CoefficientFractionalBits = FractionalBits>
+class FixedPointFir{
+public:
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	typedef FixedPoint<IntegerType, std::numeric_limits<IntegerType>::digits - CoefficientFractionalBits, CoefficientFractionalBits, OverflowPolicy> coefficient_type;
+	typedef FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> view_type;
+	typedef FixedPointConstView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> const_view_type;
+
+private:
+	// Kept in reverse order, so that the oldest sample of a window meets the last coefficient
+	FixedPointArray<IntegerType, std::numeric_limits<IntegerType>::digits - CoefficientFractionalBits, CoefficientFractionalBits, OverflowPolicy> _coefficients;
+	FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> _history;
+	size_t _length;
+	size_t _decimation;
+	size_t _phase;
+
+	// Computes the outputs of the samples at first, first + decimation, ... before end, returns how many
+	size_t _outputs(value_type* out, size_t first, size_t end) const{
+		typedef _fp_dot_kernel<IntegerType> kernel;
+		const size_t taps = _coefficients.size();
+		const IntegerType* const coefficients = _fp_raw(_coefficients.data());
+		const IntegerType* const history = _fp_raw(_history.data());
+
+		size_t produced = 0;
+		size_t sample = first;
+		for (; sample + 3 * _decimation < end; sample += 4 * _decimation){
+			_fp_accumulator<IntegerType> accumulators[4];
+			kernel::dot4(coefficients, history + sample + 1 - taps, _decimation, taps, accumulators);
+			for (size_t k = 0; k < 4; k++){
+				_fp_accumulated(out[produced++], accumulators[k], CoefficientFractionalBits, "FixedPointFir");
+			}
+		}
+		for (; sample < end; sample += _decimation){
+			_fp_accumulator<IntegerType> accumulator;
+			kernel::dot(coefficients, history + sample + 1 - taps, taps, accumulator);
+			_fp_accumulated(out[produced++], accumulator, CoefficientFractionalBits, "FixedPointFir");
+		}
+		return produced;
+	}
+
+public:
+	/// Filter with a history of zeros
+	/**
+	 *	@param coefficients Impulse response, at least one coefficient, coefficients[0] applies to the newest sample
+	 *	@param taps Number of coefficients
+	 *	@param decimation Number of input samples per output sample, at least 1
+	 */
+	FixedPointFir(const coefficient_type* coefficients, size_t taps, size_t decimation = 1) : _coefficients(taps), _history(taps - 1 + FIXEDPOINT_FILTER_BLOCK), _length(taps - 1), _decimation(decimation), _phase(0){
+		for (size_t i = 0; i < taps; i++){
+			_coefficients[i] = coefficients[taps - 1 - i];
+		}
+	}
+
+	/// Returns the number of coefficients
+	/**
+	 *	@return Number of coefficients
+	 */
+	size_t taps() const{
+		return _coefficients.size();
+	}
+
+	/// Returns the number of input samples per output sample
+	/**
+	 *	@return Decimation factor
+	 */
+	size_t decimation() const{
+		return _decimation;
+	}
+
+	/// Returns a coefficient
+	/**
+	 *	@param index Index of the coefficient, 0 for the newest sample
+	 *	@return Coefficient
+	 */
+	coefficient_type coefficient(size_t index) const{
+		return _coefficients[_coefficients.size() - 1 - index];
+	}
+
+	/// Clears the history and restarts the decimation phase
+	void reset(){
+		_history.fill(value_type());
+		_length = taps() - 1;
+		_phase = 0;
+	}
+
+	/// Filters a block of samples
+	/**
+	 *	The history carries over from the previous block, so a stream can be split into blocks of any size.
+	 *	out receives (phase + count) / decimation samples, where phase is the number of samples given since the last output,
+	 *	and may be the same array as in
+	 *	@param out Array receiving the filtered samples
+	 *	@param in Input samples
+	 *	@param count Number of input samples
+	 *	@return Number of samples written to out
+	 */
+	size_t process(value_type* out, const value_type* in, size_t count){
+		const size_t taps = _coefficients.size();
+		size_t produced = 0;
+
+		while (count){
+			const size_t room = _history.size() - _length;
+			const size_t added = count < room ? count : room;
+			std::copy(_fp_raw(in), _fp_raw(in + added), _fp_raw(_history.data() + _length));
+
+			// The next output belongs to the sample that completes the decimation phase
+			const size_t first = _length + _decimation - 1 - _phase;
+			_length += added;
+			in += added;
+			count -= added;
+			_phase = (_phase + added) % _decimation;
+
+			produced += _outputs(out + produced, first, _length);
+
+			if (_length == _history.size()){
+				// Moved toward the start, which std::copy allows for overlapping ranges
+				IntegerType* const history = _fp_raw(_history.data());
+				std::copy(history + _length - (taps - 1), history + _length, history);
+				_length = taps - 1;
+			}
+		}
+		return produced;
+	}
+
+	/// Filters a view of samples
+	/**
+	 *	@param out View receiving the filtered samples, large enough for all of them
+	 *	@param in Input samples
+	 *	@return Number of samples written to out
+	 */
+	size_t process(view_type out, const const_view_type& in){
+		return process(out.data(), in.data(), in.size());
+	}
+};
+
+// Filters step consecutive channels of a biquad section at once, from the section input to its output and state,
+// and returns how many channels it filtered. b holds b0, b1, b2, a1 and a2. The scalar kernel leaves every channel to the
+// loop of FixedPointBiquad, which rescales them with any policy
+template<typename IntegerType>
+struct _fp_biquad_kernel{
+	template<typename Rounding, typename OverflowPolicy>
+	static size_t filter(const IntegerType*, count_type, const IntegerType*, IntegerType*, IntegerType*, IntegerType*, IntegerType*, IntegerType*, size_t){
+		return 0;
+	}
+};
+
+#ifdef FIXEDPOINT_SSE2
+	// Policies the vector kernels rescale with, truncation or rounding half up, then wrapping or saturation.
+	// Others, and every policy of instrumented builds, which count overflows, are left to the scalar loop
+	template<typename Rounding>
+	struct _fp_biquad_rounding{
+		static const bool vector = false;
+		static const bool half_up = false;
+	};
+
+	template<>
+	struct _fp_biquad_rounding<fp_round_truncate>{
+		static const bool vector = true;
+		static const bool half_up = false;
+	};
+
+	template<>
+	struct _fp_biquad_rounding<fp_round_half_up>{
+		static const bool vector = true;
+		static const bool half_up = true;
+	};
+
+	template<typename OverflowPolicy>
+	struct _fp_biquad_overflow{
+		static const bool vector = false;
+		static const bool saturate = false;
+	};
+
+	template<>
+	struct _fp_biquad_overflow<fp_wrap>{
+		static const bool vector = true;
+		static const bool saturate = false;
+	};
+
+	template<>
+	struct _fp_biquad_overflow<fp_saturate>{
+		static const bool vector = true;
+		static const bool saturate = true;
+	};
+
+	// Adds or subtracts the full products of 8 signed 16 bit values and one coefficient to the 32 bit sums of channels 0-3 and 4-7
+	template<bool Subtract>
+	inline void _fp_biquad_mul_add16(__m128i* sums, __m128i values, short int coefficient){
+		const __m128i factor = _mm_set1_epi16(coefficient);
+		const __m128i low = _mm_mullo_epi16(values, factor);
+		const __m128i high = _mm_mulhi_epi16(values, factor);
+		const __m128i first = _mm_unpacklo_epi16(low, high);
+		const __m128i second = _mm_unpackhi_epi16(low, high);
+		sums[0] = Subtract ? _mm_sub_epi32(sums[0], first) : _mm_add_epi32(sums[0], first);
+		sums[1] = Subtract ? _mm_sub_epi32(sums[1], second) : _mm_add_epi32(sums[1], second);
+	}
+
+	// 8 channels of 16 bit content, summed in 32 bit lanes. The sum of a channel is at most 2^15 times the sum of the coefficient
+	// magnitudes, so it is exact when those add up to less than 2^16, e.g. to less than 4 for Q1.14 coefficients, which stable sections
+	// without a large gain do. Other sections are left to the scalar loop. Packing saturates to 16 bits, wrapping sign extends the low 16 bits first.
+	// 32 bit content is left to the scalar loop, SSE2 has no signed 32 bit multiply into 64 bits that would be faster than it
+	template<>
+	struct _fp_biquad_kernel<short int>{
+		static const size_t step = 8;
+
+		template<typename Rounding, typename OverflowPolicy>
+		static size_t filter(const short int* b, count_type shift, const short int* input, short int* output, short int* x1, short int* x2, short int* y1, short int* y2, size_t channels){
+			if (!_fp_biquad_rounding<Rounding>::vector || !_fp_biquad_overflow<OverflowPolicy>::vector || channels < step){
+				return 0;
+			}
+			int magnitudes = 0;
+			for (size_t i = 0; i < 5; i++){
+				magnitudes += b[i] < 0 ? -int(b[i]) : int(b[i]);
+			}
+			if (magnitudes >= 65536){
+				return 0;
+			}
+
+			const __m128i count = _mm_cvtsi32_si128(int(shift));
+			const __m128i last_count = _mm_cvtsi32_si128(int(shift) - 1);
+			size_t channel = 0;
+			for (; channel + step <= channels; channel += step){
+				const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + channel));
+				const __m128i last_x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x1 + channel));
+				const __m128i last_y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y1 + channel));
+
+				__m128i sums[2] = {_mm_setzero_si128(), _mm_setzero_si128()};
+				_fp_biquad_mul_add16<false>(sums, x, b[0]);
+				_fp_biquad_mul_add16<false>(sums, last_x, b[1]);
+				_fp_biquad_mul_add16<false>(sums, _mm_loadu_si128(reinterpret_cast<const __m128i*>(x2 + channel)), b[2]);
+				_fp_biquad_mul_add16<true>(sums, last_y, b[3]);
+				_fp_biquad_mul_add16<true>(sums, _mm_loadu_si128(reinterpret_cast<const __m128i*>(y2 + channel)), b[4]);
+
+				for (size_t i = 0; i < 2; i++){
+					__m128i shifted = _mm_sra_epi32(sums[i], count);
+					if (_fp_biquad_rounding<Rounding>::half_up && shift){
+						// Half up rounding adds the last bit shifted out
+						shifted = _mm_add_epi32(shifted, _mm_and_si128(_mm_srl_epi32(sums[i], last_count), _mm_set1_epi32(1)));
+					}
+					sums[i] = _fp_biquad_overflow<OverflowPolicy>::saturate ? shifted : _mm_srai_epi32(_mm_slli_epi32(shifted, 16), 16);
+				}
+				const __m128i y = _mm_packs_epi32(sums[0], sums[1]);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(x2 + channel), last_x);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(x1 + channel), x);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(y2 + channel), last_y);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(y1 + channel), y);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output + channel), y);
+			}
+			return channel;
+		}
+	};
+#endif
+
+///	A cascade of biquad IIR sections over one or more interleaved channels of FixedPoint samples
+/**
+ *	Each section computes y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2 (direct form I, a0 = 1), summing the five full products
+ *	and rescaling once by CoefficientFractionalBits, through the rounding policy and then the overflow policy.
+ *	The output of a section is the input of the next. Coefficients usually need an integer bit more than the samples, e.g. Q2.14 for Q1.15 samples.
+ *	All channels share the coefficients and each has its own state, which is stored by channel so that the inner loop runs over consecutive channels.
+ *	With SSE2, 8 channels of 16 bit content are filtered at once when truncating or rounding half up, then wrapping or saturating
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits, typename OverflowPolicy = fp_wrap, count_type CoefficientFractionalBits = FractionalBits>
+class FixedPointBiquad{
+public:
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	typedef FixedPoint<IntegerType, std::numeric_limits<IntegerType>::digits - CoefficientFractionalBits, CoefficientFractionalBits, OverflowPolicy> coefficient_type;
+	typedef FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> view_type;
+	typedef FixedPointConstView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> const_view_type;
+
+private:
+	FixedPointArray<IntegerType, std::numeric_limits<IntegerType>::digits - CoefficientFractionalBits, CoefficientFractionalBits, OverflowPolicy> _coefficients;
+	// x1, x2, y1 and y2 of every channel, for each section in turn
+	FixedPointArray<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> _state;
+	size_t _channels;
+
+public:
+	/// Cascade with a state of zeros
+	/**
+	 *	@param coefficients b0, b1, b2, a1 and a2 of each section in turn, with a0 normalized to 1
+	 *	@param sections Number of sections
+	 *	@param channels Number of interleaved channels
+	 */
+	FixedPointBiquad(const coefficient_type* coefficients, size_t sections, size_t channels = 1) : _coefficients(5 * sections), _state(4 * sections * channels), _channels(channels){
+		for (size_t i = 0; i < 5 * sections; i++){
+			_coefficients[i] = coefficients[i];
+		}
+	}
+
+	/// Returns the number of sections
+	/**
+	 *	@return Number of sections
+	 */
+	size_t sections() const{
+		return _coefficients.size() / 5;
+	}
+
+	/// Returns the number of interleaved channels
+	/**
+	 *	@return Number of channels
+	 */
+	size_t channels() const{
+		return _channels;
+	}
+
+	/// Clears the state of every section and channel
+	void reset(){
+		_state.fill(value_type());
+	}
+
+	/// Filters a block of interleaved frames
+	/**
+	 *	The state carries over from the previous block. out may be the same array as in
+	 *	@param out Array receiving frames * channels() filtered samples
+	 *	@param in Input samples, channel c of frame f at f * channels() + c
+	 *	@param frames Number of frames
+	 */
+	void process(value_type* out, const value_type* in, size_t frames){
+		const size_t sections = this->sections();
+		const size_t channels = _channels;
+		const IntegerType* const coefficients = _fp_raw(_coefficients.data());
+		IntegerType* const state = _fp_raw(_state.data());
+
+		for (size_t frame = 0; frame < frames; frame++){
+			const IntegerType* input = _fp_raw(in + frame * channels);
+			IntegerType* const output = _fp_raw(out + frame * channels);
+
+			for (size_t section = 0; section < sections; section++){
+				const IntegerType* const b = coefficients + 5 * section;
+				IntegerType* const x1 = state + 4 * channels * section;
+				IntegerType* const x2 = x1 + channels;
+				IntegerType* const y1 = x2 + channels;
+				IntegerType* const y2 = y1 + channels;
+
+				// The vector kernels filter whole steps of channels, with the policies they support, and the loop the rest
+				size_t channel = 0;
+				#ifndef FIXEDPOINT_INSTRUMENT
+					channel = _fp_biquad_kernel<IntegerType>::template filter<_fp_rounding, OverflowPolicy>(b, CoefficientFractionalBits, input, output, x1, x2, y1, y2, channels);
+				#endif
+				for (; channel < channels; channel++){
+					const IntegerType x = input[channel];
+
+					_fp_accumulator<IntegerType> accumulator;
+					accumulator.template mul_add<false>(b[0], x);
+					accumulator.template mul_add<false>(b[1], x1[channel]);
+					accumulator.template mul_add<false>(b[2], x2[channel]);
+					accumulator.template mul_add<true>(b[3], y1[channel]);
+					accumulator.template mul_add<true>(b[4], y2[channel]);
+
+					value_type y;
+					_fp_accumulated(y, accumulator, CoefficientFractionalBits, "FixedPointBiquad");
+
+					x2[channel] = x1[channel];
+					x1[channel] = x;
+					y2[channel] = y1[channel];
+					y1[channel] = y();
+					output[channel] = y();
+				}
+				input = output;
+			}
+		}
+	}
+
+	/// Filters a view of interleaved samples
+	/**
+	 *	@param out View receiving the filtered samples, at least as large as in
+	 *	@param in Input samples, a whole number of frames
+	 */
+	void process(view_type out, const const_view_type& in){
+		process(out.data(), in.data(), in.size() / _channels);
+	}
+};
+
+#endif//H_FP_FILTER
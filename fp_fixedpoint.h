@@ -11,6 +11,8 @@
 
 #include "fp_internal.h"
 
+// The fp_float macros expand to arguments for the component constructor. They evaluate _float_ several times,
+// prefer FixedPoint::from_float, which can also be evaluated at compile time
 #define fp_float(_inttype_, _fracsize_, _float_) \
 		(_inttype_)((_float_) >= 0 ? (_float_) : -(_float_)), \
 		(_inttype_)(((_float_) >= 0 ? (_float_) : -(_float_)) - ((_inttype_)((_float_) >= 0 ? (_float_) : -(_float_))) * (1 << (_fracsize_))), \
@@ -25,6 +27,60 @@
 #define fp_float_s(_inttype_, _fracsize_, _float_) \
 		((_float_) >= 0)
 
+// Format of a result with FIXEDPOINT_DEDUCEFORMAT. It is kept exactly in IntegerType if it fits, otherwise in the
+// double-width type if that is a built-in type no wider than long long int. If neither works, the result takes the format
+// of the left operand, as without FIXEDPOINT_DEDUCEFORMAT
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, count_type LeftIntegerBits, count_type LeftFractionalBits, typename OverflowPolicy>
+struct _fp_deduced_format{
+	typedef typename _fp_int_traits<IntegerType>::wide_type _wide_type;
+
+	static const bool _fits = IntegerBits + FractionalBits <= std::numeric_limits<IntegerType>::digits;
+	static const bool _widens = !_fits && _fp_int_traits<IntegerType>::native_wide && sizeof(_wide_type) <= sizeof(long long int)
+		&& IntegerBits + FractionalBits <= std::numeric_limits<_wide_type>::digits;
+
+	static const bool exact = _fits || _widens;
+	typedef typename _fp_select<_widens, _wide_type, IntegerType>::type integer_type;
+	static const count_type integer_bits = exact ? IntegerBits : LeftIntegerBits;
+	static const count_type fractional_bits = exact ? FractionalBits : LeftFractionalBits;
+
+	typedef FixedPoint<integer_type, integer_bits, fractional_bits, OverflowPolicy> type;
+};
+
+// The wider of two base types, the left one if they have the same size
+template<typename IntegerType, typename OtherIntegerType>
+struct _fp_common_type : _fp_select<(sizeof(OtherIntegerType) > sizeof(IntegerType)), OtherIntegerType, IntegerType>{};
+
+// Sums and differences keep the larger integer part and the finer fractional part
+template<typename IntegerType, count_type LeftIntegerBits, count_type LeftFractionalBits, count_type RightIntegerBits, count_type RightFractionalBits, typename OverflowPolicy>
+struct _fp_sum_format : _fp_deduced_format<IntegerType,
+	(LeftIntegerBits > RightIntegerBits ? LeftIntegerBits : RightIntegerBits), (LeftFractionalBits > RightFractionalBits ? LeftFractionalBits : RightFractionalBits),
+	LeftIntegerBits, LeftFractionalBits, OverflowPolicy>{};
+
+// Products add up both parts
+template<typename IntegerType, count_type LeftIntegerBits, count_type LeftFractionalBits, count_type RightIntegerBits, count_type RightFractionalBits, typename OverflowPolicy>
+struct _fp_product_format : _fp_deduced_format<IntegerType, LeftIntegerBits + RightIntegerBits, LeftFractionalBits + RightFractionalBits,
+	LeftIntegerBits, LeftFractionalBits, OverflowPolicy>{};
+
+// The raw product is already in the deduced format when it is exact
+template<typename Format, bool Exact = Format::exact>
+struct _fp_deduced_product{
+	template<typename Left, typename Right>
+	static FIXEDPOINT_CONSTEXPR typename Format::type apply(const Left& left, const Right& right){
+		typedef typename Format::integer_type integer_type;
+		return typename Format::type(integer_type(integer_type(left()) * integer_type(right())));
+	}
+};
+
+// Otherwise both operands are brought to the common base type and multiplied as without FIXEDPOINT_DEDUCEFORMAT
+template<typename Format>
+struct _fp_deduced_product<Format, false>{
+	template<typename Left, typename Right>
+	static FIXEDPOINT_CONSTEXPR typename Format::type apply(const Left& left, const Right& right){
+		typedef typename Format::integer_type integer_type;
+		return typename Format::type(left) *= right.template convert<integer_type, Right::i_bits, Right::f_bits>();
+	}
+};
+
 ///	A lightweight class for easy manipulation of various fixed point number types.
 /**
  *	FixedPoint is a templated class that takes an integer data type
@@ -33,11 +89,13 @@
  *	If the second integer is not specified, FixedPoint will make use of all availible bits. The number of bits used must be less than those available in the data type.
  *	FixedPoint defines the basic mathematical operations, as well as other utilitous function, such as returning
  *	only the integer or decimal portion. The contained fixed point number can be passed to another function expecting the raw fixed point number by calling operator().
+ *	An optional fourth argument chooses what happens when a result does not fit: fp_wrap (the default) discards the extra bits,
+ *	fp_saturate clamps to the largest or smallest value, and fp_trap calls FIXEDPOINT_TRAP().
  *	The class makes a few (minor) assumptions, such as that your compiler uses 2's complement for signed values and implementation-defined operations such as signed
  *	left shift work in the standard manner.
  */
 
-template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
 class FixedPoint{
 	static const bool _signed = std::numeric_limits<IntegerType>::is_signed;
 	static const count_type _TotalBits = std::numeric_limits<IntegerType>::digits;
@@ -49,19 +107,34 @@ class FixedPoint{
 		static_assert(_UsedBits <= _TotalBits, "Invalid fixed point position");
 	#endif
 
-	// Returns the integer portion, unsigned
-	IntegerType _i() const{
-		return (_content >= 0 ? _content : -_content) >> FractionalBits;
+	// Returns the integer portion, unsigned. Formats whose fractional bits fill IntegerType have none
+	FIXEDPOINT_CONSTEXPR IntegerType _i() const{
+		return FractionalBits < _TotalBits ? IntegerType((_content >= 0 ? _content : -_content) >> (FractionalBits % _TotalBits)) : IntegerType(0);
 	}
 
-	// Returns the decimal portion, unsigned
-	IntegerType _d() const{
-		return (_content >= 0 ? _content : -_content) & ((1 << FractionalBits) - 1);
+	// Returns the decimal portion, unsigned. Formats whose fractional bits fill IntegerType are all decimal portion
+	FIXEDPOINT_CONSTEXPR IntegerType _d() const{
+		return FractionalBits < _TotalBits ? IntegerType((_content >= 0 ? _content : -_content) & ((IntegerType(1) << (FractionalBits % _TotalBits)) - 1)) : IntegerType(_content >= 0 ? _content : -_content);
 	}
 
-	bool _negative() const{
+	FIXEDPOINT_CONSTEXPR bool _negative() const{
 		return _signed && (_content < 0);
 	}
+
+	#ifdef FIXEDPOINT_INSTRUMENT
+		// Only calls into the counters when there is an event, so operations without one stay constant expressions
+		static FIXEDPOINT_CONSTEXPR void _record(fp_event event, const char* operation){
+			if (event != fp_event_count){
+				_fp_event<FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(event, operation);
+			}
+		}
+	#endif
+
+	// 2^FractionalBits, in two steps since FractionalBits may be the full width of IntegerType
+	static FIXEDPOINT_CONSTEXPR long double _scale(){
+		typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+		return (long double)(unsigned_type(1) << (FractionalBits / 2)) * (long double)(unsigned_type(1) << (FractionalBits - FractionalBits / 2));
+	}
 	
 public:
 
@@ -69,14 +142,14 @@ public:
 	static const count_type i_bits = IntegerBits;
 
 	///	Default constructor, initializes to 0
-	FixedPoint() : _content(0){}
+	FIXEDPOINT_CONSTEXPR FixedPoint() : _content(0){}
 
 	///	Raw fixed point constructor
 	/**
 	 *	Also used by the compile-time template converters
 	 *	@param fp A fixed point number with the same format
 	 */
-	FixedPoint(IntegerType fp) : _content(fp){
+	FIXEDPOINT_CONSTEXPR FixedPoint(IntegerType fp) : _content(fp){
 	}
 
 	/// Component value constructor
@@ -85,7 +158,7 @@ public:
 	 *	@param d_value The value of the decimal portion. Beware that only the number of bits reserved for the decimal portion can be used.
 	 *	@param s_value Whether the value is negative, positive by default. Regardless, i_ and d_value must be positive!
 	 */
-	FixedPoint(IntegerType i_value, IntegerType d_value, bool s_value = false) : _content((d_value | (i_value << FractionalBits))){
+	FIXEDPOINT_CONSTEXPR FixedPoint(IntegerType i_value, IntegerType d_value, bool s_value = false) : _content((d_value | (i_value << FractionalBits))){
 		if (s_value){
 			_content *= -1;
 		}
@@ -96,41 +169,61 @@ public:
 	 *	@param other FixedPoint to copy, if FIXEDPOINT_FORCEFORMAT is defined, other must be of the same format
 	 */
 	#ifdef FIXEDPOINT_FORCEFORMAT
-		FixedPoint(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other) : _content(other._content){}
+		FIXEDPOINT_CONSTEXPR FixedPoint(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) : _content(other._content){}
+	#elif defined(FIXEDPOINT_DEDUCEFORMAT)
+		// Deduced formats may have another base type, converting from them is where results are rescaled
+		template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR FixedPoint(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) : _content(other.template convert<IntegerType, IntegerBits, FractionalBits>()()){}
 	#else
-		template<count_type _OtherPoint>
-		FixedPoint(const FixedPoint<IntegerType, _OtherPoint>& other) : _content(other.convert<IntegerBits>()._content){}
+		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR FixedPoint(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) : _content(other.template convert<IntegerBits, FractionalBits>()()){}
 	#endif
 
+	/// Creates a FixedPoint from a floating point value
+	/**
+	 *	Rounds to the nearest representable value. Folds to a constant when value is one
+	 *	@param value Value to convert, must fit in the format
+	 *	@return Equivalent FixedPoint
+	 */
+	static FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> from_float(long double value){
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(value * _scale() + (value < 0 ? -0.5L : 0.5L)));
+	}
+
 	/// Fraction constructor
 	/**
-	 *	Creates a FixedPoint with the same value as the Fraction
-	 *	@param frac Equivalent fraction
+	 *	Creates a FixedPoint with the value of the Fraction, rounded toward zero as by operator/=.
+	 *	The numerator is shifted into a double-width intermediate and divided once by the denominator,
+	 *	values out of range are given by the overflow policy
+	 *	@param frac Fraction to convert, fp_fraction.h must be included to use it, converting a Fraction with a denominator of zero is undefined
 	 */
-	/*
-	FixedPoint(const Fraction<IntegerType>& frac) : _content((_unsign_int(frac.i()) << FractionalBits) | _unsign_int(frac.f().convert_denominator(1 << FractionalBits).numerator())){
-		if (_negative_integer(frac.numerator()) ^ _negative_integer(frac.denominator())){
-			_content = -_content;
-		}
-	}*/
+	FixedPoint(const Fraction<IntegerType>& frac) : _content(0){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			_record(_fp_div_event(frac.numerator(), frac.denominator(), FractionalBits), "FixedPoint::FixedPoint(Fraction)");
+		#endif
+		_content = OverflowPolicy::div(frac.numerator(), frac.denominator(), FractionalBits);
+	}
 
 	///	Returns the integer value
 	/**
+	 *	Unsigned, like d(). Rounded by the rounding policy, so unless it truncates, i() and d() may not add up to the value
 	 *	@return Integer value
 	 */
-	IntegerType i() const{
-		return _i();
+	FIXEDPOINT_CONSTEXPR IntegerType i() const{
+		// When the fractional bits fill IntegerType the whole value is shifted out, and only the policy decides between 0 and 1
+		return FractionalBits < _TotalBits ?
+			_fp_shift<IntegerType, -scount_type(FractionalBits % _TotalBits), _fp_rounding>::apply(_content >= 0 ? _content : -_content) :
+			IntegerType(_fp_rounding::round_up(_fp_wide_fraction(typename _fp_int_traits<IntegerType>::unsigned_type(0), typename _fp_int_traits<IntegerType>::unsigned_type(_content >= 0 ? _content : -_content), _TotalBits), false));
 	}
 	
 	/// Returns the decimal value
 	/**
 	 *	@return Decimal value
 	 */
-	IntegerType d() const{
+	FIXEDPOINT_CONSTEXPR IntegerType d() const{
 		return _d();
 	}
 
-	bool s() const{
+	FIXEDPOINT_CONSTEXPR bool s() const{
 		return _negative();
 	}
 
@@ -139,7 +232,7 @@ public:
 	 *	Does not change the sign.
 	 *	@param i_value Integer value, if the integer type is signed, must be positive
 	 */
-	void i(IntegerType i_value){
+	FIXEDPOINT_CONSTEXPR void i(IntegerType i_value){
 		_content = ((_negative() * -2) + 1) * (i_value << FractionalBits) | _d();
 	}
 
@@ -147,11 +240,11 @@ public:
 	/**
 	 *	@param d_value Decimal value
 	 */
-	void d(IntegerType d_value){
+	FIXEDPOINT_CONSTEXPR void d(IntegerType d_value){
 		_content = ((_negative() * -2) + 1) * (_i() << FractionalBits) | d_value;
 	}
 
-	void s(bool s_value){
+	FIXEDPOINT_CONSTEXPR void s(bool s_value){
 		_content = (s_value ^ _content < 0) ? _content : -_content;
 	}
 
@@ -161,7 +254,7 @@ public:
 	 *	@param d_value Decimal value
 	 *	@param s_value Sign value
 	 */
-	void ids(IntegerType i_value, IntegerType d_value, bool s_value = false){
+	FIXEDPOINT_CONSTEXPR void ids(IntegerType i_value, IntegerType d_value, bool s_value = false){
 		i(i_value);
 		d(d_value);
 		if (s_value){
@@ -173,7 +266,7 @@ public:
 	/**
 	 *	@return Integer bits
 	 */
-	count_type i_size() const{
+	FIXEDPOINT_CONSTEXPR count_type i_size() const{
 		return IntegerBits;
 	}
 
@@ -181,7 +274,7 @@ public:
 	/**
 	 *	@return Decimal bits
 	 */
-	count_type d_size() const{
+	FIXEDPOINT_CONSTEXPR count_type d_size() const{
 		return FractionalBits;
 	}
 
@@ -196,7 +289,7 @@ public:
 	/**
 	 *	@return Fixed point reference
 	 */
-	IntegerType& operator()(){
+	FIXEDPOINT_CONSTEXPR IntegerType& operator()(){
 		return _content;
 	}
 
@@ -213,317 +306,551 @@ public:
 	/**
 	 *	@return const fixed point reference
 	 */
-	const IntegerType& operator()() const{
+	FIXEDPOINT_CONSTEXPR const IntegerType& operator()() const{
 		return _content;
 	}
 
+	/// Returns the reciprocal of this number, for dividing many values by it
+	/**
+	 *	The reciprocal is computed once with Newton-Raphson iterations, after which
+	 *	x * d.reciprocal() divides x by d using only a multiplication and a shift.
+	 *	Results are rounded toward zero and may be a few units low in the last place.
+	 *	The reciprocal of zero is undefined
+	 *	@return Reciprocal multiplier
+	 */
+	FIXEDPOINT_CONSTEXPR FixedPointReciprocal<IntegerType, IntegerBits, FractionalBits> reciprocal() const{
+		return FixedPointReciprocal<IntegerType, IntegerBits, FractionalBits>(*this);
+	}
+
 	/// Converts a FixedPoint from one number of decimal bits to another (e.g. 20:12 to 8:24)
 	/**
-	 *	convert does not support conversion to another base type (e.g. unsigned int to unsigned short int)
-	 *	for safety reasons
+	 *	The conversion is a single shift of the raw value, chosen at compile time.
+	 *	Dropped bits are rounded by the rounding policy, toward negative infinity unless FIXEDPOINT_ROUNDING is defined
 	 *	@return Converted FixedPoint
 	 */
 	template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-	FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits> convert() const{
-		// TODO could use some optimization
-		// try to remove the branching
-		scount_type ddiff = scount_type(d_size()) - scount_type(OtherFractionalBits);
-		if (ddiff >= 0){
-			return FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>(_i(), _d() >> count_type(ddiff), _content < 0);
-		}else{
-			return FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>(_i(), _d() << count_type(-ddiff), _content < 0);
-		}
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy> convert() const{
+		#ifdef FIXEDPOINT_INSTRUMENT
+			_record(_fp_shift_event(_content, scount_type(OtherFractionalBits) - scount_type(FractionalBits)), "FixedPoint::convert");
+		#endif
+		return FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>(
+			_fp_shift<IntegerType, scount_type(OtherFractionalBits) - scount_type(FractionalBits), _fp_rounding>::apply(_content));
+	}
+
+	/// Converts a FixedPoint to another number of decimal bits, rounding to nearest whatever the rounding policy
+	/**
+	 *	@return Converted FixedPoint
+	 */
+	template<count_type OtherIntegerBits, count_type OtherFractionalBits>
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy> convert_round() const{
+		#ifdef FIXEDPOINT_INSTRUMENT
+			_record(_fp_shift_event(_content, scount_type(OtherFractionalBits) - scount_type(FractionalBits)), "FixedPoint::convert_round");
+		#endif
+		return FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>(
+			_fp_shift<IntegerType, scount_type(OtherFractionalBits) - scount_type(FractionalBits), fp_round_half_up>::apply(_content));
 	}
 
+	/// Converts a FixedPoint to another base type and number of decimal bits (e.g. short int 8:8 to int 16:16)
+	/**
+	 *	The shift is done in the wider of the two types, so widening never loses bits.
+	 *	Narrowing a value that does not fit is handled by the overflow policy.
+	 *	Dropped bits are handled as in convert()
+	 *	@return Converted FixedPoint
+	 */
+	template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+	FIXEDPOINT_CONSTEXPR FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy> convert() const{
+		typedef typename _fp_select<(sizeof(OtherIntegerType) > sizeof(IntegerType)), OtherIntegerType, IntegerType>::type shift_type;
+		#ifdef FIXEDPOINT_INSTRUMENT
+			const shift_type shifted = _fp_shift<shift_type, scount_type(OtherFractionalBits) - scount_type(FractionalBits)>::apply(shift_type(_content));
+			fp_event event = _fp_shift_event(shift_type(_content), scount_type(OtherFractionalBits) - scount_type(FractionalBits));
+			if (event == fp_event_count && shift_type(OtherIntegerType(shifted)) != shifted){
+				event = _fp_negative(shifted) ? fp_event_underflow : fp_event_overflow;
+			}
+			_record(event, "FixedPoint::convert");
+		#endif
+		return FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>(OverflowPolicy::template narrow<OtherIntegerType>(
+			_fp_shift<shift_type, scount_type(OtherFractionalBits) - scount_type(FractionalBits), _fp_rounding>::apply(shift_type(_content))));
+	}
 	
 
 	#ifdef FIXEDPOINT_FORCEFORMAT
-		FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator=(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other){
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator=(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
 			if (this != &other){
 				_content = other._content;
 			}
 			return *this;
 		}
 
-		FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator+=(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other){
-			#ifdef FIXEDPOINT_DEBUG
-				if (_content + other._content < _content){
-					// Error (Overflow)
-				}
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator+=(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+			#ifdef FIXEDPOINT_INSTRUMENT
+				_record(_fp_add_event(_content, other._content), "FixedPoint::operator+=");
 			#endif
-			_content += other._content;
+			_content = OverflowPolicy::add(_content, other._content);
 			return *this;
 		}
-		FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator-=(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other){
-			#ifdef FIXEDPOINT_DEBUG
-				if (_content < other._content){
-					// Error (Underflow)
-				}
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator-=(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+			#ifdef FIXEDPOINT_INSTRUMENT
+				_record(_fp_sub_event(_content, other._content), "FixedPoint::operator-=");
 			#endif
-			_content -= other._content;
+			_content = OverflowPolicy::sub(_content, other._content);
 			return *this;
 		}
-		FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator*=(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other){
-			#ifdef FIXEDPOINT_DEBUG
-				// Currently no check for multiplication overflow
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator*=(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+			#ifdef FIXEDPOINT_INSTRUMENT
+				_record(_fp_mul_event(_content, other._content, FractionalBits), "FixedPoint::operator*=");
 			#endif
 
-			_content *= other._content;
-			_content >> FractionalBits;
+			// Multiply in a double-width type so the high bits survive the shift
+			_content = OverflowPolicy::mul(_content, other._content, FractionalBits);
 
 			return *this;
 		}
-		FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator/=(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other){
-			#ifdef FIXEDPOINT_DEBUG		
-				if (other._content == 0){
-					// Oh SHI-
-				}
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator/=(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+			#ifdef FIXEDPOINT_INSTRUMENT
+				_record(_fp_div_event(_content, other._content, FractionalBits), "FixedPoint::operator/=");
 			#endif
 
-			// dunno lol
+			#ifdef FIXEDPOINT_RECIPROCAL_DIVISION
+				return operator*=(other.reciprocal());
+			#else
+				// Widen the dividend by the fractional bits so the quotient keeps them
+				_content = OverflowPolicy::div(_content, other._content, FractionalBits);
+				return *this;
+			#endif
+		}
+
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator*=(const FixedPointReciprocal<IntegerType, IntegerBits, FractionalBits>& other){
+			_content = other.apply(_content);
 			return *this;
 		}
 	#else
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other){
-			if (this != &other){
-				_content = other.convert<IntegerBits, FractionalBits>()();
-			}
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other){
+			_content = other.template convert<IntegerBits, FractionalBits>()();
 			return *this;
 		}
 
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator+=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other){
-			#ifdef FIXEDPOINT_DEBUG
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator+=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other){
+			const IntegerType converted = other.template convert<IntegerBits, FractionalBits>()();
+			#ifdef FIXEDPOINT_INSTRUMENT
+				_record(_fp_add_event(_content, converted), "FixedPoint::operator+=");
 			#endif
-			_content += other.convert<IntegerBits, FractionalBits>()();
+			_content = OverflowPolicy::add(_content, converted);
 			return *this;
 		}
 
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator-=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other){
-			#ifdef FIXEDPOINT_DEBUG
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator-=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other){
+			const IntegerType converted = other.template convert<IntegerBits, FractionalBits>()();
+			#ifdef FIXEDPOINT_INSTRUMENT
+				_record(_fp_sub_event(_content, converted), "FixedPoint::operator-=");
 			#endif
-			_content -= other.convert<IntegerBits, FractionalBits>()();
+			_content = OverflowPolicy::sub(_content, converted);
 			return *this;
 		}
 
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator*=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other){
-			#ifdef FIXEDPOINT_DEBUG
-				// Currently no check for multiplication overflow
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator*=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other){
+			#ifdef FIXEDPOINT_INSTRUMENT
+				_record(_fp_mul_event(_content, other(), OtherFractionalBits), "FixedPoint::operator*=");
 			#endif
 
-			_content *= other.convert<IntegerBits, FractionalBits>()();
-			_content >>= OtherFractionalBits;
+			// No need to convert first, shifting the double-width product by the other's
+			// fractional bits leaves the result in this format
+			_content = OverflowPolicy::mul(_content, other(), OtherFractionalBits);
 
 			return *this;
 		}
 
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator/=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other){
-			#ifdef FIXEDPOINT_DEBUG		
-				if (other._content == 0){
-					// Oh SHI-
-				}
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator/=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other){
+			#ifdef FIXEDPOINT_INSTRUMENT
+				_record(_fp_div_event(_content, other(), OtherFractionalBits), "FixedPoint::operator/=");
 			#endif
 
-			// TODO dunno lol
+			#ifdef FIXEDPOINT_RECIPROCAL_DIVISION
+				return operator*=(other.reciprocal());
+			#else
+				// Widening by the other's fractional bits leaves the quotient in this format
+				_content = OverflowPolicy::div(_content, other(), OtherFractionalBits);
+				return *this;
+			#endif
+		}
+
+		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator*=(const FixedPointReciprocal<IntegerType, OtherIntegerBits, OtherFractionalBits>& other){
+			_content = other.apply(_content);
 			return *this;
 		}
+
+		#ifdef FIXEDPOINT_DEDUCEFORMAT
+			// Accumulates deduced results that were widened to another base type, e.g. sum += a * b
+			template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+			FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator+=(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other){
+				return operator+=(other.template convert<IntegerType, IntegerBits, FractionalBits>());
+			}
+
+			template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+			FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator-=(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other){
+				return operator-=(other.template convert<IntegerType, IntegerBits, FractionalBits>());
+			}
+		#endif
 	#endif
 
 	#ifdef FIXEDPOINT_FORCEFORMAT
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> operator+(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other){
-			return (FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) += other);
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator+(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) += other);
 		}
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> operator-(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other){
-			return (FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) -= other);
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator-(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) -= other);
 		}
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> operator*(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other){
-			return (FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) *= other);
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator*(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) *= other);
 		}
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> operator/(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other){
-			return (FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) /= other);
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator/(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) /= other);
+		}
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator*(const FixedPointReciprocal<IntegerType, IntegerBits, FractionalBits>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) *= other);
 		}
 
-		bool operator==(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other) const{
+		FIXEDPOINT_CONSTEXPR bool operator==(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
 			return _content == other._content;
 		}
 
-		bool operator!=(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other) const{
+		FIXEDPOINT_CONSTEXPR bool operator!=(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
 			return !(operator==(other));
 		}
 
-		bool operator<(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other) const{
+		FIXEDPOINT_CONSTEXPR bool operator<(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
 			return _content < other._content;
 		}
 
-		bool operator<=(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other) const{
+		FIXEDPOINT_CONSTEXPR bool operator<=(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
 			return _content <= other._content;
 		}
 
-		bool operator>(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other) const{
+		FIXEDPOINT_CONSTEXPR bool operator>(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
+			return !(operator<=(other));
+		}
+
+		FIXEDPOINT_CONSTEXPR bool operator>=(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) const{
+			return !(operator<(other));
+		}
+	#elif defined(FIXEDPOINT_DEDUCEFORMAT)
+		// Results take the deduced format, see _fp_sum_format and _fp_product_format.
+		// Operands with different base types are combined in the wider one
+		template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR typename _fp_sum_format<typename _fp_common_type<IntegerType, OtherIntegerType>::type, IntegerBits, FractionalBits, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>::type operator+(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			typedef typename _fp_sum_format<typename _fp_common_type<IntegerType, OtherIntegerType>::type, IntegerBits, FractionalBits, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>::type result_type;
+			return (result_type(*this) += result_type(other));
+		}
+		template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR typename _fp_sum_format<typename _fp_common_type<IntegerType, OtherIntegerType>::type, IntegerBits, FractionalBits, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>::type operator-(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			typedef typename _fp_sum_format<typename _fp_common_type<IntegerType, OtherIntegerType>::type, IntegerBits, FractionalBits, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>::type result_type;
+			return (result_type(*this) -= result_type(other));
+		}
+		template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR typename _fp_product_format<typename _fp_common_type<IntegerType, OtherIntegerType>::type, IntegerBits, FractionalBits, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>::type operator*(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			return _fp_deduced_product<_fp_product_format<typename _fp_common_type<IntegerType, OtherIntegerType>::type, IntegerBits, FractionalBits, OtherIntegerBits, OtherFractionalBits, OverflowPolicy> >::apply(*this, other);
+		}
+		// A quotient has no exact format, it keeps this one
+		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator/(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) /= other);
+		}
+		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator*(const FixedPointReciprocal<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) *= other);
+		}
+
+		// Both sides are compared in the format of their sum, so neither loses bits
+		template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR bool operator==(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			typedef typename _fp_sum_format<typename _fp_common_type<IntegerType, OtherIntegerType>::type, IntegerBits, FractionalBits, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>::type result_type;
+			return (result_type(*this)() == result_type(other)());
+		}
+
+		template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR bool operator!=(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			return !(operator==(other));
+		}
+
+		template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR bool operator<(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			typedef typename _fp_sum_format<typename _fp_common_type<IntegerType, OtherIntegerType>::type, IntegerBits, FractionalBits, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>::type result_type;
+			return (result_type(*this)() < result_type(other)());
+		}
+
+		template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR bool operator<=(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			typedef typename _fp_sum_format<typename _fp_common_type<IntegerType, OtherIntegerType>::type, IntegerBits, FractionalBits, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>::type result_type;
+			return (result_type(*this)() <= result_type(other)());
+		}
+
+		template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR bool operator>(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
 			return !(operator<=(other));
 		}
 
-		bool operator>=(const FixedPoint<IntegerType, IntegerBits, FractionalBits>& other) const{
+		template<typename OtherIntegerType, count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR bool operator>=(const FixedPoint<OtherIntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
 			return !(operator<(other));
 		}
 	#else
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> operator+(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
-			return (FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) += other.convert<IntegerBits, FractionalBits>());
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator+(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) += other.template convert<IntegerBits, FractionalBits>());
+		}
+		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator-(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) -= other.template convert<IntegerBits, FractionalBits>());
 		}
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> operator-(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
-			return (FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) -= other.convert<IntegerBits, FractionalBits>());
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator*(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) *= other.template convert<IntegerBits, FractionalBits>());
 		}
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> operator*(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
-			return (FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) *= other.convert<IntegerBits, FractionalBits>());
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator/(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) /= other);
 		}
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> operator/(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
-			return (FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) /= other.convert<IntegerBits, FractionalBits>());
+		FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator*(const FixedPointReciprocal<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
+			return (FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) *= other);
 		}
 
 
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		bool operator==(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
-			return (_content == other.convert<IntegerBits, FractionalBits>()());
+		FIXEDPOINT_CONSTEXPR bool operator==(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			return (_content == other.template convert<IntegerBits, FractionalBits>()());
 		}
 
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		bool operator!=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
+		FIXEDPOINT_CONSTEXPR bool operator!=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
 			return !(operator==(other));
 		}
 
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		bool operator<(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
-			return (_content < other.convert<IntegerBits, FractionalBits>()());
+		FIXEDPOINT_CONSTEXPR bool operator<(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			return (_content < other.template convert<IntegerBits, FractionalBits>()());
 		}
 
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		bool operator<=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
-			return (_content <= other.convert<IntegerBits, FractionalBits>()());
+		FIXEDPOINT_CONSTEXPR bool operator<=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
+			return (_content <= other.template convert<IntegerBits, FractionalBits>()());
 		}
 
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		bool operator>(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
+		FIXEDPOINT_CONSTEXPR bool operator>(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
 			return !(operator<=(other));
 		}
 
 		template<count_type OtherIntegerBits, count_type OtherFractionalBits>
-		bool operator>=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits>& other) const{
+		FIXEDPOINT_CONSTEXPR bool operator>=(const FixedPoint<IntegerType, OtherIntegerBits, OtherFractionalBits, OverflowPolicy>& other) const{
 			return !(operator<(other));
 		}
 	#endif
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator+=(const IntegerType& other){
-		i(i() + other);
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator+=(const IntegerType& other){
+		i(_i() + other);
 		return *this;
 	}
-	FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator-=(const IntegerType& other){
-		i(i() - other);
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator-=(const IntegerType& other){
+		i(_i() - other);
 		return *this;
 	}
-	FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator*=(const IntegerType& other){
-		_content *= other;
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator*=(const IntegerType& other){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			_record(_fp_mul_event(_content, other, 0), "FixedPoint::operator*=");
+		#endif
+		_content = OverflowPolicy::mul(_content, other, 0);
 		return *this;
 	}
-	FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator/=(const IntegerType& other){
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator/=(const IntegerType& other){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			_record(_fp_div_event(_content, other, 0), "FixedPoint::operator/=");
+		#endif
 		_content /= other;
 		return *this;
 	}
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits> operator+(const IntegerType& other) const{
-		return FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) += other;
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator+(const IntegerType& other) const{
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) += other;
 	}
-	FixedPoint<IntegerType, IntegerBits, FractionalBits> operator-(const IntegerType& other) const{
-		return FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) -= other;
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator-(const IntegerType& other) const{
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) -= other;
 	}
-	FixedPoint<IntegerType, IntegerBits, FractionalBits> operator*(const IntegerType& other) const{
-		return FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) *= other;
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator*(const IntegerType& other) const{
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) *= other;
 	}
-	FixedPoint<IntegerType, IntegerBits, FractionalBits> operator/(const IntegerType& other) const{
-		return FixedPoint<IntegerType, IntegerBits, FractionalBits>(*this) /= other;
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator/(const IntegerType& other) const{
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(*this) /= other;
 	}
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits> operator-(int dummy) const{
-		return FixedPoint<IntegerType, IntegerBits, FractionalBits>(-_content);
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator-(int dummy) const{
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(-_content);
 	}
 
-	bool operator==(const IntegerType& other) const{
-		return (i() == other && d() == 0);
+	FIXEDPOINT_CONSTEXPR bool operator==(const IntegerType& other) const{
+		return (_i() == other && _d() == 0);
 	}
 
-	bool operator!=(const IntegerType& other) const{
+	FIXEDPOINT_CONSTEXPR bool operator!=(const IntegerType& other) const{
 		return !(operator==(other));
 	}
 
-	bool operator<(const IntegerType& other) const{
-		return i() < other;
+	FIXEDPOINT_CONSTEXPR bool operator<(const IntegerType& other) const{
+		return _i() < other;
 	}
 
-	bool operator<=(const IntegerType& other) const{
+	FIXEDPOINT_CONSTEXPR bool operator<=(const IntegerType& other) const{
 		return operator<(other) || operator==(other);
 	}
 
-	bool operator>(const IntegerType& other) const{
+	FIXEDPOINT_CONSTEXPR bool operator>(const IntegerType& other) const{
 		return !operator<=(other);
 	}
 
-	bool operator>=(const IntegerType& other) const{
+	FIXEDPOINT_CONSTEXPR bool operator>=(const IntegerType& other) const{
 		return !operator<(other);
 	}
 
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator++(){
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator++(){
 		return _content += (1 << FractionalBits);
 	}
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator--(){
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator--(){
 		return _content -= (1 << FractionalBits);
 	}
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits> operator++(int){
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> _copy(*this);
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator++(int){
+		FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> _copy(*this);
 		*this++();
 		return _copy;
 	}
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits> operator--(int){
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> _copy(*this);
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator--(int){
+		FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> _copy(*this);
 		*this--();
 		return _copy;
 	}
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator<<=(const int& shift){
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator<<=(const int& shift){
 		return _content <<= shift;
 	}
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits>& operator>>=(const int& shift){
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator>>=(const int& shift){
 		return _content >>= shift;
 	}
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits> operator<<(const int& shift){
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> _copy(*this);
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator<<(const int& shift){
+		FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> _copy(*this);
 		return _copy <<= shift;
 	}
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits> operator>>(int shift){
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> _copy(*this);
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator>>(int shift){
+		FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> _copy(*this);
 		return _copy >>= shift;
 	}
 
-	FixedPoint<IntegerType, IntegerBits, FractionalBits> operator-() const{
-		FixedPoint<IntegerType, IntegerBits, FractionalBits> _copy(*this);
+	FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> operator-() const{
+		FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> _copy(*this);
 		_copy._content = -_copy._content;
 		return _copy;
 	}
 };
 
+///	The reciprocal of a FixedPoint, used to replace repeated divisions by the same divisor with multiplications
+/**
+ *	Holds 1 / |divisor| as an unsigned mantissa with the top bits set, along with the shift needed to bring
+ *	the product with a dividend back into the dividend's format. The mantissa is refined from a linear
+ *	estimate with Newton-Raphson iterations, so no division instruction is needed to construct it either.
+ *	Obtained through FixedPoint::reciprocal() and applied with FixedPoint::operator*
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+class FixedPointReciprocal{
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+
+	static const count_type _bits = std::numeric_limits<unsigned_type>::digits;
+
+	// Each iteration doubles the number of correct bits, starting from just over 4
+	static const count_type _iterations = (_bits <= 8 ? 2 : (_bits <= 16 ? 3 : (_bits <= 32 ? 4 : 5)));
+
+	unsigned_type _mantissa;
+	count_type _shift;
+	bool _negative;
+
+	static FIXEDPOINT_CONSTEXPR unsigned_type _mul_shift(unsigned_type a, unsigned_type b, count_type shift){
+		return _fp_wide_arith<unsigned_type>::mul_shift(a, b, shift);
+	}
+
+	// Whether normal * estimate, a 2.(2N-2) fixed point number, is greater than 1
+	static FIXEDPOINT_CONSTEXPR bool _exceeds_one(unsigned_type normal, unsigned_type estimate){
+		const unsigned_type one = unsigned_type(1) << (_bits - 2);
+		unsigned_type high = 0, low = 0;
+		_fp_wide_arith<unsigned_type>::mul_full(normal, estimate, high, low);
+		return high > one || (high == one && low != 0);
+	}
+
+public:
+	/// Computes the reciprocal of a divisor
+	/**
+	 *	@param divisor Non-zero FixedPoint to take the reciprocal of
+	 */
+	template<typename OverflowPolicy>
+	explicit FIXEDPOINT_CONSTEXPR FixedPointReciprocal(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& divisor) : _mantissa(0), _shift(0), _negative(_fp_negative(divisor())){
+		const unsigned_type magnitude = _fp_magnitude(divisor());
+		const count_type length = _fp_bit_length(magnitude);
+
+		if (length == 0){
+			#ifdef FIXEDPOINT_INSTRUMENT
+				_fp_event<FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(fp_event_division_by_zero, "FixedPoint::reciprocal");
+			#endif
+			return;
+		}
+
+		// Divisor normalized to [0.5, 1) as a 0.N fixed point number
+		const unsigned_type normal = magnitude << (_bits - length);
+
+		// Linear estimate 48/17 - 32/17 * normal, as a 2.(N-2) fixed point number like the result
+		const unsigned_type c48_17 = unsigned_type(0xB4B4B4B4B4B4B4B5ULL >> (64 - _bits));
+		const unsigned_type c32_17 = unsigned_type(0x7878787878787878ULL >> (64 - _bits));
+		unsigned_type estimate = c48_17 - _mul_shift(c32_17, normal, _bits);
+
+		// x = x * (2 - normal * x)
+		for (count_type i = 0; i < _iterations; i++){
+			const unsigned_type error = (unsigned_type(1) << (_bits - 1)) - _mul_shift(normal, estimate, _bits);
+			estimate = _mul_shift(estimate, error, _bits - 2);
+		}
+
+		// Truncation in the iterations leaves the estimate a few units off, settle it on floor(1 / normal)
+		// so that quotients are never too large
+		while (_exceeds_one(normal, estimate)){
+			--estimate;
+		}
+		while (!_exceeds_one(normal, estimate + 1)){
+			++estimate;
+		}
+
+		// dividend / divisor == dividend * estimate / 2^(N - 2 + length - FractionalBits)
+		const scount_type shift = scount_type(_bits - 2 + length) - scount_type(FractionalBits);
+		_mantissa = estimate;
+		_shift = count_type(shift > 0 ? shift : 0);
+	}
+
+	/// Divides the raw content of a FixedPoint by the divisor this reciprocal was made from
+	/**
+	 *	The result has the same format as the dividend
+	 *	@param dividend Raw fixed point number
+	 *	@return Raw quotient
+	 */
+	FIXEDPOINT_CONSTEXPR IntegerType apply(IntegerType dividend) const{
+		const unsigned_type quotient = _mul_shift(_fp_magnitude(dividend), _mantissa, _shift);
+		return IntegerType(_negative != _fp_negative(dividend) ? unsigned_type(0) - quotient : quotient);
+	}
+};
 
 
 
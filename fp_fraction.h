@@ -16,37 +16,230 @@
  *	numerator() and denominator() are only guaranteed to return the same value until a non-const function is called
  *	Many functions may automatically reduce the fraction to lowest form to prevent overflows from occurring.
  *	If the fraction is reduced, it will still be considered equal to the unreduced fraction
+ *	Operations cancel common factors of the operands before multiplying, so Fractions in lowest terms give results in lowest terms,
+ *	and compute intermediate products in a type twice as wide where there is one: they only overflow if the result in lowest terms does not fit.
+ *	With FIXEDPOINT_FRACTION_LAZY, operations only reduce their operands once these use more than half the bits of IntegerType
  *	Range:		min(IntegerType) to max(BaseType) [signed or unsigned]
  *	Precision:	1 / max(IntegerType) [unsigned]
  *			 :	2 / max(IntegerType) [signed]
  *	sizeof(Fraction<IntegerType>) == sizeof(IntegerType) * 2
  */
 
+// Add the following line to your code before any #include "fp_*.h"
+// to reduce Fractions only when an operation could otherwise overflow, instead of after every operation.
+// Results are then left unreduced, call simplify() where lowest terms are needed
+//#define FIXEDPOINT_FRACTION_LAZY
+
+// Greatest common divisor by Stein's binary algorithm, which only shifts and subtracts. gcd(0, b) is b
+template<typename UnsignedType>
+UnsignedType _fp_gcd(UnsignedType a, UnsignedType b){
+	if (!a || !b){
+		return UnsignedType(a | b);
+	}
+	const count_type shift = _fp_trailing_zeros(UnsignedType(a | b));
+	a >>= _fp_trailing_zeros(a);
+	do{
+		b >>= _fp_trailing_zeros(b);
+		if (a > b){
+			const UnsignedType swap = a;
+			a = b;
+			b = swap;
+		}
+		b -= a;
+	}while (b);
+	return UnsignedType(a << shift);
+}
+
 template<typename IntegerType>
 class Fraction{
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+	// Intermediate products, IntegerType itself where there is no wider type
+	typedef typename _fp_int_traits<IntegerType>::wide_type wide_type;
+
 	IntegerType _numerator;
 	IntegerType _denominator;
 
-	IntegerType _numerator_abs() const{
-		return _numerator >= 0 ? _numerator : -_numerator;
+	// Divides by a divisor of value, which may not fit in IntegerType (e.g. the magnitude of the most negative value)
+	static IntegerType _divide(IntegerType value, unsigned_type divisor){
+		const unsigned_type quotient = unsigned_type(_fp_magnitude(value) / divisor);
+		return IntegerType(_fp_negative(value) ? unsigned_type(unsigned_type(0) - quotient) : quotient);
 	}
 
-	IntegerType _denominator_abs() const{
-		return _denominator >= 0 ? _denominator : -_denominator;
+	// Divides both values by their greatest common divisor
+	static void _cancel(IntegerType& first, IntegerType& second){
+		const unsigned_type divisor = _fp_gcd(_fp_magnitude(first), _fp_magnitude(second));
+		if (divisor > 1){
+			first = _divide(first, divisor);
+			second = _divide(second, divisor);
+		}
 	}
 
 	// Method to fully reduce to relative primes
 	void _full_simplify(){
-		// Based on the Euclidean algorithm
-		IntegerType greater = (_numerator_abs() > _denominator_abs() ? _numerator : _denominator);
-		IntegerType lesser = (_numerator_abs() < _denominator_abs() ? _numerator : _denominator);
-		do{
-			IntegerType remainder(greater % lesser);
-			greater = lesser;
-			lesser = remainder;
-		}while(lesser);
-		_numerator /= greater;
-		_denominator /= greater;
+		_cancel(_numerator, _denominator);
+	}
+
+	// Narrows an intermediate result, which only overflows if the result in lowest terms does not fit either
+	static IntegerType _narrow(wide_type value, const char* operation){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (value != wide_type(IntegerType(value))){
+				_fp_event<Fraction<IntegerType> >(fp_event_overflow, operation);
+			}
+		#else
+			(void)operation;
+		#endif
+		return IntegerType(value);
+	}
+
+	// Whether a magnitude uses more than half the bits of IntegerType,
+	// past which the sum of two products of numerators and denominators may overflow
+	static bool _large(unsigned_type magnitude){
+		return (magnitude >> ((std::numeric_limits<IntegerType>::digits - 1) / 2)) != 0;
+	}
+
+	bool _crowded() const{
+		return _large(unsigned_type(_fp_magnitude(_numerator) | _fp_magnitude(_denominator)));
+	}
+
+	// Whether an operation with numer / denom could overflow if computed directly, only then are common factors cancelled before multiplying.
+	// Lazy operands are reduced first, which may be enough
+	bool _crowded(IntegerType& numer, IntegerType& denom){
+		if (!_crowded() && !_large(unsigned_type(_fp_magnitude(numer) | _fp_magnitude(denom)))){
+			return false;
+		}
+		#ifdef FIXEDPOINT_FRACTION_LAZY
+			_full_simplify();
+			_cancel(numer, denom);
+			return _crowded() || _large(unsigned_type(_fp_magnitude(numer) | _fp_magnitude(denom)));
+		#else
+			return true;
+		#endif
+	}
+
+	// Same for an operation with an integer
+	bool _crowded(IntegerType& other){
+		IntegerType one(1);
+		return _crowded(other, one);
+	}
+
+	// Reduces the result of an operation computed directly, unless lazy
+	void _simplify(){
+		#ifndef FIXEDPOINT_FRACTION_LAZY
+			_full_simplify();
+		#endif
+	}
+
+	// Adds or subtracts numer / denom, as in Knuth's Seminumerical Algorithms 4.5.1:
+	// only the denominators' common factor can be shared by the sum and its denominator
+	void _add(IntegerType numer, IntegerType denom, bool subtract, const char* operation){
+		if (!_crowded(numer, denom)){
+			if (_denominator == denom){
+				_numerator = subtract ? IntegerType(_numerator - numer) : IntegerType(_numerator + numer);
+			}else{
+				_numerator = subtract ? IntegerType(_numerator * denom - numer * _denominator) : IntegerType(_numerator * denom + numer * _denominator);
+				_denominator *= denom;
+			}
+			_simplify();
+			return;
+		}
+		const unsigned_type common = _fp_gcd(_fp_magnitude(_denominator), _fp_magnitude(denom));
+		IntegerType left = _denominator;
+		IntegerType right = denom;
+		if (common > 1){
+			left = _divide(left, common);
+			right = _divide(right, common);
+		}
+		wide_type sum = subtract ? wide_type(wide_type(_numerator) * right - wide_type(numer) * left) : wide_type(wide_type(_numerator) * right + wide_type(numer) * left);
+		if (common > 1){
+			const unsigned_type divisor = _fp_gcd(unsigned_type(_fp_magnitude(sum) % common), common);
+			if (divisor > 1){
+				sum /= wide_type(divisor);
+				denom = _divide(denom, divisor);
+			}
+		}
+		_numerator = _narrow(sum, operation);
+		_denominator = _narrow(wide_type(left) * denom, operation);
+	}
+
+	// Compares with numer / denom by cross products, which may not have the same sign as the difference if exactly one denominator is negative
+	// Returns a negative value if less, zero if equal, a positive value if greater
+	int _compare(IntegerType numer, IntegerType denom) const{
+		wide_type left = wide_type(_numerator) * denom;
+		wide_type right = wide_type(numer) * _denominator;
+		if (_fp_negative(_denominator) != _fp_negative(denom)){
+			const wide_type swap = left;
+			left = right;
+			right = swap;
+		}
+		return left < right ? -1 : (left > right ? 1 : 0);
+	}
+
+	// Whether a * b < c * d, from their double-width products
+	static bool _product_less(unsigned_type a, unsigned_type b, unsigned_type c, unsigned_type d){
+		unsigned_type left_high = 0, left_low = 0, right_high = 0, right_low = 0;
+		_fp_wide_arith<unsigned_type>::mul_full(a, b, left_high, left_low);
+		_fp_wide_arith<unsigned_type>::mul_full(c, d, right_high, right_low);
+		return left_high < right_high || (left_high == right_high && left_low < right_low);
+	}
+
+	// Sets the Fraction to the closest one to content / 2^shift whose denominator is at most max_denom, and whose numerator fits.
+	// Runs Euclid's algorithm on the magnitude and 2^shift, which may not fit in unsigned_type, keeping the last two convergents h / k.
+	// The remainders are the errors of the convergents: |magnitude * k - 2^shift * h| is the remainder after the term of h / k.
+	// Once a term would take a convergent past the limits, the closest is either the last convergent or the largest semiconvergent that fits
+	void _approximate(IntegerType content, count_type shift, IntegerType max_denom){
+		const count_type bits = std::numeric_limits<unsigned_type>::digits;
+		const unsigned_type max_denominator = _fp_magnitude(max_denom);
+		// The most negative value has a magnitude one larger than the most positive
+		const unsigned_type max_numerator = unsigned_type(unsigned_type(std::numeric_limits<IntegerType>::max()) + unsigned_type(_fp_negative(content)));
+		const unsigned_type magnitude = _fp_magnitude(content);
+		// ~0 alone would be promoted to a negative int for types narrower than int
+		const unsigned_type largest = std::numeric_limits<unsigned_type>::max();
+
+		unsigned_type h0 = 0, h1 = 1, k0 = 1, k1 = 0;
+		// The integer part is the first term, 2^shift / remainder the second
+		unsigned_type term = shift < bits ? unsigned_type(magnitude >> shift) : unsigned_type(0);
+		unsigned_type remainder = shift < bits ? unsigned_type(magnitude & ((unsigned_type(1) << shift) - 1)) : magnitude;
+		unsigned_type previous = shift < bits ? unsigned_type(unsigned_type(1) << shift) : unsigned_type(0);
+		for (;;){
+			const unsigned_type numerator_limit = h1 ? unsigned_type((max_numerator - h0) / h1) : largest;
+			const unsigned_type denominator_limit = k1 ? unsigned_type((max_denominator - k0) / k1) : largest;
+			const unsigned_type limit = numerator_limit < denominator_limit ? numerator_limit : denominator_limit;
+			if (term > limit){
+				// The semiconvergent's error is remainder + (term - limit) * previous, the last convergent's is previous
+				if (!k1 || (limit && _product_less(unsigned_type(remainder + (term - limit) * previous), k1, previous, unsigned_type(limit * k1 + k0)))){
+					h1 = unsigned_type(limit * h1 + h0);
+					k1 = unsigned_type(limit * k1 + k0);
+				}
+				break;
+			}
+			const unsigned_type h = unsigned_type(term * h1 + h0);
+			const unsigned_type k = unsigned_type(term * k1 + k0);
+			h0 = h1;
+			h1 = h;
+			k0 = k1;
+			k1 = k;
+			if (!remainder){
+				break;
+			}
+			if (previous){
+				term = unsigned_type(previous / remainder);
+				previous = unsigned_type(previous % remainder);
+			}else{
+				// previous is 2^bits, one more than the largest value. A term of 2^bits / 1 does not fit either,
+				// so it stays largest with a remainder of 1, and the next term of 1 gives the same convergent
+				term = unsigned_type(largest / remainder);
+				previous = unsigned_type(largest % remainder + 1);
+				if (previous == remainder && remainder != 1){
+					term++;
+					previous = 0;
+				}
+			}
+			const unsigned_type swap = previous;
+			previous = remainder;
+			remainder = swap;
+		}
+		_numerator = IntegerType(_fp_negative(content) ? unsigned_type(unsigned_type(0) - h1) : h1);
+		_denominator = IntegerType(k1);
 	}
 
 public:
@@ -66,11 +259,41 @@ public:
 	Fraction(const Fraction<IntegerType>& other) : _numerator(other._numerator), _denominator(other._denominator){}
 
 	///	Create a fraction from a fixed-point number
-	/**	
-	 *	@param other Fixed-point number to copys
+	/**
+	 *	Exact: the content over 2^FractionalBits, in lowest terms once the trailing zeros they share are shifted out.
+	 *	If that denominator still does not fit in IntegerType, the closest Fraction that fits is used instead.
+	 *	Explicit, so that other FixedPoint formats do not convert to each other through a Fraction
+	 *	@param other Fixed-point number to convert
+	 */
+	template<count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+	explicit Fraction(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other) : _numerator(0), _denominator(1){
+		const IntegerType content = other();
+		const unsigned_type magnitude = _fp_magnitude(content);
+		if (!magnitude){
+			return;
+		}
+		const count_type zeros = _fp_trailing_zeros(magnitude);
+		const count_type shift = zeros < FractionalBits ? FractionalBits - zeros : 0;
+		if (shift >= std::numeric_limits<IntegerType>::digits){
+			_approximate(content, FractionalBits, std::numeric_limits<IntegerType>::max());
+			return;
+		}
+		_numerator = _divide(content, unsigned_type(1) << (FractionalBits - shift));
+		_denominator = IntegerType(IntegerType(1) << shift);
+	}
+
+	///	Create the closest fraction to a fixed-point number with a bounded denominator
+	/**
+	 *	Found from the convergents of the continued fraction of the value, i.e. by descending the Stern-Brocot tree a run at a time,
+	 *	so it takes one division per term rather than one per denominator. The result is in lowest terms
+	 *	and its numerator also fits in IntegerType; of two equally close Fractions, the one with the smaller denominator is used
+	 *	@param other Fixed-point number to approximate
+	 *	@param max_denominator Largest denominator allowed, at least 1
 	 */
-	template<count_type IntegerBits, count_type DecimalBits>
-	Fraction(const FixedPoint<IntegerType, IntegerBits, DecimalBits>& other) : _numerator(other.i() * (1 << DecimalBits) / other.d()), _denominator(1 << DecimalBits){}
+	template<count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+	Fraction(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other, IntegerType max_denominator) : _numerator(0), _denominator(1){
+		_approximate(other(), FractionalBits, max_denominator);
+	}
 
 	/// Return the numerator of the Fraction.
 	/**
@@ -138,7 +361,7 @@ public:
 	 *	@return Equivalent fraction
 	 */
 	Fraction convert_numerator(IntegerType numer) const{
-		return Fraction(numer, (_denominator * numer) / _numerator);
+		return Fraction(numer, _narrow(wide_type(_denominator) * numer / _numerator, "Fraction::convert_numerator"));
 	}
 
 	/// Returns a Fraction with the given denominator equivalent to the original Fraction
@@ -150,12 +373,13 @@ public:
 	 *	@return Equivalent fraction
 	 */
 	Fraction convert_denominator(IntegerType denom) const{
-		return Fraction((_numerator * denom) / _denominator, denom);
+		return Fraction(_narrow(wide_type(_numerator) * denom / _denominator, "Fraction::convert_denominator"), denom);
 	}
 
 	/// Simplifies the numerator and denominator of the Fraction
 	/**	
-	 *	Fractions are only guaranteed to remain simplified until the next non-const function
+	 *	Fractions are only guaranteed to remain simplified until the next non-const function.
+	 *	The only way to get lowest terms with FIXEDPOINT_FRACTION_LAZY
 	 */
 	void simplify(){
 		_full_simplify();
@@ -163,41 +387,49 @@ public:
 
 
 	Fraction<IntegerType>& operator+=(const Fraction<IntegerType>& other){
-		_numerator *= other._denominator;
-		_numerator += other._numerator * _denominator;
-		_denominator *= other._denominator;
-
-		_full_simplify();
+		_add(other._numerator, other._denominator, false, "Fraction::operator+=");
 		return *this;
 	}
 
 	Fraction<IntegerType>& operator-=(const Fraction<IntegerType>& other){
-		#ifdef FIXEDPOINT_DEBUG
-			if (){
-				// Error (Underflow)
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (!std::numeric_limits<IntegerType>::is_signed && operator<(other)){
+				_fp_event<Fraction<IntegerType> >(fp_event_underflow, "Fraction::operator-=");
 			}
 		#endif
-		_numerator *= other._denominator;
-		_numerator -= other._numerator;
-		_denominator *= other._denomiator;
-
-		_full_simplify();
+		_add(other._numerator, other._denominator, true, "Fraction::operator-=");
 		return *this;
 	}
 
 	Fraction<IntegerType>& operator*=(const Fraction<IntegerType>& other){
-		_numerator *= other._numerator;
-		_denominator *= other._denominator;
-
-		_full_simplify();
+		IntegerType numer = other._numerator;
+		IntegerType denom = other._denominator;
+		if (!_crowded(numer, denom)){
+			_numerator *= numer;
+			_denominator *= denom;
+			_simplify();
+			return *this;
+		}
+		_cancel(_numerator, denom);
+		_cancel(numer, _denominator);
+		_numerator = _narrow(wide_type(_numerator) * numer, "Fraction::operator*=");
+		_denominator = _narrow(wide_type(_denominator) * denom, "Fraction::operator*=");
 		return *this;
 	}
 
 	Fraction<IntegerType>& operator/=(const Fraction<IntegerType>& other){
-		_numerator *= other._denominator;
-		_denominator *= other._numerator;
-
-		_full_simplify();
+		IntegerType numer = other._numerator;
+		IntegerType denom = other._denominator;
+		if (!_crowded(numer, denom)){
+			_numerator *= denom;
+			_denominator *= numer;
+			_simplify();
+			return *this;
+		}
+		_cancel(_numerator, numer);
+		_cancel(denom, _denominator);
+		_numerator = _narrow(wide_type(_numerator) * denom, "Fraction::operator/=");
+		_denominator = _narrow(wide_type(_denominator) * numer, "Fraction::operator/=");
 		return *this;
 	}
 
@@ -217,7 +449,7 @@ public:
 		return (Fraction<IntegerType>(*this) /= other);
 	}
 
-	Fraction<IntegerType>& operator=(const Fraction<IntegerType>& other) const{
+	Fraction<IntegerType>& operator=(const Fraction<IntegerType>& other){
 		_numerator = other._numerator;
 		_denominator = other._denominator;
 
@@ -225,7 +457,7 @@ public:
 	}
 
 	bool operator==(const Fraction<IntegerType>& other) const{
-		return (_numerator * other._denominator == _denominator * other._numerator);
+		return _compare(other._numerator, other._denominator) == 0;
 	}
 
 	bool operator!=(const Fraction<IntegerType>& other) const{
@@ -233,12 +465,11 @@ public:
 	}
 
 	bool operator<(const Fraction<IntegerType>& other) const{
-		return _numerator * other._denominator < other._numerator * _denominator;
+		return _compare(other._numerator, other._denominator) < 0;
 	}
 
 	bool operator<=(const Fraction<IntegerType>& other) const{
-		// Copied in to save a small amount of performance by having only one comparison
-		return _numerator * other._denominator <= other._numerator * _denominator;
+		return _compare(other._numerator, other._denominator) <= 0;
 	}
 
 	bool operator>(const Fraction<IntegerType>& other) const{
@@ -251,23 +482,37 @@ public:
 
 	// IntegerType operators
 	Fraction<IntegerType>& operator+=(const IntegerType& other){
-		_full_simplify();
-		_numerator += other * _denominator;
+		IntegerType term = other;
+		_crowded(term);
+		_numerator = _narrow(wide_type(_numerator) + wide_type(term) * _denominator, "Fraction::operator+=");
 		return *this;
 	}
 	Fraction<IntegerType>& operator-=(const IntegerType& other){
-		_full_simplify();
-		_numerator -= other * _denominator;
+		IntegerType term = other;
+		_crowded(term);
+		_numerator = _narrow(wide_type(_numerator) - wide_type(term) * _denominator, "Fraction::operator-=");
 		return *this;
 	}
 	Fraction<IntegerType>& operator*=(const IntegerType& other){
-		_full_simplify();
-		_numerator *= other;
+		IntegerType factor = other;
+		if (!_crowded(factor)){
+			_numerator *= factor;
+			_simplify();
+			return *this;
+		}
+		_cancel(factor, _denominator);
+		_numerator = _narrow(wide_type(_numerator) * factor, "Fraction::operator*=");
 		return *this;
 	}
 	Fraction<IntegerType>& operator/=(const IntegerType& other){
-		_full_simplify();
-		_denominator *= other;
+		IntegerType divisor = other;
+		if (!_crowded(divisor)){
+			_denominator *= divisor;
+			_simplify();
+			return *this;
+		}
+		_cancel(_numerator, divisor);
+		_denominator = _narrow(wide_type(_denominator) * divisor, "Fraction::operator/=");
 		return *this;
 	}
 
@@ -284,28 +529,8 @@ public:
 		return Fraction(*this) /= other;
 	}
 
-	// These non-const non-assignment operators aren't based on the assignment operators
-	// so that _full_simplify() can be called on the left-side operator so both
-	// get the benefit
-	Fraction<IntegerType> operator+(const IntegerType& other){
-		_full_simplify();
-		return Fraction(*this)._numerator += other * _denominator;
-	}
-	Fraction<IntegerType> operator-(const IntegerType& other){
-		_full_simplify();
-		return Fraction(*this)._numerator -= other * _denominator;
-	}
-	Fraction<IntegerType> operator*(const IntegerType& other){
-		_full_simplify();
-		return Fraction(*this)._numerator *= other;
-	}
-	Fraction<IntegerType> operator/(const IntegerType& other){
-		_full_simplify();
-		return Fraction(*this)._denominator *= other;
-	}
-
 	bool operator==(const IntegerType& other) const{
-		return (_numerator % _denominator == 0 && i() == other);
+		return _compare(other, IntegerType(1)) == 0;
 	}
 
 	bool operator!=(const IntegerType& other) const{
@@ -313,11 +538,11 @@ public:
 	}
 
 	bool operator<(const IntegerType& other) const{
-		return i() < other;
+		return _compare(other, IntegerType(1)) < 0;
 	}
 
 	bool operator<=(const IntegerType& other) const{
-		return operator<(other) || operator==(other);
+		return _compare(other, IntegerType(1)) <= 0;
 	}
 
 	bool operator>(const IntegerType& other) const{
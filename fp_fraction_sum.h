@@ -0,0 +1,320 @@
+/**
+ *	@file fp_fraction_sum.h
+ *	Adds sums and dot products over arrays of Fractions, reduced once at the end
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_FRACTION_SUM
+#define H_FP_FRACTION_SUM
+
+#include <cstddef>
+
+#include "fp_fraction.h"
+
+#ifdef FIXEDPOINT_CPP0X
+	#include <thread>
+	#include <vector>
+#endif
+
+///	Exact sum of Fractions, kept over a running common denominator
+/**
+ *	The sum is held as an integer part plus a numerator over the least common multiple of the denominators added so far,
+ *	all in the wide type of _fp_int_traits. Adding a value whose denominator divides the running one is a multiply-add,
+ *	other values grow the running denominator by one greatest common divisor. It is only reduced to lowest terms
+ *	when it would otherwise outgrow the range where products cannot overflow, and by sum().
+ *	Values that would still take it past that range are added to a Fraction on the side, as by operator+=.
+ *	Accumulators of parts of an array can be merged, e.g. one per thread
+ */
+template<typename IntegerType>
+class FractionAccumulator{
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+	typedef typename _fp_int_traits<IntegerType>::wide_type wide_type;
+	typedef typename _fp_int_traits<wide_type>::unsigned_type wide_unsigned_type;
+
+	static const count_type _wide_bits = std::numeric_limits<wide_type>::digits;
+	// Running denominators stay below 2^_bits, so that they fit in IntegerType and the product of two values below 2^_bits leaves a bit of headroom
+	static const count_type _bits = (_wide_bits - 1) / 2 < std::numeric_limits<IntegerType>::digits ? (_wide_bits - 1) / 2 : std::numeric_limits<IntegerType>::digits;
+
+	wide_type _whole;
+	wide_type _numerator;
+	wide_type _denominator;
+	Fraction<IntegerType> _spill;
+
+	static bool _small(wide_unsigned_type magnitude){
+		return (magnitude >> _bits) == 0;
+	}
+
+	static IntegerType _narrow(wide_type value, const char* operation){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (value != wide_type(IntegerType(value))){
+				_fp_event<Fraction<IntegerType> >(fp_event_overflow, operation);
+			}
+		#else
+			(void)operation;
+		#endif
+		return IntegerType(value);
+	}
+
+	// Moves the integer part of the numerator to _whole, leaving it smaller than the denominator
+	void _carry(){
+		_whole += _numerator / _denominator;
+		_numerator %= _denominator;
+	}
+
+	void _reduce(){
+		_carry();
+		const wide_unsigned_type divisor = _fp_gcd(_fp_magnitude(_numerator), wide_unsigned_type(_denominator));
+		if (divisor > 1){
+			_numerator /= wide_type(divisor);
+			_denominator /= wide_type(divisor);
+		}
+	}
+
+	// Adds numer / denom, given as magnitudes. Returns false, leaving the sum as it was, if denom is too large
+	// or the running denominator would still be too large once reduced
+	bool _add(wide_unsigned_type numer, wide_unsigned_type wide_denom, bool negative){
+		if (!_small(wide_denom)){
+			return false;
+		}
+		wide_type whole = 0;
+		if (!_small(numer)){
+			whole = wide_type(numer / wide_denom);
+			numer %= wide_denom;
+		}
+
+		// Denominators are below 2^_bits, so they are divided in IntegerType's unsigned type rather than the wide one
+		const unsigned_type denom = unsigned_type(wide_denom);
+		unsigned_type current = unsigned_type(_denominator);
+		unsigned_type scale = 1;
+		if (denom != current){
+			if (current % denom == 0){
+				scale = unsigned_type(current / denom);
+			}else{
+				unsigned_type common = _fp_gcd(current, denom);
+				if (!_small(wide_unsigned_type(current / common) * denom)){
+					_reduce();
+					current = unsigned_type(_denominator);
+					common = _fp_gcd(current, denom);
+					if (!_small(wide_unsigned_type(current / common) * denom)){
+						return false;
+					}
+				}
+				// The numerator must be below the old denominator for its product with the growth to stay below the new one
+				if (_fp_magnitude(_numerator) >= current){
+					_carry();
+				}
+				const wide_type grow = wide_type(denom / common);
+				scale = unsigned_type(current / common);
+				_numerator *= grow;
+				_denominator *= grow;
+			}
+		}
+
+		const wide_type term = wide_type(numer * scale);
+		_numerator = negative ? _numerator - term : _numerator + term;
+		_whole = negative ? _whole - whole : _whole + whole;
+		// Keeps room for the next term, which uses at most 2 * _bits bits
+		if (_fp_magnitude(_numerator) >> (_wide_bits - 1)){
+			_carry();
+		}
+		return true;
+	}
+
+public:
+	/// Construct an empty sum, equal to 0
+	FractionAccumulator() : _whole(0), _numerator(0), _denominator(1), _spill(){}
+
+	/// Adds a Fraction
+	/**
+	 *	@param value Fraction to add
+	 */
+	void add(const Fraction<IntegerType>& value){
+		const IntegerType numer = value.numerator();
+		const IntegerType denom = value.denominator();
+		if (!_add(_fp_magnitude(numer), _fp_magnitude(denom), _fp_negative(numer) != _fp_negative(denom))){
+			_spill += value;
+		}
+	}
+
+	/// Adds an array of Fractions
+	/**
+	 *	@param values Fractions to add
+	 *	@param count Number of Fractions
+	 */
+	void add(const Fraction<IntegerType>* values, size_t count){
+		for (size_t i = 0; i < count; i++){
+			add(values[i]);
+		}
+	}
+
+	/// Adds the product of two Fractions
+	/**
+	 *	The product is not reduced: its numerator and denominator are computed in the wide type and added as they are
+	 *	@param a First factor
+	 *	@param b Second factor
+	 */
+	void add_product(const Fraction<IntegerType>& a, const Fraction<IntegerType>& b){
+		const unsigned_type a_numer = _fp_magnitude(a.numerator());
+		const unsigned_type a_denom = _fp_magnitude(a.denominator());
+		const unsigned_type b_numer = _fp_magnitude(b.numerator());
+		const unsigned_type b_denom = _fp_magnitude(b.denominator());
+		const bool negative = (_fp_negative(a.numerator()) != _fp_negative(a.denominator())) != (_fp_negative(b.numerator()) != _fp_negative(b.denominator()));
+
+		// Without a wider type, the products only fit if the factors use half the bits
+		if (_fp_int_traits<IntegerType>::native_wide || ((a_numer | a_denom | b_numer | b_denom) >> (std::numeric_limits<unsigned_type>::digits / 2)) == 0){
+			if (_add(wide_unsigned_type(a_numer) * b_numer, wide_unsigned_type(a_denom) * b_denom, negative)){
+				return;
+			}
+		}
+		_spill += a * b;
+	}
+
+	/// Adds the products of two arrays of Fractions, element by element
+	/**
+	 *	@param a First factors
+	 *	@param b Second factors
+	 *	@param count Number of Fractions in each array
+	 */
+	void add_products(const Fraction<IntegerType>* a, const Fraction<IntegerType>* b, size_t count){
+		for (size_t i = 0; i < count; i++){
+			add_product(a[i], b[i]);
+		}
+	}
+
+	/// Adds the sum of another accumulator
+	/**
+	 *	@param other Accumulator to add, e.g. of another part of the same array
+	 */
+	void merge(const FractionAccumulator<IntegerType>& other){
+		FractionAccumulator<IntegerType> part(other);
+		part._carry();
+		_whole += part._whole;
+		_spill += part._spill;
+		if (!_add(_fp_magnitude(part._numerator), wide_unsigned_type(part._denominator), _fp_negative(part._numerator))){
+			_spill += Fraction<IntegerType>(IntegerType(part._numerator), IntegerType(part._denominator));
+		}
+	}
+
+	/// Returns the sum
+	/**
+	 *	Overflows only if the sum in lowest terms, or its integer part, does not fit in IntegerType,
+	 *	or if adding the values that did not fit the running denominator with operator+= overflows
+	 *	@return Sum of all values added, in lowest terms
+	 */
+	Fraction<IntegerType> sum() const{
+		FractionAccumulator<IntegerType> total(*this);
+		total._reduce();
+		Fraction<IntegerType> result(IntegerType(total._numerator), IntegerType(total._denominator));
+		result += _narrow(total._whole, "FractionAccumulator::sum");
+		if (total._spill.numerator() != 0){
+			result += total._spill;
+			result.simplify();
+		}
+		return result;
+	}
+};
+
+/// Sum of an array of Fractions
+/**
+ *	Accumulated by a FractionAccumulator, which only computes a greatest common divisor when a denominator
+ *	does not divide those before it, instead of after every addition
+ *	@param values Fractions to add
+ *	@param count Number of Fractions
+ *	@return Sum in lowest terms
+ */
+template<typename IntegerType>
+Fraction<IntegerType> fp_sum(const Fraction<IntegerType>* values, size_t count){
+	FractionAccumulator<IntegerType> accumulator;
+	accumulator.add(values, count);
+	return accumulator.sum();
+}
+
+/// Dot product of two arrays of Fractions
+/**
+ *	Accumulated by a FractionAccumulator, without reducing each product.
+ *	Overloads the FixedPoint fp_dot of fp_matrix.h, and both headers can be included together
+ *	@param a First array
+ *	@param b Second array
+ *	@param count Number of elements in each array
+ *	@return Sum of a[i] * b[i], in lowest terms
+ */
+template<typename IntegerType>
+Fraction<IntegerType> fp_dot(const Fraction<IntegerType>* a, const Fraction<IntegerType>* b, size_t count){
+	FractionAccumulator<IntegerType> accumulator;
+	accumulator.add_products(a, b, count);
+	return accumulator.sum();
+}
+
+// Splits count elements evenly between threads, each with its own accumulator, and merges them in order.
+// Sums values if b is null, or the products of a and b
+template<typename IntegerType>
+Fraction<IntegerType> _fp_fraction_sum_parallel(const Fraction<IntegerType>* a, const Fraction<IntegerType>* b, size_t count, unsigned int threads){
+	#ifdef FIXEDPOINT_CPP0X
+		if (!threads){
+			threads = std::thread::hardware_concurrency();
+		}
+		if (size_t(threads) > count){
+			threads = unsigned(count);
+		}
+		if (threads <= 1){
+			return b ? fp_dot(a, b, count) : fp_sum(a, count);
+		}
+
+		std::vector<FractionAccumulator<IntegerType> > partials(threads);
+		std::vector<std::thread> workers;
+		workers.reserve(threads);
+		for (unsigned int t = 0; t < threads; t++){
+			const size_t begin = count * t / threads;
+			const size_t end = count * (t + 1) / threads;
+			FractionAccumulator<IntegerType>* const partial = &partials[t];
+			workers.push_back(std::thread([=](){
+				if (b){
+					partial->add_products(a + begin, b + begin, end - begin);
+				}else{
+					partial->add(a + begin, end - begin);
+				}
+			}));
+		}
+		for (size_t t = 0; t < workers.size(); t++){
+			workers[t].join();
+		}
+		for (size_t t = 1; t < partials.size(); t++){
+			partials[0].merge(partials[t]);
+		}
+		return partials[0].sum();
+	#else
+		(void)threads;
+		return b ? fp_dot(a, b, count) : fp_sum(a, count);
+	#endif
+}
+
+/// Sum of an array of Fractions on several threads
+/**
+ *	As fp_sum, with the array split evenly between threads, whose sums are merged once they are done.
+ *	Without C++11 threads, runs fp_sum on the calling thread
+ *	@param values Fractions to add
+ *	@param count Number of Fractions
+ *	@param threads Number of threads, 0 for one per hardware thread
+ *	@return Sum in lowest terms
+ */
+template<typename IntegerType>
+Fraction<IntegerType> fp_sum_parallel(const Fraction<IntegerType>* values, size_t count, unsigned int threads = 0){
+	return _fp_fraction_sum_parallel(values, static_cast<const Fraction<IntegerType>*>(0), count, threads);
+}
+
+/// Dot product of two arrays of Fractions on several threads
+/**
+ *	As fp_dot, with the arrays split evenly between threads, whose sums are merged once they are done.
+ *	Without C++11 threads, runs fp_dot on the calling thread
+ *	@param a First array
+ *	@param b Second array
+ *	@param count Number of elements in each array
+ *	@param threads Number of threads, 0 for one per hardware thread
+ *	@return Sum of a[i] * b[i], in lowest terms
+ */
+template<typename IntegerType>
+Fraction<IntegerType> fp_dot_parallel(const Fraction<IntegerType>* a, const Fraction<IntegerType>* b, size_t count, unsigned int threads = 0){
+	return _fp_fraction_sum_parallel(a, b, count, threads);
+}
+
+#endif//H_FP_FRACTION_SUM
@@ -0,0 +1,376 @@
+/**
+ *	@file fp_fused.h
+ *	Adds expression templates that evaluate sums of FixedPoint products with a single rescale
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_FUSED
+#define H_FP_FUSED
+
+#include <cstddef>
+
+#include "fp_fixedpoint.h"
+
+// Sum of products kept at twice the fractional bits, in the double-width type when it is a built-in type,
+// and in at least long long int so that long sums of small types keep their high bits.
+// The sum is kept as unsigned so that it wraps without undefined behaviour
+template<typename IntegerType, bool _Native = _fp_int_traits<IntegerType>::native_wide>
+struct _fp_accumulator{
+	typedef typename _fp_int_traits<IntegerType>::wide_type wide_type;
+	typedef typename _fp_select<std::numeric_limits<IntegerType>::is_signed, long long int, unsigned long long int>::type _long_type;
+	typedef typename _fp_select<(sizeof(wide_type) > sizeof(_long_type)), wide_type, _long_type>::type sum_type;
+	typedef typename _fp_int_traits<sum_type>::unsigned_type sum_unsigned_type;
+
+	sum_unsigned_type _sum;
+
+	FIXEDPOINT_CONSTEXPR _fp_accumulator() : _sum(0){}
+
+	// Adds or subtracts a * b
+	template<bool Subtract>
+	FIXEDPOINT_CONSTEXPR void mul_add(IntegerType a, IntegerType b){
+		const sum_unsigned_type product = sum_unsigned_type(sum_type(wide_type(a) * wide_type(b)));
+		_sum = Subtract ? sum_unsigned_type(_sum - product) : sum_unsigned_type(_sum + product);
+	}
+
+	// Adds or subtracts value << shift
+	template<bool Subtract>
+	FIXEDPOINT_CONSTEXPR void add(IntegerType value, count_type shift){
+		const sum_unsigned_type shifted = sum_unsigned_type(sum_unsigned_type(sum_type(value)) << shift);
+		_sum = Subtract ? sum_unsigned_type(_sum - shifted) : sum_unsigned_type(_sum + shifted);
+	}
+
+	// Adds a partial sum of products, e.g. from vector lanes
+	FIXEDPOINT_CONSTEXPR void add_sum(sum_type sum){
+		_sum = sum_unsigned_type(_sum + sum_unsigned_type(sum));
+	}
+
+	FIXEDPOINT_CONSTEXPR bool negative() const{
+		return _fp_negative(sum_type(_sum));
+	}
+
+	// Returns whether the sum shifted right by shift does not fit in Result, with the rounded result in result
+	template<typename Rounding, typename Result>
+	FIXEDPOINT_CONSTEXPR bool result(count_type shift, Result& result) const{
+		const sum_type shifted = shift ? _fp_round_shift<Rounding>(sum_type(_sum), shift) : sum_type(_sum);
+		result = Result(shifted);
+		return _fp_narrowed(shifted, result);
+	}
+};
+
+// Portable fallback for the widest type, keeps the sum as a (high, low) pair
+template<typename IntegerType>
+struct _fp_accumulator<IntegerType, false>{
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+
+	static const count_type _bits = std::numeric_limits<unsigned_type>::digits;
+
+	unsigned_type _high;
+	unsigned_type _low;
+
+	FIXEDPOINT_CONSTEXPR _fp_accumulator() : _high(0), _low(0){}
+
+	template<bool Subtract>
+	FIXEDPOINT_CONSTEXPR void _add(unsigned_type high, unsigned_type low){
+		if (Subtract){
+			_high -= high + unsigned_type(_low < low);
+			_low -= low;
+		}else{
+			_low += low;
+			_high += high + unsigned_type(_low < low);
+		}
+	}
+
+	template<bool Subtract>
+	FIXEDPOINT_CONSTEXPR void mul_add(IntegerType a, IntegerType b){
+		unsigned_type high = 0, low = 0;
+		_fp_wide_arith<IntegerType>::mul_full(a, b, high, low);
+		_add<Subtract>(high, low);
+	}
+
+	template<bool Subtract>
+	FIXEDPOINT_CONSTEXPR void add(IntegerType value, count_type shift){
+		// Sign extended into the high half before shifting
+		const unsigned_type fill = _fp_negative(value) ? ~unsigned_type(0) : unsigned_type(0);
+		if (shift == 0){
+			_add<Subtract>(fill, unsigned_type(value));
+		}else if (shift < _bits){
+			_add<Subtract>(unsigned_type((fill << shift) | (unsigned_type(value) >> (_bits - shift))), unsigned_type(unsigned_type(value) << shift));
+		}else{
+			_add<Subtract>(unsigned_type(unsigned_type(value) << (shift - _bits)), unsigned_type(0));
+		}
+	}
+
+	FIXEDPOINT_CONSTEXPR bool negative() const{
+		return _fp_negative(IntegerType(_high));
+	}
+
+	template<typename Rounding, typename Result>
+	FIXEDPOINT_CONSTEXPR bool result(count_type shift, Result& result) const{
+		IntegerType shifted = 0;
+		const bool overflow = _fp_wide_arith<IntegerType, Rounding>::shift_overflow(_high, _low, shift, shifted);
+		result = Result(shifted);
+		return overflow || _fp_narrowed(shifted, result);
+	}
+};
+
+// Stores an accumulated sum shifted right by shift in result, through the rounding policy and then the overflow policy of result
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy, typename Accumulator>
+FIXEDPOINT_CONSTEXPR void _fp_accumulated(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& result, const Accumulator& accumulator, count_type shift, const char* operation){
+	IntegerType content = 0;
+	const bool overflow = accumulator.template result<_fp_rounding>(shift, content);
+	#ifdef FIXEDPOINT_INSTRUMENT
+		if (overflow){
+			_fp_event<FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(accumulator.negative() ? fp_event_underflow : fp_event_overflow, operation);
+		}
+	#else
+		(void)operation;
+	#endif
+	result() = OverflowPolicy::fit(content, overflow, accumulator.negative());
+}
+
+// Only compiles if both operands have the same format
+template<typename LeftType, typename RightType>
+struct _fp_fused_format;
+
+template<typename Type>
+struct _fp_fused_format<Type, Type>{
+	typedef Type type;
+};
+
+// Leaves give their raw content at an index, which a single value ignores
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+struct _fp_fused_value{
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> fixed_point_type;
+	typedef IntegerType integer_type;
+	typedef OverflowPolicy overflow_policy;
+	static const count_type fractional_bits = FractionalBits;
+
+	IntegerType _content;
+
+	explicit FIXEDPOINT_CONSTEXPR _fp_fused_value(const fixed_point_type& value) : _content(value()){}
+
+	FIXEDPOINT_CONSTEXPR IntegerType operator[](size_t) const{
+		return _content;
+	}
+
+	// Terms that are not products are aligned to the products' fractional bits
+	template<bool Subtract, typename Accumulator>
+	FIXEDPOINT_CONSTEXPR void accumulate(Accumulator& accumulator, size_t) const{
+		accumulator.template add<Subtract>(_content, FractionalBits);
+	}
+};
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+struct _fp_fused_array{
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> fixed_point_type;
+	typedef IntegerType integer_type;
+	typedef OverflowPolicy overflow_policy;
+	static const count_type fractional_bits = FractionalBits;
+
+	const fixed_point_type* _values;
+
+	explicit FIXEDPOINT_CONSTEXPR _fp_fused_array(const fixed_point_type* values) : _values(values){}
+
+	FIXEDPOINT_CONSTEXPR IntegerType operator[](size_t index) const{
+		return _values[index]();
+	}
+
+	template<bool Subtract, typename Accumulator>
+	FIXEDPOINT_CONSTEXPR void accumulate(Accumulator& accumulator, size_t index) const{
+		accumulator.template add<Subtract>(_values[index](), FractionalBits);
+	}
+};
+
+// Products are only formed from leaves, so each one is a single double-width multiplication
+template<typename Left, typename Right>
+struct _fp_fused_product{
+	typedef typename _fp_fused_format<typename Left::fixed_point_type, typename Right::fixed_point_type>::type fixed_point_type;
+	typedef typename Left::integer_type integer_type;
+	typedef typename Left::overflow_policy overflow_policy;
+	static const count_type fractional_bits = Left::fractional_bits;
+
+	Left _left;
+	Right _right;
+
+	FIXEDPOINT_CONSTEXPR _fp_fused_product(const Left& left, const Right& right) : _left(left), _right(right){}
+
+	template<bool Subtract, typename Accumulator>
+	FIXEDPOINT_CONSTEXPR void accumulate(Accumulator& accumulator, size_t index) const{
+		accumulator.template mul_add<Subtract>(_left[index], _right[index]);
+	}
+};
+
+template<typename Left, typename Right, bool _Subtract>
+struct _fp_fused_sum{
+	typedef typename _fp_fused_format<typename Left::fixed_point_type, typename Right::fixed_point_type>::type fixed_point_type;
+	typedef typename Left::integer_type integer_type;
+	typedef typename Left::overflow_policy overflow_policy;
+	static const count_type fractional_bits = Left::fractional_bits;
+
+	Left _left;
+	Right _right;
+
+	FIXEDPOINT_CONSTEXPR _fp_fused_sum(const Left& left, const Right& right) : _left(left), _right(right){}
+
+	template<bool Subtract, typename Accumulator>
+	FIXEDPOINT_CONSTEXPR void accumulate(Accumulator& accumulator, size_t index) const{
+		_left.template accumulate<Subtract>(accumulator, index);
+		_right.template accumulate<(Subtract != _Subtract)>(accumulator, index);
+	}
+};
+
+///	A sum of FixedPoint products that has not been evaluated yet
+/**
+ *	Expressions are started with fp_fused and combined with +, -, and *, e.g. fp_fused(a) * b + fp_fused(c) * d + e.
+ *	Every product is added at full precision to a double-width accumulator, which is rounded to the format
+ *	once, by the rounding policy and then the overflow policy, when the expression is converted to a FixedPoint.
+ *	All operands must have the same format, and only FixedPoints can be multiplied, not sums.
+ *	The accumulator itself wraps around: with fp_saturate or fp_trap, the sum of the full products must fit in twice the bits
+ *	of the integer type, or 64 bits if that is more. An expression holds copies of its values and pointers to its arrays, so it is meant to be evaluated right away
+ */
+template<typename Node>
+class FixedPointExpression{
+	Node _node;
+
+public:
+	typedef typename Node::fixed_point_type fixed_point_type;
+
+	explicit FIXEDPOINT_CONSTEXPR FixedPointExpression(const Node& node) : _node(node){}
+
+	/// Returns the tree of the expression
+	/**
+	 *	@return Expression tree
+	 */
+	FIXEDPOINT_CONSTEXPR const Node& node() const{
+		return _node;
+	}
+
+	/// Evaluates the expression on the elements at index of its arrays
+	/**
+	 *	@param index Index into the arrays of the expression, ignored by single values
+	 *	@return Value of the expression
+	 */
+	FIXEDPOINT_CONSTEXPR fixed_point_type operator[](size_t index) const{
+		typedef typename Node::integer_type integer_type;
+
+		_fp_accumulator<integer_type> accumulator;
+		_node.template accumulate<false>(accumulator, index);
+
+		fixed_point_type result;
+		_fp_accumulated(result, accumulator, Node::fractional_bits, "FixedPointExpression");
+		return result;
+	}
+
+	/// Evaluates an expression of single values
+	/**
+	 *	@return Value of the expression
+	 */
+	FIXEDPOINT_CONSTEXPR operator fixed_point_type() const{
+		return operator[](0);
+	}
+};
+
+/// Starts an expression from a single value
+/**
+ *	@param value Value to use in the expression
+ *	@return Expression of the value
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FIXEDPOINT_CONSTEXPR FixedPointExpression<_fp_fused_value<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> > fp_fused(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& value){
+	return FixedPointExpression<_fp_fused_value<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(_fp_fused_value<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(value));
+}
+
+/// Starts an expression from an array, evaluated element by element by fp_eval
+/**
+ *	@param values Array to use in the expression
+ *	@return Expression of the array
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FIXEDPOINT_CONSTEXPR FixedPointExpression<_fp_fused_array<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> > fp_fused(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* values){
+	return FixedPointExpression<_fp_fused_array<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(_fp_fused_array<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(values));
+}
+
+template<typename Left, typename Right>
+FIXEDPOINT_CONSTEXPR FixedPointExpression<_fp_fused_product<Left, Right> > operator*(const FixedPointExpression<Left>& left, const FixedPointExpression<Right>& right){
+	return FixedPointExpression<_fp_fused_product<Left, Right> >(_fp_fused_product<Left, Right>(left.node(), right.node()));
+}
+
+template<typename Left, typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FIXEDPOINT_CONSTEXPR FixedPointExpression<_fp_fused_product<Left, _fp_fused_value<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> > > operator*(const FixedPointExpression<Left>& left, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& right){
+	return left * fp_fused(right);
+}
+
+template<typename Right, typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FIXEDPOINT_CONSTEXPR FixedPointExpression<_fp_fused_product<_fp_fused_value<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>, Right> > operator*(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& left, const FixedPointExpression<Right>& right){
+	return fp_fused(left) * right;
+}
+
+template<typename Left, typename Right>
+FIXEDPOINT_CONSTEXPR FixedPointExpression<_fp_fused_sum<Left, Right, false> > operator+(const FixedPointExpression<Left>& left, const FixedPointExpression<Right>& right){
+	return FixedPointExpression<_fp_fused_sum<Left, Right, false> >(_fp_fused_sum<Left, Right, false>(left.node(), right.node()));
+}
+
+template<typename Left, typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FIXEDPOINT_CONSTEXPR FixedPointExpression<_fp_fused_sum<Left, _fp_fused_value<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>, false> > operator+(const FixedPointExpression<Left>& left, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& right){
+	return left + fp_fused(right);
+}
+
+template<typename Right, typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FIXEDPOINT_CONSTEXPR FixedPointExpression<_fp_fused_sum<_fp_fused_value<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>, Right, false> > operator+(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& left, const FixedPointExpression<Right>& right){
+	return fp_fused(left) + right;
+}
+
+template<typename Left, typename Right>
+FIXEDPOINT_CONSTEXPR FixedPointExpression<_fp_fused_sum<Left, Right, true> > operator-(const FixedPointExpression<Left>& left, const FixedPointExpression<Right>& right){
+	return FixedPointExpression<_fp_fused_sum<Left, Right, true> >(_fp_fused_sum<Left, Right, true>(left.node(), right.node()));
+}
+
+template<typename Left, typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FIXEDPOINT_CONSTEXPR FixedPointExpression<_fp_fused_sum<Left, _fp_fused_value<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>, true> > operator-(const FixedPointExpression<Left>& left, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& right){
+	return left - fp_fused(right);
+}
+
+template<typename Right, typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FIXEDPOINT_CONSTEXPR FixedPointExpression<_fp_fused_sum<_fp_fused_value<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>, Right, true> > operator-(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& left, const FixedPointExpression<Right>& right){
+	return fp_fused(left) - right;
+}
+
+/// Adds an expression to a FixedPoint, rescaling only once
+/**
+ *	acc += fp_fused(a) * b is evaluated as acc + a * b in the accumulator
+ *	@param target FixedPoint to add to
+ *	@param expression Expression to add
+ *	@return target
+ */
+template<typename Node, typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator+=(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& target, const FixedPointExpression<Node>& expression){
+	return target = target + expression;
+}
+
+/// Subtracts an expression from a FixedPoint, rescaling only once
+/**
+ *	@param target FixedPoint to subtract from
+ *	@param expression Expression to subtract
+ *	@return target
+ */
+template<typename Node, typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FIXEDPOINT_CONSTEXPR FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator-=(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& target, const FixedPointExpression<Node>& expression){
+	return target = target - expression;
+}
+
+/// Evaluates an expression over whole arrays in one pass
+/**
+ *	Every element is read before it is written, so out may be one of the arrays of the expression,
+ *	e.g. fp_eval(y, fp_fused(a) * fp_fused(x) + fp_fused(y), count)
+ *	@param out Array receiving the value of the expression for each index
+ *	@param expression Expression of arrays and single values
+ *	@param count Number of elements in each array
+ */
+template<typename Node, typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_eval(FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* out, const FixedPointExpression<Node>& expression, size_t count){
+	for (size_t i = 0; i < count; i++){
+		out[i] = expression[i];
+	}
+}
+
+#endif//H_FP_FUSED
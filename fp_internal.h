@@ -7,6 +7,7 @@
 #ifndef H_FP_INTERNAL
 #define H_FP_INTERNAL
 
+#include <climits>
 #include <limits>
 
 // Only include safety checks in debug mode
@@ -16,6 +17,16 @@
 #endif
 #endif
 
+// Add the following line to your code before any #include "fp_*.h" to count overflows, divisions by zero,
+// precision loss and other events per type and per thread, and to pass them to a handler (see fp_set_event_handler).
+// Implied by FIXEDPOINT_DEBUG. Without it the checks are not compiled at all
+//#define FIXEDPOINT_INSTRUMENT
+#ifdef FIXEDPOINT_DEBUG
+#ifndef FIXEDPOINT_INSTRUMENT
+#define FIXEDPOINT_INSTRUMENT
+#endif
+#endif
+
 // If compiler is (semi-)C++0x compliant, add things such as static_assert for extra compile-time safety
 #ifndef FIXEDPOINT_CPP0X
 	#if __cplusplus > 199711L
@@ -29,24 +40,754 @@
 	#endif
 #endif
 
+// Functions made of more than a single return statement can only be constexpr from C++14 on
+#ifndef FIXEDPOINT_CPP14
+	#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+		#define FIXEDPOINT_CPP14
+	#endif
+#endif
+
+#ifdef FIXEDPOINT_CPP14
+	#define FIXEDPOINT_CONSTEXPR constexpr
+#else
+	#define FIXEDPOINT_CONSTEXPR
+#endif
+
 // Add the following line to your code before any #include "fp_*.h"
 // to disallow operations done using different template types
 // e.g. Adding a FixedPoint<unsigned int, 12> to a FixedPoint<unsigned int, 16> is not permitted
 // without explicitly converting either
 //#define FIXEDPOINT_FORCEFORMAT
 
+// Add the following line to your code before any #include "fp_*.h"
+// to give the results of +, -, and * on different formats a format deduced at compile time that holds them exactly
+// e.g. multiplying a FixedPoint<short int, 7, 8> by a FixedPoint<short int, 3, 12> gives a FixedPoint<int, 10, 20>.
+// Rescaling then only happens when the result is assigned to a narrower format. Ignored with FIXEDPOINT_FORCEFORMAT
+//#define FIXEDPOINT_DEDUCEFORMAT
+
 // Add the following line to your code before any #include "fp_*.h"
 // to round all integer values given by the class. Minor performance hit, may be less 
 // consistant between operations
 //#define FIXEDPOINT_ROUNDING
+// Products, convert, and i() then round to nearest with halves rounded up. To round differently, name
+// the rounding policy instead (fp_round_truncate, fp_round_half_up, fp_round_half_even, or fp_round_stochastic<Generator>)
+//#define FIXEDPOINT_ROUNDING_POLICY fp_round_half_even
+
+// Add the following line to your code before any #include "fp_*.h"
+// to divide FixedPoints by multiplying with a Newton-Raphson reciprocal instead of a
+// double-width integer division. Faster on most hardware, but quotients may be a few units low in the last place
+//#define FIXEDPOINT_RECIPROCAL_DIVISION
 
 // typedef for lengths and length differences. chars are used by default, but if for whatever reason, 
 // that is not enough, they can be changed to higher values
 typedef unsigned char	count_type;
 typedef signed char		scount_type;
 
+// Use the compiler's 128-bit integers for double-width intermediates of 64-bit types when available.
+// Add the following line to your code before any #include "fp_*.h" to always use the portable fallback
+//#define FIXEDPOINT_NO_INT128
+#ifndef FIXEDPOINT_NO_INT128
+	#ifdef __SIZEOF_INT128__
+		#define FIXEDPOINT_INT128
+	#endif
+#endif
+
+// Use the compiler's overflow checking builtins (e.g. __builtin_add_overflow) for saturating and trapping arithmetic.
+// Add the following line to your code before any #include "fp_*.h" to always use the portable checks
+//#define FIXEDPOINT_NO_BUILTIN_OVERFLOW
+#ifndef FIXEDPOINT_NO_BUILTIN_OVERFLOW
+	#if defined(__clang__)
+		#if __has_builtin(__builtin_add_overflow)
+			#define FIXEDPOINT_BUILTIN_OVERFLOW
+		#endif
+	#elif defined(__GNUC__) && __GNUC__ >= 5
+		#define FIXEDPOINT_BUILTIN_OVERFLOW
+	#endif
+#endif
+
+// Called by the fp_trap overflow policy when a result does not fit.
+// Define it before any #include "fp_*.h" to report overflows differently, e.g. by throwing
+#ifndef FIXEDPOINT_TRAP
+	#include <cstdlib>
+	#define FIXEDPOINT_TRAP() std::abort()
+#endif
+
+// Maps an integer type to its unsigned counterpart and to a type at least twice as wide,
+// used to hold intermediate results (e.g. a full product before the fractional shift).
+// native_wide is false if there is no wider built-in type and the portable fallback must be used
+template<typename IntegerType>
+struct _fp_int_traits{
+	typedef IntegerType unsigned_type;
+	typedef IntegerType wide_type;
+	static const bool native_wide = false;
+};
+
+#define FIXEDPOINT_INT_TRAITS(_inttype_, _unsignedtype_, _widetype_, _native_) \
+	template<> \
+	struct _fp_int_traits<_inttype_>{ \
+		typedef _unsignedtype_ unsigned_type; \
+		typedef _widetype_ wide_type; \
+		static const bool native_wide = _native_; \
+	};
+
+FIXEDPOINT_INT_TRAITS(char,					unsigned char,			int,					true)
+FIXEDPOINT_INT_TRAITS(signed char,			unsigned char,			short int,				true)
+FIXEDPOINT_INT_TRAITS(unsigned char,		unsigned char,			unsigned short int,		true)
+FIXEDPOINT_INT_TRAITS(short int,			unsigned short int,		int,					true)
+FIXEDPOINT_INT_TRAITS(unsigned short int,	unsigned short int,		unsigned int,			true)
+FIXEDPOINT_INT_TRAITS(int,					unsigned int,			long long int,			true)
+FIXEDPOINT_INT_TRAITS(unsigned int,			unsigned int,			unsigned long long int,	true)
+#if LONG_MAX > 0x7FFFFFFF
+	#ifdef FIXEDPOINT_INT128
+		FIXEDPOINT_INT_TRAITS(long int,				unsigned long int,		__int128,				true)
+		FIXEDPOINT_INT_TRAITS(unsigned long int,	unsigned long int,		unsigned __int128,		true)
+	#else
+		FIXEDPOINT_INT_TRAITS(long int,				unsigned long int,		long int,				false)
+		FIXEDPOINT_INT_TRAITS(unsigned long int,	unsigned long int,		unsigned long int,		false)
+	#endif
+#else
+	FIXEDPOINT_INT_TRAITS(long int,				unsigned long int,		long long int,			true)
+	FIXEDPOINT_INT_TRAITS(unsigned long int,	unsigned long int,		unsigned long long int,	true)
+#endif
+#ifdef FIXEDPOINT_INT128
+	FIXEDPOINT_INT_TRAITS(long long int,			unsigned long long int,	__int128,				true)
+	FIXEDPOINT_INT_TRAITS(unsigned long long int,	unsigned long long int,	unsigned __int128,		true)
+
+	// Only for the unsigned counterparts of double-width intermediates
+	FIXEDPOINT_INT_TRAITS(__int128,					unsigned __int128,		__int128,				false)
+	FIXEDPOINT_INT_TRAITS(unsigned __int128,		unsigned __int128,		unsigned __int128,		false)
+#else
+	FIXEDPOINT_INT_TRAITS(long long int,			unsigned long long int,	long long int,			false)
+	FIXEDPOINT_INT_TRAITS(unsigned long long int,	unsigned long long int,	unsigned long long int,	false)
+#endif
+
+#undef FIXEDPOINT_INT_TRAITS
+
+// Sign test that is simply false for unsigned types
+template<typename IntegerType>
+FIXEDPOINT_CONSTEXPR bool _fp_negative(IntegerType value){
+	return std::numeric_limits<IntegerType>::is_signed && value < IntegerType(0);
+}
+
+// Absolute value as the unsigned type, also valid for the most negative value
+template<typename IntegerType>
+FIXEDPOINT_CONSTEXPR typename _fp_int_traits<IntegerType>::unsigned_type _fp_magnitude(IntegerType value){
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+	return _fp_negative(value) ? unsigned_type(unsigned_type(0) - unsigned_type(value)) : unsigned_type(value);
+}
+
+// Number of bits needed to represent an unsigned value (0 for 0)
+template<typename UnsignedType>
+FIXEDPOINT_CONSTEXPR count_type _fp_bit_length(UnsignedType value){
+	count_type length = 0;
+	for (count_type step = std::numeric_limits<UnsignedType>::digits / 2; step; step /= 2){
+		if (value >> step){
+			value >>= step;
+			length += step;
+		}
+	}
+	return length + count_type(value != 0);
+}
+
+// Number of zero bits below the lowest set bit of a nonzero unsigned value
+template<typename UnsignedType>
+inline count_type _fp_trailing_zeros(UnsignedType value){
+	#if defined(__GNUC__) || defined(__clang__)
+		if (std::numeric_limits<UnsignedType>::digits <= std::numeric_limits<unsigned int>::digits){
+			return count_type(__builtin_ctz(static_cast<unsigned int>(value)));
+		}
+		if (std::numeric_limits<UnsignedType>::digits <= std::numeric_limits<unsigned long long int>::digits){
+			return count_type(__builtin_ctzll(static_cast<unsigned long long int>(value)));
+		}
+	#endif
+	count_type count = 0;
+	for (count_type step = std::numeric_limits<UnsignedType>::digits / 2; step; step /= 2){
+		if (!(value & ((UnsignedType(1) << step) - 1))){
+			value >>= step;
+			count += step;
+		}
+	}
+	return count;
+}
+
+/// Rounding policies, applied wherever low bits are shifted out
+/**
+ *	round_up is given the bits shifted out as a fraction aligned to the top of UnsignedType, along with
+ *	whether the truncated result is odd, and returns whether the truncated result must be increased by one.
+ *	Truncated results are rounded toward negative infinity, as by an arithmetic shift
+ */
+
+/// Keeps the truncated result, the default
+struct fp_round_truncate{
+	static const bool truncates = true;
+
+	template<typename UnsignedType>
+	static FIXEDPOINT_CONSTEXPR bool round_up(UnsignedType, bool){
+		return false;
+	}
+};
+
+/// Rounds to nearest, halves toward positive infinity
+struct fp_round_half_up{
+	static const bool truncates = false;
+
+	template<typename UnsignedType>
+	static FIXEDPOINT_CONSTEXPR bool round_up(UnsignedType fraction, bool){
+		return (fraction >> (std::numeric_limits<UnsignedType>::digits - 1)) != 0;
+	}
+};
+
+/// Rounds to nearest, halves to the even neighbour, which leaves no bias over long chains of operations
+struct fp_round_half_even{
+	static const bool truncates = false;
+
+	template<typename UnsignedType>
+	static FIXEDPOINT_CONSTEXPR bool round_up(UnsignedType fraction, bool odd){
+		const UnsignedType half = UnsignedType(1) << (std::numeric_limits<UnsignedType>::digits - 1);
+		return fraction > half || (fraction == half && odd);
+	}
+};
+
+// Whether 64 random bits, read as a fraction, are below a fraction of UnsignedType, both aligned to the top.
+// Fractions wider than the draw, such as those of 128 bit sums, are compared on their top 64 bits
+template<typename UnsignedType, bool _Wide = (std::numeric_limits<UnsignedType>::digits > std::numeric_limits<unsigned long long int>::digits)>
+struct _fp_random_below{
+	static FIXEDPOINT_CONSTEXPR bool apply(unsigned long long int draw, UnsignedType fraction){
+		return UnsignedType(draw >> (std::numeric_limits<unsigned long long int>::digits - std::numeric_limits<UnsignedType>::digits)) < fraction;
+	}
+};
+
+template<typename UnsignedType>
+struct _fp_random_below<UnsignedType, true>{
+	static FIXEDPOINT_CONSTEXPR bool apply(unsigned long long int draw, UnsignedType fraction){
+		return draw < static_cast<unsigned long long int>(fraction >> (std::numeric_limits<UnsignedType>::digits - std::numeric_limits<unsigned long long int>::digits));
+	}
+};
+
+/// Rounds up with a probability equal to the fraction shifted out, so errors average out to zero
+/**
+ *	Generator must have a static function next() returning uniformly distributed bits as an unsigned long long int,
+ *	e.g. a thread-local xorshift. It is not called when nothing is shifted out.
+ *	Fractions of more than 64 bits are rounded on their top 64 bits, which biases results by less than 2^-64
+ */
+template<typename Generator>
+struct fp_round_stochastic{
+	static const bool truncates = false;
+
+	template<typename UnsignedType>
+	static FIXEDPOINT_CONSTEXPR bool round_up(UnsignedType fraction, bool){
+		return fraction != 0 && _fp_random_below<UnsignedType>::apply(Generator::next(), fraction);
+	}
+};
+
+#ifndef FIXEDPOINT_ROUNDING_POLICY
+	#ifdef FIXEDPOINT_ROUNDING
+		#define FIXEDPOINT_ROUNDING_POLICY fp_round_half_up
+	#else
+		#define FIXEDPOINT_ROUNDING_POLICY fp_round_truncate
+	#endif
+#endif
+
+typedef FIXEDPOINT_ROUNDING_POLICY _fp_rounding;
+
+// value >> shift, rounded by the policy, 0 < shift < digits
+template<typename Rounding, typename IntegerType>
+FIXEDPOINT_CONSTEXPR IntegerType _fp_round_shift(IntegerType value, count_type shift){
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+	const IntegerType result = IntegerType(value >> shift);
+	const unsigned_type fraction = unsigned_type(unsigned_type(value) << (std::numeric_limits<unsigned_type>::digits - shift));
+	return IntegerType(result + IntegerType(Rounding::round_up(fraction, (result & 1) != 0)));
+}
+
+// The low shift bits of the double-width (high, low) pair, aligned to the top of UnsignedType, 0 <= shift < 2 * digits.
+// Lower bits that do not fit are folded into the last bit, so a fraction just over one half does not read as exactly one half
+template<typename UnsignedType>
+FIXEDPOINT_CONSTEXPR UnsignedType _fp_wide_fraction(UnsignedType high, UnsignedType low, count_type shift){
+	const count_type bits = std::numeric_limits<UnsignedType>::digits;
+	if (shift == 0){
+		return 0;
+	}
+	if (shift <= bits){
+		return UnsignedType(low << (bits - shift));
+	}
+	return UnsignedType((high << (2 * bits - shift)) | (low >> (shift - bits)) | UnsignedType(UnsignedType(low << (2 * bits - shift)) != 0));
+}
+
+// Chooses between two types at compile time
+template<bool Condition, typename TrueType, typename FalseType>
+struct _fp_select{
+	typedef TrueType type;
+};
+
+template<typename TrueType, typename FalseType>
+struct _fp_select<false, TrueType, FalseType>{
+	typedef FalseType type;
+};
+
+// Multiplies value by 2^Shift with a single shift chosen at compile time, right shifts are rounded by the policy
+template<typename IntegerType, scount_type Shift, typename Rounding = fp_round_truncate, bool Left = (Shift >= 0)>
+struct _fp_shift{
+	static FIXEDPOINT_CONSTEXPR IntegerType apply(IntegerType value){
+		// Shift as unsigned, left shifting a negative value is undefined
+		return IntegerType(typename _fp_int_traits<IntegerType>::unsigned_type(value) << Shift);
+	}
+};
+
+template<typename IntegerType, scount_type Shift, typename Rounding>
+struct _fp_shift<IntegerType, Shift, Rounding, false>{
+	static FIXEDPOINT_CONSTEXPR IntegerType apply(IntegerType value){
+		return _fp_round_shift<Rounding>(value, count_type(-Shift));
+	}
+};
+
+// Double-width arithmetic on IntegerType, using wide_type when it is a built-in type.
+// Products are rounded by the policy, quotients toward zero
+template<typename IntegerType, typename Rounding = fp_round_truncate, bool _Native = _fp_int_traits<IntegerType>::native_wide>
+struct _fp_wide_arith{
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+	typedef typename _fp_int_traits<IntegerType>::wide_type wide_type;
+
+	// Full product as a (high, low) pair, in 2's complement if IntegerType is signed
+	static FIXEDPOINT_CONSTEXPR void mul_full(IntegerType a, IntegerType b, unsigned_type& high, unsigned_type& low){
+		const wide_type product = wide_type(a) * wide_type(b);
+		low = unsigned_type(product);
+		high = unsigned_type(product >> std::numeric_limits<unsigned_type>::digits);
+	}
+
+	// Returns whether value >> shift does not fit in IntegerType, with the rounded result in result
+	static FIXEDPOINT_CONSTEXPR bool shift_overflow(wide_type value, count_type shift, IntegerType& result){
+		const unsigned_type fraction = _fp_wide_fraction(unsigned_type(value >> std::numeric_limits<unsigned_type>::digits), unsigned_type(value), shift);
+		const wide_type shifted = (value >> shift) + wide_type(Rounding::round_up(fraction, ((value >> shift) & 1) != 0));
+		result = IntegerType(shifted);
+		return wide_type(result) != shifted;
+	}
+
+	// As mul_shift, also returns whether the result does not fit in IntegerType
+	static FIXEDPOINT_CONSTEXPR bool mul_shift_overflow(IntegerType a, IntegerType b, count_type shift, IntegerType& result){
+		return shift_overflow(wide_type(a) * wide_type(b), shift, result);
+	}
+
+	// Returns (a * b) >> shift without losing the high half of the product, shift < 2 * digits
+	static FIXEDPOINT_CONSTEXPR IntegerType mul_shift(IntegerType a, IntegerType b, count_type shift){
+		IntegerType result = 0;
+		mul_shift_overflow(a, b, shift, result);
+		return result;
+	}
+
+	// Returns (a << shift) / b, rounded toward zero, shift < digits
+	static FIXEDPOINT_CONSTEXPR IntegerType shift_div(IntegerType a, IntegerType b, count_type shift){
+		return IntegerType((wide_type(a) * (wide_type(1) << shift)) / wide_type(b));
+	}
+
+	// As shift_div, also returns whether the result does not fit in IntegerType
+	static FIXEDPOINT_CONSTEXPR bool shift_div_overflow(IntegerType a, IntegerType b, count_type shift, IntegerType& result){
+		const wide_type quotient = (wide_type(a) * (wide_type(1) << shift)) / wide_type(b);
+		result = IntegerType(quotient);
+		return wide_type(result) != quotient;
+	}
+};
+
+// Portable fallback for the widest type, builds the full product out of half-width pieces
+template<typename IntegerType, typename Rounding>
+struct _fp_wide_arith<IntegerType, Rounding, false>{
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+
+	static const count_type _bits = std::numeric_limits<unsigned_type>::digits;
+	static const count_type _half = _bits / 2;
+
+	// Full product as a (high, low) pair, in 2's complement if IntegerType is signed
+	static FIXEDPOINT_CONSTEXPR void mul_full(IntegerType a, IntegerType b, unsigned_type& high, unsigned_type& low){
+		const unsigned_type mask = (unsigned_type(1) << _half) - 1;
+		const unsigned_type ua(a), ub(b);
+
+		const unsigned_type ll = (ua & mask) * (ub & mask);
+		const unsigned_type lh = (ua & mask) * (ub >> _half);
+		const unsigned_type hl = (ua >> _half) * (ub & mask);
+		const unsigned_type hh = (ua >> _half) * (ub >> _half);
+		const unsigned_type mid = (ll >> _half) + (lh & mask) + (hl & mask);
+
+		low = (ll & mask) | (mid << _half);
+		high = hh + (lh >> _half) + (hl >> _half) + (mid >> _half);
+
+		// Signed correction: the unsigned product counts a negative operand as operand + 2^_bits
+		if (_fp_negative(a)){
+			high -= ub;
+		}
+		if (_fp_negative(b)){
+			high -= ua;
+		}
+	}
+
+	// Returns whether the (high, low) pair shifted right by shift does not fit in IntegerType, with the rounded result in result
+	static FIXEDPOINT_CONSTEXPR bool shift_overflow(unsigned_type high, unsigned_type low, count_type shift, IntegerType& result){
+		if (shift == 0){
+			result = IntegerType(low);
+		}else if (shift < _bits){
+			result = IntegerType((low >> shift) | (high << (_bits - shift)));
+		}else{
+			result = IntegerType(IntegerType(high) >> (shift - _bits));
+		}
+
+		// Rounding up the largest value wraps around
+		const bool up = Rounding::round_up(_fp_wide_fraction(high, low, shift), (result & 1) != 0);
+		const bool wrapped = up && result == std::numeric_limits<IntegerType>::max();
+		result = IntegerType(unsigned_type(result) + unsigned_type(up));
+
+		// Every bit of the value from the first one that does not fit upward must be a copy of its sign
+		const unsigned_type fill = _fp_negative(IntegerType(high)) ? ~unsigned_type(0) : unsigned_type(0);
+		const count_type first = shift + std::numeric_limits<IntegerType>::digits;
+		if (first >= 2 * _bits){
+			return wrapped;
+		}
+		if (first >= _bits){
+			return wrapped || (high >> (first - _bits)) != (fill >> (first - _bits));
+		}
+		return wrapped || high != fill || (low >> first) != (fill >> first);
+	}
+
+	static FIXEDPOINT_CONSTEXPR bool mul_shift_overflow(IntegerType a, IntegerType b, count_type shift, IntegerType& result){
+		unsigned_type high = 0, low = 0;
+		mul_full(a, b, high, low);
+		return shift_overflow(high, low, shift, result);
+	}
+
+	static FIXEDPOINT_CONSTEXPR IntegerType mul_shift(IntegerType a, IntegerType b, count_type shift){
+		IntegerType result = 0;
+		mul_shift_overflow(a, b, shift, result);
+		return result;
+	}
+
+	// Restoring long division of the double-width dividend, one quotient bit per step
+	static FIXEDPOINT_CONSTEXPR bool shift_div_overflow(IntegerType a, IntegerType b, count_type shift, IntegerType& result){
+		const unsigned_type divisor = _fp_magnitude(b);
+		unsigned_type low = _fp_magnitude(a);
+		const unsigned_type top = shift ? low >> (_bits - shift) : 0;
+		unsigned_type remainder = top % divisor;
+		unsigned_type quotient = 0;
+		low <<= shift;
+
+		for (count_type i = 0; i < _bits; i++){
+			const bool carry = (remainder >> (_bits - 1)) != 0;
+			remainder = (remainder << 1) | (low >> (_bits - 1));
+			low <<= 1;
+			quotient <<= 1;
+			if (carry || remainder >= divisor){
+				remainder -= divisor;
+				quotient |= 1;
+			}
+		}
+
+		const bool negative = _fp_negative(a) != _fp_negative(b);
+		result = IntegerType(negative ? unsigned_type(0) - quotient : quotient);
+
+		// The quotient needs more than _bits bits if the bits shifted out of the dividend already reach the divisor,
+		// and the most negative signed value has a magnitude one larger than the most positive
+		const unsigned_type limit = unsigned_type(std::numeric_limits<IntegerType>::max()) + unsigned_type(negative);
+		return top >= divisor || quotient > limit;
+	}
+
+	static FIXEDPOINT_CONSTEXPR IntegerType shift_div(IntegerType a, IntegerType b, count_type shift){
+		IntegerType result = 0;
+		shift_div_overflow(a, b, shift, result);
+		return result;
+	}
+};
+
+// Largest value of IntegerType, or the smallest if negative
+template<typename IntegerType>
+FIXEDPOINT_CONSTEXPR IntegerType _fp_limit(bool negative){
+	return negative ? std::numeric_limits<IntegerType>::min() : std::numeric_limits<IntegerType>::max();
+}
+
+// Sum that also returns whether the result wrapped
+template<typename IntegerType>
+FIXEDPOINT_CONSTEXPR bool _fp_add_overflow(IntegerType a, IntegerType b, IntegerType& result){
+	#ifdef FIXEDPOINT_BUILTIN_OVERFLOW
+		return __builtin_add_overflow(a, b, &result);
+	#else
+		typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+		result = IntegerType(unsigned_type(a) + unsigned_type(b));
+		if (std::numeric_limits<IntegerType>::is_signed){
+			return _fp_negative(a) == _fp_negative(b) && _fp_negative(result) != _fp_negative(a);
+		}
+		return result < a;
+	#endif
+}
+
+// Difference that also returns whether the result wrapped
+template<typename IntegerType>
+FIXEDPOINT_CONSTEXPR bool _fp_sub_overflow(IntegerType a, IntegerType b, IntegerType& result){
+	#ifdef FIXEDPOINT_BUILTIN_OVERFLOW
+		return __builtin_sub_overflow(a, b, &result);
+	#else
+		typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+		result = IntegerType(unsigned_type(a) - unsigned_type(b));
+		if (std::numeric_limits<IntegerType>::is_signed){
+			return _fp_negative(a) != _fp_negative(b) && _fp_negative(result) != _fp_negative(a);
+		}
+		return a < b;
+	#endif
+}
+
+/// Events counted by instrumented builds, see FIXEDPOINT_INSTRUMENT
+enum fp_event{
+	fp_event_overflow,			///< Result above the largest value, e.g. a sum that wrapped around
+	fp_event_underflow,			///< Result below the smallest value
+	fp_event_division_by_zero,
+	fp_event_precision_loss,	///< Non-zero bits discarded by a conversion
+	fp_event_domain,			///< Argument outside of a function's domain, e.g. the square root of a negative number
+	fp_event_range,				///< Index out of range
+	fp_event_count				///< Number of events, also used for "no event"
+};
+
+/// Counts of each event for one type on one thread
+struct fp_event_counts{
+	unsigned long long int count[fp_event_count];
+};
+
+/// Called on every event with the event and the operation that caused it (e.g. "FixedPoint::operator+=")
+typedef void (*fp_event_handler)(fp_event event, const char* operation);
+
+#ifdef FIXEDPOINT_CPP0X
+	#define FIXEDPOINT_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+	#define FIXEDPOINT_THREAD_LOCAL __declspec(thread)
+#else
+	#define FIXEDPOINT_THREAD_LOCAL __thread
+#endif
+
+inline fp_event_handler& _fp_event_handler(){
+	static fp_event_handler handler = 0;
+	return handler;
+}
+
+/// Sets the handler called on every event
+/**
+ *	Set it before starting threads that use instrumented types, the handler itself is not synchronized
+ *	@param handler Function to call, or 0 to only count events
+ *	@return Previous handler
+ */
+inline fp_event_handler fp_set_event_handler(fp_event_handler handler){
+	const fp_event_handler previous = _fp_event_handler();
+	_fp_event_handler() = handler;
+	return previous;
+}
+
+/// Returns the event counts of a type on the calling thread
+/**
+ *	Counts are only incremented if FIXEDPOINT_INSTRUMENT is defined, and can be reset by assigning to them
+ *	@return Event counts of Type, e.g. fp_events<fp16_16>().count[fp_event_overflow]
+ */
+template<typename Type>
+fp_event_counts& fp_events(){
+	static FIXEDPOINT_THREAD_LOCAL fp_event_counts counts;
+	return counts;
+}
+
+#ifdef FIXEDPOINT_INSTRUMENT
+	// Records an event on Type, does nothing for fp_event_count
+	template<typename Type>
+	void _fp_event(fp_event event, const char* operation){
+		if (event == fp_event_count){
+			return;
+		}
+		++fp_events<Type>().count[event];
+		if (_fp_event_handler()){
+			_fp_event_handler()(event, operation);
+		}
+	}
+
+	// Events that a + b, a - b, (a * b) >> shift, (a << shift) / b, or a conversion shifting by shift would cause.
+	// They are checked apart from the overflow policy, so wrapping types are counted too
+	template<typename IntegerType>
+	FIXEDPOINT_CONSTEXPR fp_event _fp_add_event(IntegerType a, IntegerType b){
+		IntegerType result = 0;
+		return !_fp_add_overflow(a, b, result) ? fp_event_count : (_fp_negative(b) ? fp_event_underflow : fp_event_overflow);
+	}
+
+	template<typename IntegerType>
+	FIXEDPOINT_CONSTEXPR fp_event _fp_sub_event(IntegerType a, IntegerType b){
+		IntegerType result = 0;
+		return !_fp_sub_overflow(a, b, result) ? fp_event_count : (_fp_negative(b) ? fp_event_overflow : fp_event_underflow);
+	}
+
+	template<typename IntegerType>
+	FIXEDPOINT_CONSTEXPR fp_event _fp_mul_event(IntegerType a, IntegerType b, count_type shift){
+		IntegerType result = 0;
+		return !_fp_wide_arith<IntegerType, _fp_rounding>::mul_shift_overflow(a, b, shift, result) ? fp_event_count : (_fp_negative(a) != _fp_negative(b) ? fp_event_underflow : fp_event_overflow);
+	}
+
+	template<typename IntegerType>
+	FIXEDPOINT_CONSTEXPR fp_event _fp_div_event(IntegerType a, IntegerType b, count_type shift){
+		IntegerType result = 0;
+		if (b == 0){
+			return fp_event_division_by_zero;
+		}
+		return !_fp_wide_arith<IntegerType>::shift_div_overflow(a, b, shift, result) ? fp_event_count : (_fp_negative(a) != _fp_negative(b) ? fp_event_underflow : fp_event_overflow);
+	}
+
+	template<typename IntegerType>
+	FIXEDPOINT_CONSTEXPR fp_event _fp_shift_event(IntegerType value, scount_type shift){
+		typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+		if (shift < 0){
+			return unsigned_type(unsigned_type(value) << (std::numeric_limits<unsigned_type>::digits + shift)) != 0 ? fp_event_precision_loss : fp_event_count;
+		}
+		const IntegerType shifted = IntegerType(unsigned_type(value) << shift);
+		if (IntegerType(shifted >> shift) == value){
+			return fp_event_count;
+		}
+		return _fp_negative(value) ? fp_event_underflow : fp_event_overflow;
+	}
+#endif
+
+// Whether converting value to another integer type changed it
+template<typename IntegerType, typename Result>
+FIXEDPOINT_CONSTEXPR bool _fp_narrowed(IntegerType value, Result result){
+	return IntegerType(result) != value || _fp_negative(result) != _fp_negative(value);
+}
+
+/// Overflow policies, given as the last FixedPoint template argument
+/**
+ *	Each policy works on raw content: add and sub return a + b and a - b, mul returns (a * b) >> shift
+ *	rounded by the rounding policy, div returns (a << shift) / b rounded toward zero, and narrow<Result>
+ *	converts to a smaller integer type. fit(result, overflow, negative) settles a result computed elsewhere, such as by
+ *	a fused expression, given whether it did not fit and its sign. The policy is part of the type, so choosing one costs nothing at run time.
+ *	fp_saturate and fp_trap use the range of the integer type, which is the range of the format when it uses all of the bits
+ */
+
+/// Discards the bits that do not fit, the default
+struct fp_wrap{
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType add(IntegerType a, IntegerType b){
+		// Unsigned arithmetic wraps without undefined behaviour
+		typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+		return IntegerType(unsigned_type(a) + unsigned_type(b));
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType sub(IntegerType a, IntegerType b){
+		typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+		return IntegerType(unsigned_type(a) - unsigned_type(b));
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType mul(IntegerType a, IntegerType b, count_type shift){
+		return _fp_wide_arith<IntegerType, _fp_rounding>::mul_shift(a, b, shift);
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType div(IntegerType a, IntegerType b, count_type shift){
+		return _fp_wide_arith<IntegerType>::shift_div(a, b, shift);
+	}
+
+	template<typename Result, typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR Result narrow(IntegerType value){
+		return Result(value);
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType fit(IntegerType result, bool, bool){
+		return result;
+	}
+};
+
+/// Clamps results that do not fit to the largest or smallest value, division by zero included
+struct fp_saturate{
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType add(IntegerType a, IntegerType b){
+		IntegerType result = 0;
+		return _fp_add_overflow(a, b, result) ? _fp_limit<IntegerType>(_fp_negative(b)) : result;
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType sub(IntegerType a, IntegerType b){
+		IntegerType result = 0;
+		return _fp_sub_overflow(a, b, result) ? _fp_limit<IntegerType>(!_fp_negative(b)) : result;
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType mul(IntegerType a, IntegerType b, count_type shift){
+		IntegerType result = 0;
+		return _fp_wide_arith<IntegerType, _fp_rounding>::mul_shift_overflow(a, b, shift, result) ? _fp_limit<IntegerType>(_fp_negative(a) != _fp_negative(b)) : result;
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType div(IntegerType a, IntegerType b, count_type shift){
+		if (b == 0){
+			return a == 0 ? IntegerType(0) : _fp_limit<IntegerType>(_fp_negative(a));
+		}
+		IntegerType result = 0;
+		return _fp_wide_arith<IntegerType>::shift_div_overflow(a, b, shift, result) ? _fp_limit<IntegerType>(_fp_negative(a) != _fp_negative(b)) : result;
+	}
+
+	template<typename Result, typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR Result narrow(IntegerType value){
+		return _fp_narrowed(value, Result(value)) ? _fp_limit<Result>(_fp_negative(value)) : Result(value);
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType fit(IntegerType result, bool overflow, bool negative){
+		return overflow ? _fp_limit<IntegerType>(negative) : result;
+	}
+};
+
+/// Calls FIXEDPOINT_TRAP() when a result does not fit or on division by zero
+struct fp_trap{
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType add(IntegerType a, IntegerType b){
+		IntegerType result = 0;
+		if (_fp_add_overflow(a, b, result)){
+			FIXEDPOINT_TRAP();
+		}
+		return result;
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType sub(IntegerType a, IntegerType b){
+		IntegerType result = 0;
+		if (_fp_sub_overflow(a, b, result)){
+			FIXEDPOINT_TRAP();
+		}
+		return result;
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType mul(IntegerType a, IntegerType b, count_type shift){
+		IntegerType result = 0;
+		if (_fp_wide_arith<IntegerType, _fp_rounding>::mul_shift_overflow(a, b, shift, result)){
+			FIXEDPOINT_TRAP();
+		}
+		return result;
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType div(IntegerType a, IntegerType b, count_type shift){
+		IntegerType result = 0;
+		if (b == 0 || _fp_wide_arith<IntegerType>::shift_div_overflow(a, b, shift, result)){
+			FIXEDPOINT_TRAP();
+		}
+		return result;
+	}
+
+	template<typename Result, typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR Result narrow(IntegerType value){
+		if (_fp_narrowed(value, Result(value))){
+			FIXEDPOINT_TRAP();
+		}
+		return Result(value);
+	}
+
+	template<typename IntegerType>
+	static FIXEDPOINT_CONSTEXPR IntegerType fit(IntegerType result, bool overflow, bool){
+		if (overflow){
+			FIXEDPOINT_TRAP();
+		}
+		return result;
+	}
+};
+
 // FixedPoint declarations
-template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits>
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits, typename OverflowPolicy = fp_wrap>
 class FixedPoint;
 
 // Decimal declarations
@@ -57,6 +798,10 @@ class FixedDecimal;
 template<bool _Signed = false, typename _StorageType = unsigned char>
 class Decimal;*/
 
+// Multiplier computed from a FixedPoint divisor, see FixedPoint::reciprocal()
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits>
+class FixedPointReciprocal;
+
 // Fraction declarations
 template<typename IntegerType>
 class Fraction;
@@ -0,0 +1,384 @@
+/**
+ *	@file fp_math.h
+ *	Adds integer-only math functions for FixedPoints
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_MATH
+#define H_FP_MATH
+
+#include "fp_fixedpoint.h"
+
+// All functions work internally on 64 bit integers, as unsigned 2.62 or signed 3.60 fixed point numbers,
+// so results are identical on every platform. The number of iterations depends on the fractional bits of the format,
+// and results are rounded to the nearest value of the format.
+// Results that do not fit in the format are undefined, as are negative results for unsigned formats
+
+typedef long long			_fp_math_int;
+typedef unsigned long long	_fp_math_uint;
+
+// pi / 2 and pi as 3.60 numbers
+static const _fp_math_int _fp_math_half_pi	= 0x1921FB54442D1847LL;
+static const _fp_math_int _fp_math_pi		= 0x3243F6A8885A308DLL;
+
+// 1 / (CORDIC gain) as a 3.60 number
+static const _fp_math_int _fp_math_cordic_k	= 0x09B74EDA8435E5A6LL;
+
+// (a * b) >> shift on the unsigned working type
+inline _fp_math_uint _fp_math_mul(_fp_math_uint a, _fp_math_uint b, count_type shift){
+	return _fp_wide_arith<_fp_math_uint>::mul_shift(a, b, shift);
+}
+
+// value * 2^exponent, rounded to nearest
+inline _fp_math_int _fp_math_shift(_fp_math_int value, int exponent){
+	if (exponent >= 0){
+		return exponent < 64 ? _fp_math_int(_fp_math_uint(value) << exponent) : 0;
+	}
+	if (exponent < -63){
+		return 0;
+	}
+	return ((value >> (-exponent - 1)) + 1) >> 1;
+}
+
+// atan(2^-i) as a 3.60 number, equal to 2^-i to within the precision from i = 20 on
+inline _fp_math_int _fp_math_atan(count_type i){
+	static const _fp_math_int table[20] = {
+		0x0C90FDAA22168C23LL, 0x076B19C1586ED3DALL, 0x03EB6EBF25901BACLL, 0x01FD5BA9AAC2F6DCLL,
+		0x00FFAADDB967EF4ELL, 0x007FF556EEA5D893LL, 0x003FFEAAB776E535LL, 0x001FFFD555BBBA97LL,
+		0x000FFFFAAAADDDDCLL, 0x0007FFFF55556EEFLL, 0x0003FFFFEAAAAB77LL, 0x0001FFFFFD55555CLL,
+		0x0000FFFFFFAAAAABLL, 0x00007FFFFFF55555LL, 0x00003FFFFFFEAAABLL, 0x00001FFFFFFFD555LL,
+		0x00000FFFFFFFFAABLL, 0x000007FFFFFFFF55LL, 0x000003FFFFFFFFEBLL, 0x000001FFFFFFFFFDLL
+	};
+	return i < 20 ? table[i] : _fp_math_int(1) << (60 - i);
+}
+
+// 2^(2^-k) as a 2.62 number, k >= 1, equal to 1 + ln(2) * 2^-k to within the precision from k = 32 on
+inline _fp_math_uint _fp_math_exp2(count_type k){
+	static const _fp_math_uint table[31] = {
+		0x5A827999FCEF3242ULL, 0x4C1BF828C6DC54B8ULL, 0x45CAE0F1F545EB73ULL, 0x42D561B3E6243D8AULL,
+		0x4166C34C5615D0ECULL, 0x40B268F9DE0183BAULL, 0x4058F6A7ECCCD5B6ULL, 0x402C6BE96AF2FB58ULL,
+		0x4016321B687027A8ULL, 0x400B18178BA33B14ULL, 0x40058BCE410147E8ULL, 0x4002C5D7BFF71DAFULL,
+		0x400162E807EE7E5BULL, 0x4000B1730DF6A524ULL, 0x400058B9497B8152ULL, 0x40002C5C955DD701ULL,
+		0x4000162E46D6F26CULL, 0x40000B1722757B1BULL, 0x4000058B90FD3E0CULL, 0x400002C5C86F3F26ULL,
+		0x40000162E433C79BULL, 0x400000B17218EDD0ULL, 0x40000058B90C3968ULL, 0x4000002C5C860D54ULL,
+		0x400000162E4302D2ULL, 0x4000000B17218073ULL, 0x400000058B90BFFCULL, 0x40000002C5C85FEFULL,
+		0x4000000162E42FF3ULL, 0x40000000B17217F9ULL, 0x4000000058B90BFCULL
+	};
+	const _fp_math_uint ln2 = 0x2C5C85FDF473DE6BULL;
+	return k <= 31 ? table[k - 1] : (_fp_math_uint(1) << 62) + (ln2 >> k);
+}
+
+// Normalizes a non-zero magnitude to a 2.62 number in [1, 4), with a left shift that makes (shift + fractional_bits) even
+inline int _fp_math_normalize(_fp_math_uint value, count_type fractional_bits, _fp_math_uint& normal){
+	int shift = 63 - int(_fp_bit_length(value));
+	if ((shift + fractional_bits) & 1){
+		++shift;
+	}
+	normal = shift >= 0 ? value << shift : value >> -shift;
+	return shift;
+}
+
+// 1 / sqrt(y) as a 1.63 number, for a 2.62 number y in [1, 4)
+inline _fp_math_uint _fp_math_rsqrt(_fp_math_uint y){
+	// Linear estimate 1.0625 - 0.15625 * y is within 13%, five Newton-Raphson iterations reach the full 64 bits
+	_fp_math_uint x = 0x8800000000000000ULL - _fp_math_mul(0x1400000000000000ULL, y, 62);
+	for (count_type i = 0; i < 5; i++){
+		// x = x * (3 - y * x^2) / 2
+		const _fp_math_uint t = _fp_math_mul(y, _fp_math_mul(x, x, 63), 62);
+		x = _fp_math_mul(x, 0xC000000000000000ULL - (t >> 1), 63);
+	}
+	return x;
+}
+
+// Whether root^2 > y * 2^64
+inline bool _fp_math_root_exceeds(_fp_math_uint root, _fp_math_uint y){
+	_fp_math_uint high, low;
+	_fp_wide_arith<_fp_math_uint>::mul_full(root, root, high, low);
+	return high > y || (high == y && low != 0);
+}
+
+// Rotates (1, 0) by a 3.60 angle in [-pi/2, pi/2], giving its cosine and sine as 3.60 numbers
+inline void _fp_math_rotate(_fp_math_int angle, count_type iterations, _fp_math_int& cosine, _fp_math_int& sine){
+	_fp_math_int x = _fp_math_cordic_k;
+	_fp_math_int y = 0;
+	for (count_type i = 0; i < iterations; i++){
+		const _fp_math_int dx = x >> i;
+		const _fp_math_int dy = y >> i;
+		if (angle >= 0){
+			x -= dy;
+			y += dx;
+			angle -= _fp_math_atan(i);
+		}else{
+			x += dy;
+			y -= dx;
+			angle += _fp_math_atan(i);
+		}
+	}
+	cosine = x;
+	sine = y;
+}
+
+// Rotates (x, y), x >= 0, onto the x axis, giving the 3.60 angle turned through.
+// Magnitudes must stay below 2^60 to leave room for the CORDIC gain
+inline _fp_math_int _fp_math_vector(_fp_math_int x, _fp_math_int y, count_type iterations){
+	_fp_math_int angle = 0;
+	for (count_type i = 0; i < iterations; i++){
+		const _fp_math_int dx = x >> i;
+		const _fp_math_int dy = y >> i;
+		if (y > 0){
+			x += dy;
+			y -= dx;
+			angle += _fp_math_atan(i);
+		}else{
+			x -= dy;
+			y += dx;
+			angle -= _fp_math_atan(i);
+		}
+	}
+	return angle;
+}
+
+// One CORDIC iteration per result bit, plus two for the accumulated rounding
+template<count_type FractionalBits>
+struct _fp_math_iterations{
+	static const count_type value = (FractionalBits + 2 < 61 ? FractionalBits + 2 : 61);
+};
+
+/// Square root
+/**
+ *	Exact to within rounding
+ *	@param x Non-negative value
+ *	@return sqrt(x), 0 if x is negative
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> fp_sqrt(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& x){
+	#ifdef FIXEDPOINT_CPP0X
+		static_assert(FractionalBits <= 62, "fp_sqrt supports at most 62 fractional bits");
+	#endif
+
+	const _fp_math_uint value = _fp_math_uint(x());
+	if (value == 0 || _fp_negative(x())){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (_fp_negative(x())){
+				_fp_event<FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(fp_event_domain, "fp_sqrt");
+			}
+		#endif
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(0));
+	}
+
+	_fp_math_uint y;
+	const int shift = _fp_math_normalize(value, FractionalBits, y);
+
+	// sqrt(y) as a 1.63 number, settled on floor(sqrt(y * 2^64))
+	_fp_math_uint root = _fp_math_mul(y, _fp_math_rsqrt(y), 62);
+	while (_fp_math_root_exceeds(root, y)){
+		--root;
+	}
+	while (root != ~_fp_math_uint(0) && !_fp_math_root_exceeds(root + 1, y)){
+		++root;
+	}
+
+	// x == y * 2^(62 - shift - FractionalBits), so sqrt(x) == sqrt(y) * 2^((62 - shift - FractionalBits) / 2)
+	const int half_exponent = (62 - shift - int(FractionalBits)) / 2;
+	const _fp_math_int result = _fp_math_shift(_fp_math_int(root >> 1), int(FractionalBits) + half_exponent - 62);
+	return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(result));
+}
+
+/// Reciprocal square root
+/**
+ *	@param x Positive value
+ *	@return 1 / sqrt(x), 0 if x is not positive
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> fp_rsqrt(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& x){
+	#ifdef FIXEDPOINT_CPP0X
+		static_assert(FractionalBits <= 62, "fp_rsqrt supports at most 62 fractional bits");
+	#endif
+
+	const _fp_math_uint value = _fp_math_uint(x());
+	if (value == 0 || _fp_negative(x())){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			_fp_event<FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(fp_event_domain, "fp_rsqrt");
+		#endif
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(0));
+	}
+
+	_fp_math_uint y;
+	const int shift = _fp_math_normalize(value, FractionalBits, y);
+
+	const int half_exponent = (62 - shift - int(FractionalBits)) / 2;
+	const _fp_math_int result = _fp_math_shift(_fp_math_int(_fp_math_rsqrt(y) >> 1), int(FractionalBits) - half_exponent - 62);
+	return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(result));
+}
+
+/// Base 2 exponential
+/**
+ *	@param x Exponent
+ *	@return 2^x
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> fp_exp2(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& x){
+	#ifdef FIXEDPOINT_CPP0X
+		static_assert(FractionalBits <= 62, "fp_exp2 supports at most 62 fractional bits");
+	#endif
+
+	const _fp_math_int value = _fp_math_int(x());
+	const _fp_math_int whole = value >> FractionalBits;
+	const _fp_math_uint fraction = _fp_math_uint(value) & ((_fp_math_uint(1) << FractionalBits) - 1);
+
+	// 2^fraction as a 2.62 number, multiplying in 2^(2^-k) for every set bit k of the fraction
+	_fp_math_uint power = _fp_math_uint(1) << 62;
+	for (count_type k = 1; k <= FractionalBits; k++){
+		if ((fraction >> (FractionalBits - k)) & 1){
+			power = _fp_math_mul(power, _fp_math_exp2(k), 62);
+		}
+	}
+
+	if (whole > 64 || whole < -128){
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(0));
+	}
+	const _fp_math_int result = _fp_math_shift(_fp_math_int(power), int(whole) + int(FractionalBits) - 62);
+	return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(result));
+}
+
+/// Base 2 logarithm
+/**
+ *	@param x Positive value
+ *	@return log2(x), 0 if x is not positive
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> fp_log2(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& x){
+	#ifdef FIXEDPOINT_CPP0X
+		static_assert(FractionalBits <= 61, "fp_log2 supports at most 61 fractional bits");
+	#endif
+
+	const _fp_math_uint value = _fp_math_uint(x());
+	if (value == 0 || _fp_negative(x())){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			_fp_event<FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(fp_event_domain, "fp_log2");
+		#endif
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(0));
+	}
+
+	// The integer part is the position of the highest bit, leaving a 2.62 number in [1, 2)
+	const int exponent = int(_fp_bit_length(value)) - 1;
+	_fp_math_uint normal = exponent <= 62 ? value << (62 - exponent) : value >> (exponent - 62);
+
+	// Squaring doubles the logarithm, so each time the square reaches 2 the next bit is set.
+	// One extra bit is computed for rounding
+	_fp_math_uint fraction = 0;
+	for (count_type i = 0; i <= FractionalBits; i++){
+		normal = _fp_math_mul(normal, normal, 62);
+		fraction <<= 1;
+		if (normal >> 63){
+			normal >>= 1;
+			fraction |= 1;
+		}
+	}
+
+	const _fp_math_int result = _fp_math_int(exponent - int(FractionalBits)) * (_fp_math_int(1) << FractionalBits) + _fp_math_int((fraction + 1) >> 1);
+	return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(result));
+}
+
+/// Sine and cosine of the same angle
+/**
+ *	@param angle Angle in radians
+ *	@param sine Set to sin(angle)
+ *	@param cosine Set to cos(angle)
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_sincos(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& angle, FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& sine, FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& cosine){
+	// Anything finer than the working format is dropped before the range reduction
+	const count_type input_shift = (FractionalBits > 60 ? FractionalBits - 60 : 0);
+	const count_type bits = FractionalBits - input_shift;
+
+	// Reduce to [0, pi/2). The quotient is estimated with pi/2 rounded to the precision of the angle,
+	// then the remainder is taken against the full 3.60 constant. It is small, so the low 64 bits
+	// of the difference are exact even where the operands wrap around
+	const _fp_math_uint magnitude = _fp_math_uint(_fp_magnitude(angle())) >> input_shift;
+	_fp_math_uint quadrant = magnitude / _fp_math_uint(_fp_math_shift(_fp_math_half_pi, int(bits) - 60));
+	_fp_math_int reduced = _fp_math_int((magnitude << (60 - bits)) - quadrant * _fp_math_uint(_fp_math_half_pi));
+	while (reduced < 0){
+		reduced += _fp_math_half_pi;
+		--quadrant;
+	}
+	while (reduced >= _fp_math_half_pi){
+		reduced -= _fp_math_half_pi;
+		++quadrant;
+	}
+
+	_fp_math_int c, s;
+	_fp_math_rotate(reduced, _fp_math_iterations<FractionalBits>::value, c, s);
+
+	_fp_math_int result_sine, result_cosine;
+	switch (quadrant & 3){
+		case 0:	result_sine = s;	result_cosine = c;	break;
+		case 1:	result_sine = c;	result_cosine = -s;	break;
+		case 2:	result_sine = -s;	result_cosine = -c;	break;
+		default:result_sine = -c;	result_cosine = s;	break;
+	}
+	if (_fp_negative(angle())){
+		result_sine = -result_sine;
+	}
+
+	sine = FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(_fp_math_shift(result_sine, int(FractionalBits) - 60)));
+	cosine = FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(_fp_math_shift(result_cosine, int(FractionalBits) - 60)));
+}
+
+/// Sine
+/**
+ *	@param angle Angle in radians
+ *	@return sin(angle)
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> fp_sin(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& angle){
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> sine, cosine;
+	fp_sincos(angle, sine, cosine);
+	return sine;
+}
+
+/// Cosine
+/**
+ *	@param angle Angle in radians
+ *	@return cos(angle)
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> fp_cos(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& angle){
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> sine, cosine;
+	fp_sincos(angle, sine, cosine);
+	return cosine;
+}
+
+/// Angle of the vector (x, y)
+/**
+ *	The format needs at least two integer bits (three if signed) to hold the full range
+ *	@param y Vertical component
+ *	@param x Horizontal component
+ *	@return atan2(y, x) in radians, in [-pi, pi]
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> fp_atan2(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& y, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& x){
+	const _fp_math_uint x_magnitude = _fp_magnitude(x());
+	const _fp_math_uint y_magnitude = _fp_magnitude(y());
+	const _fp_math_uint larger = (x_magnitude > y_magnitude ? x_magnitude : y_magnitude);
+	if (larger == 0){
+		return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(0));
+	}
+
+	// Only the ratio matters, so scale both until the larger one is just below 2^60
+	const int shift = 60 - int(_fp_bit_length(larger));
+	const _fp_math_int x_scaled = _fp_math_int(shift >= 0 ? x_magnitude << shift : x_magnitude >> -shift);
+	const _fp_math_int y_scaled = _fp_math_int(shift >= 0 ? y_magnitude << shift : y_magnitude >> -shift);
+
+	_fp_math_int result = _fp_math_vector(x_scaled, y_scaled, _fp_math_iterations<FractionalBits>::value);
+	if (_fp_negative(x())){
+		result = _fp_math_pi - result;
+	}
+	if (_fp_negative(y())){
+		result = -result;
+	}
+
+	return FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(IntegerType(_fp_math_shift(result, int(FractionalBits) - 60)));
+}
+
+#endif//H_FP_MATH
@@ -0,0 +1,504 @@
+/**
+ *	@file fp_matrix.h
+ *	Adds dot products and matrix multiplication over arrays of FixedPoints
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_MATRIX
+#define H_FP_MATRIX
+
+#include <cstddef>
+
+#include "fp_array.h"
+
+#ifdef FIXEDPOINT_CPP0X
+	#include <thread>
+	#include <vector>
+#endif
+
+// Add the following line to your code before any #include "fp_*.h"
+// to change how many columns of the right matrix fp_gemm packs together. A block of a packed panel,
+// that many columns by FIXEDPOINT_GEMM_DEPTH of the inner dimension, should stay in the level 2 cache
+//#define FIXEDPOINT_GEMM_PANEL 64
+#ifndef FIXEDPOINT_GEMM_PANEL
+	#define FIXEDPOINT_GEMM_PANEL 64
+#endif
+
+// Add the following lines to your code before any #include "fp_*.h"
+// to change how fp_gemm blocks the inner dimension and the rows of the left matrix. A panel is multiplied
+// by FIXEDPOINT_GEMM_DEPTH elements of the inner dimension at a time, however deep the matrices are,
+// while the sums of FIXEDPOINT_GEMM_ROWS rows by the panel are kept
+//#define FIXEDPOINT_GEMM_DEPTH 1024
+//#define FIXEDPOINT_GEMM_ROWS 128
+#ifndef FIXEDPOINT_GEMM_DEPTH
+	#define FIXEDPOINT_GEMM_DEPTH 1024
+#endif
+#ifndef FIXEDPOINT_GEMM_ROWS
+	#define FIXEDPOINT_GEMM_ROWS 128
+#endif
+
+// Dot product kernels on raw content. They add full products to _fp_accumulator without rescaling, so every
+// kernel gives the same sums as the scalar loop. dot4 multiplies a by four columns at once, column j starting
+// at b + j * stride, so that each element of a is loaded once for all four
+template<typename IntegerType>
+struct _fp_dot_scalar{
+	typedef _fp_accumulator<IntegerType> accumulator_type;
+
+	static void dot(const IntegerType* a, const IntegerType* b, size_t count, accumulator_type& accumulator){
+		for (size_t i = 0; i < count; i++){
+			accumulator.template mul_add<false>(a[i], b[i]);
+		}
+	}
+
+	static void dot4(const IntegerType* a, const IntegerType* b, size_t stride, size_t count, accumulator_type* accumulators){
+		for (size_t i = 0; i < count; i++){
+			const IntegerType value = a[i];
+			accumulators[0].template mul_add<false>(value, b[i]);
+			accumulators[1].template mul_add<false>(value, b[stride + i]);
+			accumulators[2].template mul_add<false>(value, b[2 * stride + i]);
+			accumulators[3].template mul_add<false>(value, b[3 * stride + i]);
+		}
+	}
+};
+
+template<typename IntegerType>
+struct _fp_dot_kernel : _fp_dot_scalar<IntegerType>{};
+
+#ifdef FIXEDPOINT_SSE2
+	// Adds the 32 bit sums of pmaddwd to the 64 bit lanes of sum.
+	// Only -32768 * -32768 twice exceeds 32 bits, it reads as INT_MIN and is widened to 2^31 instead
+	inline __m128i _fp_dot_widen(__m128i sum, __m128i pairs){
+		const __m128i high = _mm_andnot_si128(_mm_cmpeq_epi32(pairs, _mm_set1_epi32(INT_MIN)), _mm_srai_epi32(pairs, 31));
+		sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(pairs, high));
+		return _mm_add_epi64(sum, _mm_unpackhi_epi32(pairs, high));
+	}
+
+	#ifdef FIXEDPOINT_AVX2
+		FIXEDPOINT_AVX2_TARGET
+		inline __m256i _fp_dot_widen(__m256i sum, __m256i pairs){
+			const __m256i high = _mm256_andnot_si256(_mm256_cmpeq_epi32(pairs, _mm256_set1_epi32(INT_MIN)), _mm256_srai_epi32(pairs, 31));
+			sum = _mm256_add_epi64(sum, _mm256_unpacklo_epi32(pairs, high));
+			return _mm256_add_epi64(sum, _mm256_unpackhi_epi32(pairs, high));
+		}
+	#endif
+
+	// Lanes add step elements of products into the 64 bit lanes of a vector sum, step256 with AVX2.
+	// 8 and signed 16 bit content is multiplied and added in pairs by pmaddwd, after widening 8 bit content to 16 bits.
+	// pmaddubsw is not used, it saturates and needs one unsigned operand
+	template<typename IntegerType>
+	struct _fp_dot_lanes;
+
+	template<>
+	struct _fp_dot_lanes<short int>{
+		static const size_t step = 8;
+		static const size_t step256 = 16;
+
+		static __m128i add(__m128i sum, const short int* a, const short int* b){
+			return _fp_dot_widen(sum, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b))));
+		}
+
+		#ifdef FIXEDPOINT_AVX2
+			FIXEDPOINT_AVX2_TARGET
+			static __m256i add(__m256i sum, const short int* a, const short int* b){
+				return _fp_dot_widen(sum, _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b))));
+			}
+		#endif
+	};
+
+	// No unsigned pmaddwd, the 32 bit products are rebuilt from their halves (pmullw and pmulhuw)
+	template<>
+	struct _fp_dot_lanes<unsigned short int>{
+		static const size_t step = 8;
+		static const size_t step256 = 16;
+
+		static __m128i add(__m128i sum, const unsigned short int* a, const unsigned short int* b){
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+			const __m128i low = _mm_mullo_epi16(va, vb);
+			const __m128i high = _mm_mulhi_epu16(va, vb);
+			const __m128i zero = _mm_setzero_si128();
+
+			const __m128i first = _mm_unpacklo_epi16(low, high);
+			const __m128i second = _mm_unpackhi_epi16(low, high);
+			sum = _mm_add_epi64(sum, _mm_add_epi64(_mm_unpacklo_epi32(first, zero), _mm_unpackhi_epi32(first, zero)));
+			return _mm_add_epi64(sum, _mm_add_epi64(_mm_unpacklo_epi32(second, zero), _mm_unpackhi_epi32(second, zero)));
+		}
+
+		#ifdef FIXEDPOINT_AVX2
+			FIXEDPOINT_AVX2_TARGET
+			static __m256i add(__m256i sum, const unsigned short int* a, const unsigned short int* b){
+				const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+				const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+				const __m256i low = _mm256_mullo_epi16(va, vb);
+				const __m256i high = _mm256_mulhi_epu16(va, vb);
+				const __m256i zero = _mm256_setzero_si256();
+
+				// Unpacking works within each 128 bit half, which only reorders the products of the sum
+				const __m256i first = _mm256_unpacklo_epi16(low, high);
+				const __m256i second = _mm256_unpackhi_epi16(low, high);
+				sum = _mm256_add_epi64(sum, _mm256_add_epi64(_mm256_unpacklo_epi32(first, zero), _mm256_unpackhi_epi32(first, zero)));
+				return _mm256_add_epi64(sum, _mm256_add_epi64(_mm256_unpacklo_epi32(second, zero), _mm256_unpackhi_epi32(second, zero)));
+			}
+		#endif
+	};
+
+	template<>
+	struct _fp_dot_lanes<signed char>{
+		static const size_t step = 16;
+		static const size_t step256 = 16;
+
+		static __m128i add(__m128i sum, const signed char* a, const signed char* b){
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+
+			// Sign extended by placing each byte in the high half and shifting it back
+			sum = _fp_dot_widen(sum, _mm_madd_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8), _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8)));
+			return _fp_dot_widen(sum, _mm_madd_epi16(_mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8), _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8)));
+		}
+
+		#ifdef FIXEDPOINT_AVX2
+			FIXEDPOINT_AVX2_TARGET
+			static __m256i add(__m256i sum, const signed char* a, const signed char* b){
+				const __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)));
+				const __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+				return _fp_dot_widen(sum, _mm256_madd_epi16(va, vb));
+			}
+		#endif
+	};
+
+	template<>
+	struct _fp_dot_lanes<unsigned char>{
+		static const size_t step = 16;
+		static const size_t step256 = 16;
+
+		static __m128i add(__m128i sum, const unsigned char* a, const unsigned char* b){
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+			const __m128i zero = _mm_setzero_si128();
+
+			// Zero extended bytes are positive 16 bit values, and their pair sums fit in 32 bits
+			sum = _fp_dot_widen(sum, _mm_madd_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero)));
+			return _fp_dot_widen(sum, _mm_madd_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero)));
+		}
+
+		#ifdef FIXEDPOINT_AVX2
+			FIXEDPOINT_AVX2_TARGET
+			static __m256i add(__m256i sum, const unsigned char* a, const unsigned char* b){
+				const __m256i va = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)));
+				const __m256i vb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+				return _fp_dot_widen(sum, _mm256_madd_epi16(va, vb));
+			}
+		#endif
+	};
+
+	// 32 bit content, even and odd lanes are multiplied into 64 bit products as in _fp_batch_kernel32
+	template<typename IntegerType, bool _Signed>
+	struct _fp_dot_lanes32{
+		static const size_t step = 4;
+		static const size_t step256 = 8;
+
+		static __m128i add(__m128i sum, const IntegerType* a, const IntegerType* b){
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+
+			__m128i even = _mm_mul_epu32(va, vb);
+			__m128i odd = _mm_mul_epu32(_mm_srli_epi64(va, 32), _mm_srli_epi64(vb, 32));
+			if (_Signed){
+				const __m128i correction = _mm_add_epi32(_mm_and_si128(_mm_srai_epi32(va, 31), vb), _mm_and_si128(_mm_srai_epi32(vb, 31), va));
+				even = _mm_sub_epi64(even, _mm_slli_epi64(correction, 32));
+				odd = _mm_sub_epi64(odd, _mm_andnot_si128(_mm_set_epi32(0, -1, 0, -1), correction));
+			}
+			return _mm_add_epi64(sum, _mm_add_epi64(even, odd));
+		}
+
+		#ifdef FIXEDPOINT_AVX2
+			FIXEDPOINT_AVX2_TARGET
+			static __m256i add(__m256i sum, const IntegerType* a, const IntegerType* b){
+				const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+				const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+				const __m256i va_odd = _mm256_srli_epi64(va, 32);
+				const __m256i vb_odd = _mm256_srli_epi64(vb, 32);
+
+				const __m256i even = _Signed ? _mm256_mul_epi32(va, vb) : _mm256_mul_epu32(va, vb);
+				const __m256i odd = _Signed ? _mm256_mul_epi32(va_odd, vb_odd) : _mm256_mul_epu32(va_odd, vb_odd);
+				return _mm256_add_epi64(sum, _mm256_add_epi64(even, odd));
+			}
+		#endif
+	};
+
+	template<>
+	struct _fp_dot_lanes<int> : _fp_dot_lanes32<int, true>{};
+
+	template<>
+	struct _fp_dot_lanes<unsigned int> : _fp_dot_lanes32<unsigned int, false>{};
+
+	template<typename IntegerType>
+	struct _fp_dot_vector : _fp_dot_scalar<IntegerType>{
+		typedef _fp_dot_lanes<IntegerType> lanes;
+		typedef typename _fp_dot_scalar<IntegerType>::accumulator_type accumulator_type;
+		typedef typename accumulator_type::sum_type sum_type;
+
+		// Added as unsigned, the lanes wrap like the accumulator
+		static sum_type _total(__m128i sum){
+			typedef typename accumulator_type::sum_unsigned_type sum_unsigned_type;
+			sum_type lanes[2];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+			return sum_type(sum_unsigned_type(lanes[0]) + sum_unsigned_type(lanes[1]));
+		}
+
+		#ifdef FIXEDPOINT_AVX2
+			FIXEDPOINT_AVX2_TARGET
+			static sum_type _total(__m256i sum){
+				return _total(_mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+			}
+
+			FIXEDPOINT_AVX2_TARGET
+			static size_t _dot_avx2(const IntegerType* a, const IntegerType* b, size_t count, accumulator_type& accumulator){
+				__m256i sum = _mm256_setzero_si256();
+				size_t i = 0;
+				for (; i + lanes::step256 <= count; i += lanes::step256){
+					sum = lanes::add(sum, a + i, b + i);
+				}
+				accumulator.add_sum(_total(sum));
+				return i;
+			}
+
+			FIXEDPOINT_AVX2_TARGET
+			static size_t _dot4_avx2(const IntegerType* a, const IntegerType* b, size_t stride, size_t count, accumulator_type* accumulators){
+				__m256i sum0 = _mm256_setzero_si256(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+				size_t i = 0;
+				for (; i + lanes::step256 <= count; i += lanes::step256){
+					sum0 = lanes::add(sum0, a + i, b + i);
+					sum1 = lanes::add(sum1, a + i, b + stride + i);
+					sum2 = lanes::add(sum2, a + i, b + 2 * stride + i);
+					sum3 = lanes::add(sum3, a + i, b + 3 * stride + i);
+				}
+				accumulators[0].add_sum(_total(sum0));
+				accumulators[1].add_sum(_total(sum1));
+				accumulators[2].add_sum(_total(sum2));
+				accumulators[3].add_sum(_total(sum3));
+				return i;
+			}
+		#endif
+
+		static void dot(const IntegerType* a, const IntegerType* b, size_t count, accumulator_type& accumulator){
+			size_t i = 0;
+			#ifdef FIXEDPOINT_AVX2
+				if (_fp_has_avx2()){
+					i = _dot_avx2(a, b, count, accumulator);
+				}
+			#endif
+			// Bounded by a multiple of step, which the AVX2 loop stops at too, so that i + step cannot seem to wrap
+			const size_t end = count - count % lanes::step;
+			__m128i sum = _mm_setzero_si128();
+			for (; i < end; i += lanes::step){
+				sum = lanes::add(sum, a + i, b + i);
+			}
+			accumulator.add_sum(_total(sum));
+
+			_fp_dot_scalar<IntegerType>::dot(a + i, b + i, count - i, accumulator);
+		}
+
+		static void dot4(const IntegerType* a, const IntegerType* b, size_t stride, size_t count, accumulator_type* accumulators){
+			size_t i = 0;
+			#ifdef FIXEDPOINT_AVX2
+				if (_fp_has_avx2()){
+					i = _dot4_avx2(a, b, stride, count, accumulators);
+				}
+			#endif
+			const size_t end = count - count % lanes::step;
+			__m128i sum0 = _mm_setzero_si128(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+			for (; i < end; i += lanes::step){
+				sum0 = lanes::add(sum0, a + i, b + i);
+				sum1 = lanes::add(sum1, a + i, b + stride + i);
+				sum2 = lanes::add(sum2, a + i, b + 2 * stride + i);
+				sum3 = lanes::add(sum3, a + i, b + 3 * stride + i);
+			}
+			accumulators[0].add_sum(_total(sum0));
+			accumulators[1].add_sum(_total(sum1));
+			accumulators[2].add_sum(_total(sum2));
+			accumulators[3].add_sum(_total(sum3));
+
+			_fp_dot_scalar<IntegerType>::dot4(a + i, b + i, stride, count - i, accumulators);
+		}
+	};
+
+	template<>
+	struct _fp_dot_kernel<signed char> : _fp_dot_vector<signed char>{};
+
+	template<>
+	struct _fp_dot_kernel<unsigned char> : _fp_dot_vector<unsigned char>{};
+
+	template<>
+	struct _fp_dot_kernel<short int> : _fp_dot_vector<short int>{};
+
+	template<>
+	struct _fp_dot_kernel<unsigned short int> : _fp_dot_vector<unsigned short int>{};
+
+	template<>
+	struct _fp_dot_kernel<int> : _fp_dot_vector<int>{};
+
+	template<>
+	struct _fp_dot_kernel<unsigned int> : _fp_dot_vector<unsigned int>{};
+#endif
+
+/// Dot product of two arrays of FixedPoints
+/**
+ *	The full products are summed in an accumulator of at least 64 bits and rescaled once,
+ *	through the rounding policy and then the overflow policy
+ *	@param a First array
+ *	@param b Second array
+ *	@param count Number of elements in each array
+ *	@return Sum of a[i] * b[i]
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> fp_dot(const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* a, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* b, size_t count){
+	_fp_accumulator<IntegerType> accumulator;
+	_fp_dot_kernel<IntegerType>::dot(_fp_raw(a), _fp_raw(b), count, accumulator);
+
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> result;
+	_fp_accumulated(result, accumulator, FractionalBits, "fp_dot");
+	return result;
+}
+
+// Packs the columns of b as rows, so the kernels read both operands in order. Column j starts at j * inner
+template<typename IntegerType>
+IntegerType* _fp_gemm_pack(const IntegerType* b, size_t inner, size_t columns){
+	IntegerType* const packed = static_cast<IntegerType*>(_fp_aligned_alloc(columns * inner * sizeof(IntegerType) + 1));
+	for (size_t column = 0; column < columns; column += FIXEDPOINT_GEMM_PANEL){
+		const size_t width = columns - column < FIXEDPOINT_GEMM_PANEL ? columns - column : FIXEDPOINT_GEMM_PANEL;
+		for (size_t k = 0; k < inner; k++){
+			for (size_t j = 0; j < width; j++){
+				packed[(column + j) * inner + k] = b[k * columns + column + j];
+			}
+		}
+	}
+	return packed;
+}
+
+// Multiplies rows of a by the packed columns of b into out, by panels of columns, blocks of rows and blocks of the inner dimension.
+// The sums of a block of outputs are kept across the blocks of the inner dimension and rescaled once, so blocking does not change them
+template<typename IntegerType, typename OutType>
+void _fp_gemm_rows(OutType* out, const IntegerType* a, const IntegerType* packed, size_t rows, size_t inner, size_t columns, count_type shift){
+	typedef _fp_dot_kernel<IntegerType> kernel;
+	typedef _fp_accumulator<IntegerType> accumulator_type;
+
+	accumulator_type* const accumulators = static_cast<accumulator_type*>(_fp_aligned_alloc(FIXEDPOINT_GEMM_ROWS * FIXEDPOINT_GEMM_PANEL * sizeof(accumulator_type)));
+
+	for (size_t column = 0; column < columns; column += FIXEDPOINT_GEMM_PANEL){
+		const size_t width = columns - column < FIXEDPOINT_GEMM_PANEL ? columns - column : FIXEDPOINT_GEMM_PANEL;
+		const IntegerType* const panel = packed + column * inner;
+
+		for (size_t first = 0; first < rows; first += FIXEDPOINT_GEMM_ROWS){
+			const size_t height = rows - first < FIXEDPOINT_GEMM_ROWS ? rows - first : FIXEDPOINT_GEMM_ROWS;
+			for (size_t i = 0; i < height * width; i++){
+				accumulators[i] = accumulator_type();
+			}
+
+			for (size_t depth = 0; depth < inner; depth += FIXEDPOINT_GEMM_DEPTH){
+				const size_t count = inner - depth < FIXEDPOINT_GEMM_DEPTH ? inner - depth : FIXEDPOINT_GEMM_DEPTH;
+				for (size_t row = 0; row < height; row++){
+					// Each row of a is multiplied by four packed columns at once
+					const IntegerType* const a_row = a + (first + row) * inner + depth;
+					accumulator_type* const sums = accumulators + row * width;
+					size_t j = 0;
+					for (; j + 4 <= width; j += 4){
+						kernel::dot4(a_row, panel + j * inner + depth, inner, count, sums + j);
+					}
+					for (; j < width; j++){
+						kernel::dot(a_row, panel + j * inner + depth, count, sums[j]);
+					}
+				}
+			}
+
+			for (size_t row = 0; row < height; row++){
+				OutType* const out_row = out + (first + row) * columns + column;
+				for (size_t j = 0; j < width; j++){
+					_fp_accumulated(out_row[j], accumulators[row * width + j], shift, "fp_gemm");
+				}
+			}
+		}
+	}
+
+	_fp_aligned_free(accumulators);
+}
+
+/// Multiplies two row-major matrices of FixedPoints
+/**
+ *	out = a * b, with a of rows x inner, b of inner x columns, and out of rows x columns elements.
+ *	Every output is a dot product summed as by fp_dot, then rescaled into the format of out, which needs at most
+ *	twice the fractional bits of a and b, e.g. Q7 inputs can give Q7 or Q14 outputs.
+ *	The columns of b are packed once, then multiplied by panels of FIXEDPOINT_GEMM_PANEL columns, in blocks of FIXEDPOINT_GEMM_ROWS rows
+ *	of a and FIXEDPOINT_GEMM_DEPTH of the inner dimension, each row of a by four packed columns at once.
+ *	out must not overlap a or b
+ *	@param out Matrix receiving the product
+ *	@param a Left matrix
+ *	@param b Right matrix
+ *	@param rows Number of rows of a and out
+ *	@param inner Number of columns of a and rows of b
+ *	@param columns Number of columns of b and out
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy, typename OutIntegerType, count_type OutIntegerBits, count_type OutFractionalBits, typename OutOverflowPolicy>
+void fp_gemm(FixedPoint<OutIntegerType, OutIntegerBits, OutFractionalBits, OutOverflowPolicy>* out, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* a, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* b, size_t rows, size_t inner, size_t columns){
+	#ifdef FIXEDPOINT_CPP0X
+		static_assert(OutFractionalBits <= 2 * FractionalBits, "The product has fewer fractional bits than the output format");
+	#endif
+	if (!rows || !columns){
+		return;
+	}
+
+	IntegerType* const packed = _fp_gemm_pack(_fp_raw(b), inner, columns);
+	_fp_gemm_rows(out, _fp_raw(a), packed, rows, inner, columns, count_type(2 * FractionalBits - OutFractionalBits));
+	_fp_aligned_free(packed);
+}
+
+/// Multiplies two row-major matrices of FixedPoints on several threads
+/**
+ *	As fp_gemm, with the rows of out split evenly between threads. The columns of b are packed once, before the threads start, and shared by them.
+ *	Without C++11 threads, runs fp_gemm on the calling thread
+ *	@param out Matrix receiving the product
+ *	@param a Left matrix
+ *	@param b Right matrix
+ *	@param rows Number of rows of a and out
+ *	@param inner Number of columns of a and rows of b
+ *	@param columns Number of columns of b and out
+ *	@param threads Number of threads, 0 for one per hardware thread
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy, typename OutIntegerType, count_type OutIntegerBits, count_type OutFractionalBits, typename OutOverflowPolicy>
+void fp_gemm_parallel(FixedPoint<OutIntegerType, OutIntegerBits, OutFractionalBits, OutOverflowPolicy>* out, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* a, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>* b, size_t rows, size_t inner, size_t columns, unsigned int threads = 0){
+	#ifdef FIXEDPOINT_CPP0X
+		if (!threads){
+			threads = std::thread::hardware_concurrency();
+		}
+		if (size_t(threads) > rows){
+			threads = unsigned(rows);
+		}
+		if (threads <= 1){
+			fp_gemm(out, a, b, rows, inner, columns);
+			return;
+		}
+
+		const IntegerType* const raw_a = _fp_raw(a);
+		IntegerType* const packed = _fp_gemm_pack(_fp_raw(b), inner, columns);
+		const count_type shift = count_type(2 * FractionalBits - OutFractionalBits);
+
+		std::vector<std::thread> workers;
+		workers.reserve(threads);
+		for (unsigned int t = 0; t < threads; t++){
+			const size_t begin = rows * t / threads;
+			const size_t end = rows * (t + 1) / threads;
+			workers.push_back(std::thread([=](){
+				_fp_gemm_rows(out + begin * columns, raw_a + begin * inner, packed, end - begin, inner, columns, shift);
+			}));
+		}
+		for (size_t t = 0; t < workers.size(); t++){
+			workers[t].join();
+		}
+		_fp_aligned_free(packed);
+	#else
+		(void)threads;
+		fp_gemm(out, a, b, rows, inner, columns);
+	#endif
+}
+
+#endif//H_FP_MATRIX
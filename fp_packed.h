@@ -0,0 +1,514 @@
+/**
+ *	@file fp_packed.h
+ *	Adds arrays of FixedPoints stored with only the bits their format uses
+ *	Not included by fp_types.h, add it individually where needed
+ */
+
+#ifndef H_FP_PACKED
+#define H_FP_PACKED
+
+#include <cstddef>
+#include <cstring>
+
+#include "fp_array.h"
+
+// Add the following line to your code before any #include "fp_*.h"
+// to change how many values the arithmetic on packed arrays unpacks at a time. The buffers
+// live on the stack, so keep three blocks of the content type well within it
+//#define FIXEDPOINT_PACKED_BLOCK 256
+#ifndef FIXEDPOINT_PACKED_BLOCK
+	#define FIXEDPOINT_PACKED_BLOCK 256
+#endif
+
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+	#define FIXEDPOINT_LITTLE_ENDIAN
+#endif
+
+// Packed storage is a little endian bit stream, read and written 64 or 32 bits at a time
+inline unsigned long long int _fp_packed_load(const unsigned char* bytes){
+	#ifdef FIXEDPOINT_LITTLE_ENDIAN
+		unsigned long long int word;
+		std::memcpy(&word, bytes, sizeof(word));
+		return word;
+	#else
+		unsigned long long int word = 0;
+		for (size_t i = 8; i--;){
+			word = (word << 8) | bytes[i];
+		}
+		return word;
+	#endif
+}
+
+inline void _fp_packed_store(unsigned char* bytes, unsigned long long int word){
+	#ifdef FIXEDPOINT_LITTLE_ENDIAN
+		std::memcpy(bytes, &word, sizeof(word));
+	#else
+		for (size_t i = 0; i < 8; i++, word >>= 8){
+			bytes[i] = static_cast<unsigned char>(word);
+		}
+	#endif
+}
+
+inline void _fp_packed_store32(unsigned char* bytes, unsigned long long int word){
+	#ifdef FIXEDPOINT_LITTLE_ENDIAN
+		const unsigned int low = static_cast<unsigned int>(word);
+		std::memcpy(bytes, &low, 4);
+	#else
+		for (size_t i = 0; i < 4; i++, word >>= 8){
+			bytes[i] = static_cast<unsigned char>(word);
+		}
+	#endif
+}
+
+///	An array of FixedPoints that stores IntegerBits + FractionalBits bits per value, plus one for the sign if IntegerType is signed
+/**
+ *	e.g. Q4.8 values in unsigned short take 12 bits instead of 16. Values are packed one after the other into a little endian bit stream,
+ *	so the storage can be written to a file and read back on any platform.
+ *	Values are read and written one at a time with get and set, or a range at a time with unpack and pack, which use AVX2 byte shuffles
+ *	for widths of up to 16 bits in 16 bit content and up to 25 bits in 32 bit content. Values that need more bits than
+ *	the packed width are settled by the overflow policy: fp_wrap keeps the low bits, fp_saturate clamps to the packed range and fp_trap traps.
+ *	set and pack read and write the bytes around the values they change, so two threads must not write neighbouring values at the same time
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits = std::numeric_limits<IntegerType>::digits - IntegerBits, typename OverflowPolicy = fp_wrap>
+class FixedPointPacked{
+public:
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	typedef FixedPointView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> view_type;
+	typedef FixedPointConstView<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> const_view_type;
+
+	/// Number of bits of each packed value
+	static const count_type bits = IntegerBits + FractionalBits + std::numeric_limits<IntegerType>::is_signed;
+
+private:
+	typedef typename _fp_int_traits<IntegerType>::unsigned_type unsigned_type;
+
+	static const bool _signed = std::numeric_limits<IntegerType>::is_signed;
+	// Vector loops read up to 32 bytes from where the values of a block start
+	static const size_t _padding = 32;
+
+	#ifdef FIXEDPOINT_CPP0X
+		static_assert(bits <= 64, "Packed values must fit in 64 bits");
+	#endif
+
+	unsigned char* _bytes;
+	size_t _size;
+
+	static unsigned long long int _mask(){
+		return bits < 64 ? (1ULL << (bits % 64)) - 1 : ~0ULL;
+	}
+
+	// Reads the value starting at bit, sign extended
+	static IntegerType _read(const unsigned char* bytes, size_t bit){
+		const unsigned char* const first = bytes + bit / 8;
+		const count_type shift = count_type(bit % 8);
+		unsigned long long int word = _fp_packed_load(first) >> shift;
+		if (bits + shift > 64){
+			word |= static_cast<unsigned long long int>(first[8]) << (64 - shift);
+		}
+		word &= _mask();
+		if (_signed && bits < 64 && (word >> (bits - 1)) != 0){
+			word |= ~_mask();
+		}
+		return IntegerType(unsigned_type(word));
+	}
+
+	// Writes the low bits of value at bit, keeping the bits around it
+	static void _write(unsigned char* bytes, size_t bit, unsigned long long int value){
+		unsigned char* const first = bytes + bit / 8;
+		const count_type shift = count_type(bit % 8);
+		const unsigned long long int word = _fp_packed_load(first);
+		_fp_packed_store(first, (word & ~(_mask() << shift)) | (value << shift));
+		if (bits + shift > 64){
+			const unsigned char high = static_cast<unsigned char>(_mask() >> (64 - shift));
+			first[8] = static_cast<unsigned char>((first[8] & ~high) | (value >> (64 - shift)));
+		}
+	}
+
+	// The content as it is stored, after the overflow policy if it needs more than bits bits
+	static unsigned long long int _encode(IntegerType content){
+		const unsigned long long int raw = static_cast<unsigned long long int>(unsigned_type(content)) & _mask();
+		if (bits >= std::numeric_limits<unsigned_type>::digits){
+			return raw;
+		}
+
+		// The content fits if reading back the low bits gives it again
+		const unsigned long long int extended = _signed && (raw >> (bits - 1)) != 0 ? raw | ~_mask() : raw;
+		if (extended == static_cast<unsigned long long int>(static_cast<long long int>(content))){
+			return raw;
+		}
+
+		const bool negative = _fp_negative(content);
+
+		#ifdef FIXEDPOINT_INSTRUMENT
+			_fp_event<value_type>(negative ? fp_event_underflow : fp_event_overflow, "FixedPointPacked");
+		#endif
+		// A policy that replaces an overflowing result stands for the limit of the packed range. It is asked about zero,
+		// which no policy keeps as its limit, since asking about the content itself misreads a content at the IntegerType limit
+		if (OverflowPolicy::fit(IntegerType(0), true, negative) == 0){
+			return raw;
+		}
+		if (!_signed){
+			return _mask();
+		}
+		return negative ? (_mask() >> 1) + 1 : _mask() >> 1;
+	}
+
+	void _allocate(size_t size){
+		_size = size;
+		_bytes = static_cast<unsigned char*>(_fp_aligned_alloc(storage_size() + _padding));
+		std::memset(_bytes, 0, storage_size() + _padding);
+	}
+
+	#ifdef FIXEDPOINT_AVX2
+		// Unpacks count values (a multiple of 8) of at most 25 bits that start on a byte into 16 or 32 bit content.
+		// Each 128 bit half holds the bytes of 4 values, which are shuffled into one 32 bit lane each, shifted to their bit offset and sign extended
+		FIXEDPOINT_AVX2_TARGET
+		static void _unpack_avx2(IntegerType* out, const unsigned char* bytes, size_t count){
+			unsigned char control[32];
+			int shifts[8];
+			for (size_t k = 0; k < 8; k++){
+				const size_t base = (k / 4) * ((4 * bits) / 8);
+				const size_t start = (k * bits) / 8 - base;
+				for (size_t b = 0; b < 4; b++){
+					control[(k / 4) * 16 + (k % 4) * 4 + b] = static_cast<unsigned char>(start + b);
+				}
+				shifts[k] = int((k * bits) % 8);
+			}
+			const __m256i vcontrol = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(control));
+			const __m256i vshifts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(shifts));
+			const __m256i mask = _mm256_set1_epi32(int(_mask()));
+			const __m128i extend = _mm_cvtsi32_si128(32 - bits);
+			const size_t high = (4 * bits) / 8;
+
+			for (size_t i = 0; i < count; i += 8){
+				const unsigned char* const block = bytes + i / 8 * bits;
+				const __m128i low_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+				const __m128i high_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + high));
+
+				__m256i values = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(low_bytes), high_bytes, 1), vcontrol);
+				values = _mm256_srlv_epi32(values, vshifts);
+				values = _signed ? _mm256_sra_epi32(_mm256_sll_epi32(values, extend), extend) : _mm256_and_si256(values, mask);
+
+				if (sizeof(IntegerType) == 4){
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), values);
+				}else{
+					const __m128i low = _mm256_castsi256_si128(values);
+					const __m128i high_values = _mm256_extracti128_si256(values, 1);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _signed ? _mm_packs_epi32(low, high_values) : _mm_packus_epi32(low, high_values));
+				}
+			}
+		}
+	#endif
+
+public:
+	/// Empty array
+	FixedPointPacked(){
+		_allocate(0);
+	}
+
+	/// Array of zeros
+	/**
+	 *	@param size Number of values
+	 */
+	explicit FixedPointPacked(size_t size){
+		_allocate(size);
+	}
+
+	/// Array packed from a view
+	/**
+	 *	@param values Values to pack
+	 */
+	explicit FixedPointPacked(const const_view_type& values){
+		_allocate(values.size());
+		pack(values.data(), 0, values.size());
+	}
+
+	FixedPointPacked(const FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+		_allocate(other._size);
+		std::memcpy(_bytes, other._bytes, storage_size());
+	}
+
+	#ifdef FIXEDPOINT_CPP0X
+		FixedPointPacked(FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>&& other){
+			_allocate(0);
+			swap(other);
+		}
+
+		FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator=(FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>&& other){
+			swap(other);
+			return *this;
+		}
+	#endif
+
+	~FixedPointPacked(){
+		_fp_aligned_free(_bytes);
+	}
+
+	FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& operator=(const FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+		if (this != &other){
+			FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> copy(other);
+			swap(copy);
+		}
+		return *this;
+	}
+
+	void swap(FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& other){
+		unsigned char* const bytes = _bytes;
+		const size_t size = _size;
+		_bytes = other._bytes;
+		_size = other._size;
+		other._bytes = bytes;
+		other._size = size;
+	}
+
+	size_t size() const{
+		return _size;
+	}
+
+	bool empty() const{
+		return _size == 0;
+	}
+
+	/// Returns the packed storage
+	/**
+	 *	@return First byte of the bit stream, storage_size() bytes long
+	 */
+	unsigned char* data(){
+		return _bytes;
+	}
+
+	const unsigned char* data() const{
+		return _bytes;
+	}
+
+	/// Returns the number of bytes of packed storage
+	/**
+	 *	@return Bytes used by size() values
+	 */
+	size_t storage_size() const{
+		return (_size * bits + 7) / 8;
+	}
+
+	/// Returns a value
+	/**
+	 *	@param index Index of the value
+	 *	@return Value
+	 */
+	value_type get(size_t index) const{
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (index >= _size){
+				_fp_event<value_type>(fp_event_range, "FixedPointPacked::get");
+			}
+		#endif
+		return value_type(_read(_bytes, index * bits));
+	}
+
+	value_type operator[](size_t index) const{
+		return get(index);
+	}
+
+	/// Sets a value
+	/**
+	 *	@param index Index of the value
+	 *	@param value New value, settled by the overflow policy if it needs more than bits bits
+	 */
+	void set(size_t index, const value_type& value){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (index >= _size){
+				_fp_event<value_type>(fp_event_range, "FixedPointPacked::set");
+			}
+		#endif
+		_write(_bytes, index * bits, _encode(value()));
+	}
+
+	/// Unpacks a range of values
+	/**
+	 *	@param out Array receiving count values
+	 *	@param first Index of the first value
+	 *	@param count Number of values
+	 */
+	void unpack(value_type* out, size_t first, size_t count) const{
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (first > _size || count > _size - first){
+				_fp_event<value_type>(fp_event_range, "FixedPointPacked::unpack");
+			}
+		#endif
+		IntegerType* const raw = _fp_raw(out);
+		size_t i = 0;
+		#ifdef FIXEDPOINT_AVX2
+			if ((sizeof(IntegerType) == 2 || sizeof(IntegerType) == 4) && bits <= 8 * sizeof(IntegerType) && bits <= 25 && _fp_has_avx2()){
+				// Scalar up to a value that starts on a byte, which every 8th value does
+				for (; i < count && (first + i) % 8; i++){
+					raw[i] = _read(_bytes, (first + i) * bits);
+				}
+				const size_t blocks = (count - i) / 8 * 8;
+				_unpack_avx2(raw + i, _bytes + (first + i) / 8 * bits, blocks);
+				i += blocks;
+			}
+		#endif
+		for (; i < count; i++){
+			raw[i] = _read(_bytes, (first + i) * bits);
+		}
+	}
+
+	/// Unpacks values into a view
+	/**
+	 *	@param out View receiving the values, one for each of its elements
+	 *	@param first Index of the first value
+	 */
+	void unpack(view_type out, size_t first = 0) const{
+		unpack(out.data(), first, out.size());
+	}
+
+	/// Packs a range of values
+	/**
+	 *	Whole 32 bit words are written at a time for values of up to 32 bits
+	 *	@param in Values to pack, settled by the overflow policy if they need more than bits bits
+	 *	@param first Index of the first value to replace
+	 *	@param count Number of values
+	 */
+	void pack(const value_type* in, size_t first, size_t count){
+		#ifdef FIXEDPOINT_INSTRUMENT
+			if (first > _size || count > _size - first){
+				_fp_event<value_type>(fp_event_range, "FixedPointPacked::pack");
+			}
+		#endif
+		const IntegerType* const raw = _fp_raw(in);
+		if (bits > 32){
+			for (size_t i = 0; i < count; i++){
+				_write(_bytes, (first + i) * bits, _encode(raw[i]));
+			}
+			return;
+		}
+
+		// Bits are gathered in buffer and flushed 32 at a time, starting with the bits already before the first value
+		const size_t bit = first * bits;
+		unsigned char* out = _bytes + bit / 8;
+		count_type filled = count_type(bit % 8);
+		unsigned long long int buffer = *out & ((1u << filled) - 1);
+		for (size_t i = 0; i < count; i++){
+			buffer |= _encode(raw[i]) << filled;
+			filled = count_type(filled + bits);
+			if (filled >= 32){
+				_fp_packed_store32(out, buffer);
+				out += 4;
+				buffer >>= 32;
+				filled = count_type(filled - 32);
+			}
+		}
+		// The last byte keeps the bits after the last value
+		for (; filled >= 8; filled = count_type(filled - 8), buffer >>= 8){
+			*out++ = static_cast<unsigned char>(buffer);
+		}
+		if (filled){
+			const unsigned int low = (1u << filled) - 1;
+			*out = static_cast<unsigned char>((*out & ~low) | (buffer & low));
+		}
+	}
+
+	/// Packs the values of a view
+	/**
+	 *	@param in Values to pack
+	 *	@param first Index of the first value to replace
+	 */
+	void pack(const const_view_type& in, size_t first = 0){
+		pack(in.data(), first, in.size());
+	}
+};
+
+// Element-wise operations on packed arrays, a block of values at a time through the loops of fp_batch.h
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+struct _fp_packed_add{
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+
+	static void apply(value_type* out, const value_type* a, const value_type* b, size_t count){
+		fp_add(out, a, b, count);
+	}
+};
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+struct _fp_packed_sub{
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+
+	static void apply(value_type* out, const value_type* a, const value_type* b, size_t count){
+		fp_sub(out, a, b, count);
+	}
+};
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+struct _fp_packed_mul{
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+
+	static void apply(value_type* out, const value_type* a, const value_type* b, size_t count){
+		fp_mul(out, a, b, count);
+	}
+};
+
+template<typename Operation, typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void _fp_packed_apply(FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& out, const FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& a, const FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& b){
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	value_type left[FIXEDPOINT_PACKED_BLOCK];
+	value_type right[FIXEDPOINT_PACKED_BLOCK];
+
+	for (size_t first = 0; first < out.size(); first += FIXEDPOINT_PACKED_BLOCK){
+		const size_t count = out.size() - first < FIXEDPOINT_PACKED_BLOCK ? out.size() - first : FIXEDPOINT_PACKED_BLOCK;
+		a.unpack(left, first, count);
+		b.unpack(right, first, count);
+		Operation::apply(left, left, right, count);
+		out.pack(left, first, count);
+	}
+}
+
+/// Adds two packed arrays element by element
+/**
+ *	The sums are computed in IntegerType, then packed back as by FixedPointPacked::pack. out may be the same array as a or b
+ *	@param out Array receiving a[i] + b[i], for each of its values
+ *	@param a First operands, at least as many as out
+ *	@param b Second operands, at least as many as out
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_add(FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& out, const FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& a, const FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& b){
+	_fp_packed_apply<_fp_packed_add<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(out, a, b);
+}
+
+/// Subtracts two packed arrays element by element
+/**
+ *	@param out Array receiving a[i] - b[i], for each of its values
+ *	@param a First operands, at least as many as out
+ *	@param b Second operands, at least as many as out
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_sub(FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& out, const FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& a, const FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& b){
+	_fp_packed_apply<_fp_packed_sub<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(out, a, b);
+}
+
+/// Multiplies two packed arrays element by element
+/**
+ *	@param out Array receiving a[i] * b[i], for each of its values
+ *	@param a First operands, at least as many as out
+ *	@param b Second operands, at least as many as out
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_mul(FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& out, const FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& a, const FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& b){
+	_fp_packed_apply<_fp_packed_mul<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> >(out, a, b);
+}
+
+/// Multiplies a packed array by a single FixedPoint
+/**
+ *	@param out Array receiving a[i] * factor, for each of its values
+ *	@param a Values to scale, at least as many as out
+ *	@param factor Scale factor
+ */
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void fp_scale(FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& out, const FixedPointPacked<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& a, const FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>& factor){
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> values[FIXEDPOINT_PACKED_BLOCK];
+
+	for (size_t first = 0; first < out.size(); first += FIXEDPOINT_PACKED_BLOCK){
+		const size_t count = out.size() - first < FIXEDPOINT_PACKED_BLOCK ? out.size() - first : FIXEDPOINT_PACKED_BLOCK;
+		a.unpack(values, first, count);
+		fp_scale(values, values, factor, count);
+		out.pack(values, first, count);
+	}
+}
+
+#endif//H_FP_PACKED
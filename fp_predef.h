@@ -125,6 +125,83 @@
 		typedef FixedPoint<FIXEDPOINT_SIZE64, 56>	fp8_56;
 		typedef FixedPoint<FIXEDPOINT_SIZE64, 60>	fp4_60;
 	#endif
+
+	// User-defined literals for the typedefs above, e.g. 1.25_q16_16 is an fp16_16 constant
+	#ifdef FIXEDPOINT_CPP14
+		#define FIXEDPOINT_LITERAL(_type_, _suffix_) \
+			constexpr _type_ operator"" _suffix_(long double value){ \
+				return _type_::from_float(value); \
+			} \
+			constexpr _type_ operator"" _suffix_(unsigned long long int value){ \
+				return _type_::from_float((long double)value); \
+			}
+
+		#ifdef FIXEDPOINT_SIZE8
+			FIXEDPOINT_LITERAL(fp1_7, _q1_7)
+			FIXEDPOINT_LITERAL(fp2_6, _q2_6)
+			FIXEDPOINT_LITERAL(fp3_5, _q3_5)
+			FIXEDPOINT_LITERAL(fp4_4, _q4_4)
+			FIXEDPOINT_LITERAL(fp5_3, _q5_3)
+			FIXEDPOINT_LITERAL(fp6_2, _q6_2)
+			FIXEDPOINT_LITERAL(fp7_1, _q7_1)
+		#endif
+
+		#ifdef FIXEDPOINT_SIZE16
+			FIXEDPOINT_LITERAL(fp15_1, _q15_1)
+			FIXEDPOINT_LITERAL(fp14_2, _q14_2)
+			FIXEDPOINT_LITERAL(fp13_3, _q13_3)
+			FIXEDPOINT_LITERAL(fp12_4, _q12_4)
+			FIXEDPOINT_LITERAL(fp11_5, _q11_5)
+			FIXEDPOINT_LITERAL(fp10_6, _q10_6)
+			FIXEDPOINT_LITERAL(fp9_7, _q9_7)
+			FIXEDPOINT_LITERAL(fp8_8, _q8_8)
+			FIXEDPOINT_LITERAL(fp7_9, _q7_9)
+			FIXEDPOINT_LITERAL(fp6_10, _q6_10)
+			FIXEDPOINT_LITERAL(fp5_11, _q5_11)
+			FIXEDPOINT_LITERAL(fp4_12, _q4_12)
+			FIXEDPOINT_LITERAL(fp3_13, _q3_13)
+			FIXEDPOINT_LITERAL(fp2_14, _q2_14)
+			FIXEDPOINT_LITERAL(fp1_15, _q1_15)
+		#endif
+
+		#ifdef FIXEDPOINT_SIZE32
+			FIXEDPOINT_LITERAL(fp30_2, _q30_2)
+			FIXEDPOINT_LITERAL(fp28_4, _q28_4)
+			FIXEDPOINT_LITERAL(fp26_6, _q26_6)
+			FIXEDPOINT_LITERAL(fp24_8, _q24_8)
+			FIXEDPOINT_LITERAL(fp22_10, _q22_10)
+			FIXEDPOINT_LITERAL(fp20_12, _q20_12)
+			FIXEDPOINT_LITERAL(fp18_14, _q18_14)
+			FIXEDPOINT_LITERAL(fp16_16, _q16_16)
+			FIXEDPOINT_LITERAL(fp14_18, _q14_18)
+			FIXEDPOINT_LITERAL(fp12_20, _q12_20)
+			FIXEDPOINT_LITERAL(fp10_22, _q10_22)
+			FIXEDPOINT_LITERAL(fp8_24, _q8_24)
+			FIXEDPOINT_LITERAL(fp6_26, _q6_26)
+			FIXEDPOINT_LITERAL(fp4_28, _q4_28)
+			FIXEDPOINT_LITERAL(fp2_30, _q2_30)
+		#endif
+
+		#ifdef FIXEDPOINT_SIZE64
+			FIXEDPOINT_LITERAL(fp60_4, _q60_4)
+			FIXEDPOINT_LITERAL(fp56_8, _q56_8)
+			FIXEDPOINT_LITERAL(fp52_12, _q52_12)
+			FIXEDPOINT_LITERAL(fp48_16, _q48_16)
+			FIXEDPOINT_LITERAL(fp44_20, _q44_20)
+			FIXEDPOINT_LITERAL(fp40_24, _q40_24)
+			FIXEDPOINT_LITERAL(fp36_28, _q36_28)
+			FIXEDPOINT_LITERAL(fp32_32, _q32_32)
+			FIXEDPOINT_LITERAL(fp28_36, _q28_36)
+			FIXEDPOINT_LITERAL(fp24_40, _q24_40)
+			FIXEDPOINT_LITERAL(fp20_44, _q20_44)
+			FIXEDPOINT_LITERAL(fp16_48, _q16_48)
+			FIXEDPOINT_LITERAL(fp12_52, _q12_52)
+			FIXEDPOINT_LITERAL(fp8_56, _q8_56)
+			FIXEDPOINT_LITERAL(fp4_60, _q4_60)
+		#endif
+
+		#undef FIXEDPOINT_LITERAL
+	#endif
 #endif
 
 #endif//H_FP_PREDEF
@@ -0,0 +1,59 @@
+/**
+ *	@file fp_batch_mul.cpp
+ *	Checks that the vector product kernels of fp_batch.h give the same results as FixedPoint::operator* and operator+,
+ *	for every length up to a few vectors and with contents at the limits of each type
+ */
+
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_batch.h"
+
+static int failures = 0;
+
+static unsigned long long int random_bits(){
+	static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+template<typename IntegerType, count_type IntegerBits>
+void check(const char* name){
+	typedef FixedPoint<IntegerType, IntegerBits, std::numeric_limits<IntegerType>::digits - IntegerBits> value_type;
+	static const size_t length = 80;
+
+	std::vector<value_type> a(length), b(length), c(length), product(length), fused(length), scaled(length);
+	for (size_t i = 0; i < length; i++){
+		a[i] = value_type(i % 7 ? IntegerType(random_bits()) : std::numeric_limits<IntegerType>::min());
+		b[i] = value_type(i % 5 ? IntegerType(random_bits()) : std::numeric_limits<IntegerType>::max());
+		c[i] = value_type(IntegerType(random_bits()));
+	}
+
+	for (size_t count = 0; count <= length; count++){
+		fp_mul(&product[0], &a[0], &b[0], count);
+		fp_fma(&fused[0], &a[0], &b[0], &c[0], count);
+		fp_scale(&scaled[0], &a[0], b[0], count);
+		for (size_t i = 0; i < count; i++){
+			if (product[i]() != (a[i] * b[i])() || fused[i]() != (a[i] * b[i] + c[i])() || scaled[i]() != (a[i] * b[0])()){
+				std::printf("%s: element %lu of %lu differs from operator*\n", name, (unsigned long)i, (unsigned long)count);
+				failures++;
+				return;
+			}
+		}
+	}
+}
+
+int main(){
+	check<short int, 7>("short");
+	check<short int, 0>("short, no integer bits");
+	check<unsigned short int, 4>("unsigned short");
+	check<unsigned short int, 0>("unsigned short, no integer bits");
+	check<int, 15>("int");
+	check<unsigned int, 8>("unsigned int");
+	return failures != 0;
+}
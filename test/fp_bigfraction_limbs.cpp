@@ -0,0 +1,464 @@
+/**
+ *	@file fp_bigfraction_limbs.cpp
+ *	Checks the limb integers of fp_bigfraction.h against a decimal reference, with carries and borrows across every limb
+ *	and divisors of every normalization shift, and checks BigFraction chains against unreduced reference fractions,
+ *	that results are in lowest terms and go back inline as soon as they fit
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_bigfraction.h"
+
+static int failures = 0;
+
+static unsigned long long int random_bits(){
+	static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+// Magnitudes in base 10^9 limbs, least significant first, without leading zero limbs
+class Decimal{
+public:
+	std::vector<unsigned int> limbs;
+
+	static const unsigned int base = 1000000000;
+
+	Decimal(){}
+
+	explicit Decimal(unsigned long long int value){
+		for (; value; value /= base){
+			limbs.push_back(unsigned(value % base));
+		}
+	}
+
+	explicit Decimal(const std::string& text){
+		for (size_t end = text.size(); end > 0; end = end > 9 ? end - 9 : 0){
+			const size_t begin = end > 9 ? end - 9 : 0;
+			limbs.push_back(unsigned(std::strtoul(text.substr(begin, end - begin).c_str(), 0, 10)));
+		}
+		trim();
+	}
+
+	void trim(){
+		while (!limbs.empty() && !limbs.back()){
+			limbs.pop_back();
+		}
+	}
+
+	bool zero() const{
+		return limbs.empty();
+	}
+
+	std::string str() const{
+		if (limbs.empty()){
+			return "0";
+		}
+		char group[16];
+		std::snprintf(group, sizeof(group), "%u", limbs.back());
+		std::string result(group);
+		for (size_t i = limbs.size() - 1; i--;){
+			std::snprintf(group, sizeof(group), "%09u", limbs[i]);
+			result += group;
+		}
+		return result;
+	}
+
+	static int compare(const Decimal& a, const Decimal& b){
+		if (a.limbs.size() != b.limbs.size()){
+			return a.limbs.size() < b.limbs.size() ? -1 : 1;
+		}
+		for (size_t i = a.limbs.size(); i--;){
+			if (a.limbs[i] != b.limbs[i]){
+				return a.limbs[i] < b.limbs[i] ? -1 : 1;
+			}
+		}
+		return 0;
+	}
+
+	static Decimal add(const Decimal& a, const Decimal& b){
+		Decimal result;
+		unsigned int carry = 0;
+		for (size_t i = 0; i < a.limbs.size() || i < b.limbs.size() || carry; i++){
+			const unsigned int sum = (i < a.limbs.size() ? a.limbs[i] : 0) + (i < b.limbs.size() ? b.limbs[i] : 0) + carry;
+			result.limbs.push_back(sum % base);
+			carry = sum / base;
+		}
+		return result;
+	}
+
+	// a - b with a >= b
+	static Decimal sub(const Decimal& a, const Decimal& b){
+		Decimal result;
+		int borrow = 0;
+		for (size_t i = 0; i < a.limbs.size(); i++){
+			int difference = int(a.limbs[i]) - int(i < b.limbs.size() ? b.limbs[i] : 0) - borrow;
+			borrow = difference < 0;
+			result.limbs.push_back(unsigned(borrow ? difference + int(base) : difference));
+		}
+		result.trim();
+		return result;
+	}
+
+	static Decimal mul(const Decimal& a, const Decimal& b){
+		Decimal result;
+		if (a.zero() || b.zero()){
+			return result;
+		}
+		std::vector<unsigned long long int> sums(a.limbs.size() + b.limbs.size() + 1, 0);
+		for (size_t i = 0; i < a.limbs.size(); i++){
+			unsigned long long int carry = 0;
+			for (size_t j = 0; j < b.limbs.size(); j++){
+				carry += sums[i + j] + (unsigned long long int)a.limbs[i] * b.limbs[j];
+				sums[i + j] = carry % base;
+				carry /= base;
+			}
+			for (size_t k = i + b.limbs.size(); carry; k++){
+				carry += sums[k];
+				sums[k] = carry % base;
+				carry /= base;
+			}
+		}
+		for (size_t i = 0; i < sums.size(); i++){
+			result.limbs.push_back(unsigned(sums[i]));
+		}
+		result.trim();
+		return result;
+	}
+};
+
+// A signed magnitude
+struct Signed{
+	bool negative;
+	Decimal magnitude;
+
+	Signed() : negative(false){}
+	Signed(bool _negative, const Decimal& _magnitude) : negative(_negative && !_magnitude.zero()), magnitude(_magnitude){}
+
+	std::string str() const{
+		return (negative ? "-" : "") + magnitude.str();
+	}
+
+	static Signed add(const Signed& a, const Signed& b, bool subtract){
+		const bool b_negative = b.negative != subtract;
+		if (a.negative == b_negative){
+			return Signed(a.negative, Decimal::add(a.magnitude, b.magnitude));
+		}
+		if (Decimal::compare(a.magnitude, b.magnitude) >= 0){
+			return Signed(a.negative, Decimal::sub(a.magnitude, b.magnitude));
+		}
+		return Signed(b_negative, Decimal::sub(b.magnitude, a.magnitude));
+	}
+
+	static Signed mul(const Signed& a, const Signed& b){
+		return Signed(a.negative != b.negative, Decimal::mul(a.magnitude, b.magnitude));
+	}
+};
+
+static std::string text(const _fp_bigint& value){
+	std::vector<char> buffer(value.zero() ? 2 : 16384);
+	char* const end = value.to_chars(&buffer[0], &buffer[0] + buffer.size());
+	return end ? std::string(&buffer[0], end) : std::string("(no room)");
+}
+
+static std::string text(const BigFraction& value){
+	std::vector<char> buffer(16384);
+	const fp_to_chars_result result = fp_to_chars(&buffer[0], &buffer[0] + buffer.size(), value);
+	return result.status == fp_chars_ok ? std::string(&buffer[0], result.ptr) : std::string("(no room)");
+}
+
+// The same value built from 32 bit limbs, most significant first, as a limb integer and as a reference
+static void build(const std::vector<unsigned int>& limbs, bool negative, _fp_bigint& value, Signed& reference){
+	const _fp_bigint base(1LL << 32);
+	value = _fp_bigint(0);
+	Decimal magnitude;
+	for (size_t i = 0; i < limbs.size(); i++){
+		_fp_bigint shifted;
+		_fp_bigint::mul(value, base, shifted);
+		_fp_bigint::add(shifted, _fp_bigint((long long int)limbs[i]), false, value);
+		magnitude = Decimal::add(Decimal::mul(magnitude, Decimal(1ull << 32)), Decimal(limbs[i]));
+	}
+	if (negative){
+		value.negate();
+	}
+	reference = Signed(negative, magnitude);
+}
+
+// Limbs at the edges of a carry or a borrow, and leading limbs with every number of leading zeros for the normalization of algorithm D
+static std::vector<unsigned int> random_limbs(size_t count){
+	static const unsigned int edges[] = {0, 1, 2, 0x7FFFFFFF, 0x80000000, 0x80000001, 0xFFFFFFFE, 0xFFFFFFFF};
+	std::vector<unsigned int> limbs(count);
+	for (size_t i = 0; i < count; i++){
+		limbs[i] = random_bits() % 2 ? edges[random_bits() % 8] : unsigned(random_bits());
+	}
+	if (count && random_bits() % 2){
+		limbs[0] = unsigned(random_bits() >> (32 + random_bits() % 32)) | 1;
+	}
+	return limbs;
+}
+
+static void check_text(const char* what, const std::string& result, const std::string& expected){
+	if (result != expected){
+		std::printf("%s is %s, expected %s\n", what, result.c_str(), expected.c_str());
+		failures++;
+	}
+}
+
+static _fp_bigint product(const _fp_bigint& a, const _fp_bigint& b){
+	_fp_bigint result;
+	_fp_bigint::mul(a, b, result);
+	return result;
+}
+
+// quotient * b + remainder == a, with |remainder| < |b| and the sign of a
+static void check_divide(const _fp_bigint& a, const _fp_bigint& b){
+	_fp_bigint quotient, remainder, sum;
+	_fp_bigint::divide(a, b, quotient, remainder);
+	_fp_bigint::add(product(quotient, b), remainder, false, sum);
+	_fp_bigint remainder_magnitude(remainder), b_magnitude(b);
+	remainder_magnitude.abs();
+	b_magnitude.abs();
+	if (sum.compare(a) != 0 || remainder_magnitude.compare(b_magnitude) >= 0 || (!remainder.zero() && remainder.negative() != a.negative())){
+		std::printf("%s / %s is %s remainder %s\n", text(a).c_str(), text(b).c_str(), text(quotient).c_str(), text(remainder).c_str());
+		failures++;
+	}
+}
+
+// Euclid's algorithm with divisions, against the binary GCD
+static void check_gcd(const _fp_bigint& a, const _fp_bigint& b){
+	_fp_bigint u(a), v(b), result;
+	u.abs();
+	v.abs();
+	while (!v.zero()){
+		_fp_bigint quotient, remainder;
+		_fp_bigint::divide(u, v, quotient, remainder);
+		u.swap(v);
+		v.swap(remainder);
+	}
+	_fp_bigint::gcd(a, b, result);
+	if (result.compare(u) != 0){
+		std::printf("gcd(%s, %s) is %s, expected %s\n", text(a).c_str(), text(b).c_str(), text(result).c_str(), text(u).c_str());
+		failures++;
+	}
+}
+
+static void check_bigints(){
+	for (int i = 0; i < 20000; i++){
+		_fp_bigint a, b, result;
+		Signed a_reference, b_reference;
+		build(random_limbs(random_bits() % 8), random_bits() % 2, a, a_reference);
+		build(random_limbs(random_bits() % 8), random_bits() % 2, b, b_reference);
+		const std::string operands = text(a) + ", " + text(b);
+
+		_fp_bigint::add(a, b, false, result);
+		check_text(("sum of " + operands).c_str(), text(result), Signed::add(a_reference, b_reference, false).str());
+		_fp_bigint::add(a, b, true, result);
+		check_text(("difference of " + operands).c_str(), text(result), Signed::add(a_reference, b_reference, true).str());
+		_fp_bigint::mul(a, b, result);
+		check_text(("product of " + operands).c_str(), text(result), Signed::mul(a_reference, b_reference).str());
+
+		if (!b.zero()){
+			check_divide(a, b);
+			// Products, so that the quotients have as many limbs as the divisors
+			check_divide(product(a, b), b);
+			check_divide(result, b);
+		}
+		// A common factor of several limbs, which a division removes first when the sizes differ
+		_fp_bigint factor;
+		Signed unused;
+		build(random_limbs(1 + random_bits() % 4), false, factor, unused);
+		check_gcd(a, b);
+		check_gcd(product(a, factor), product(b, factor));
+		check_gcd(product(a, factor), factor);
+	}
+
+	// Carries and borrows through every limb
+	_fp_bigint value, result;
+	Signed reference;
+	for (size_t count = 1; count <= 6; count++){
+		build(std::vector<unsigned int>(count, 0xFFFFFFFF), false, value, reference);
+		_fp_bigint::add(value, _fp_bigint(1), false, result);
+		check_text("2^32n - 1 + 1", text(result), Signed::add(reference, Signed(false, Decimal(1)), false).str());
+		_fp_bigint::add(result, _fp_bigint(1), true, value);
+		check_text("2^32n - 1", text(value), reference.str());
+		_fp_bigint::add(_fp_bigint(-1), result, false, value);
+		check_text("-1 + 2^32n", text(value), reference.str());
+	}
+	check_text("2^64", text(product(_fp_bigint(1LL << 32), _fp_bigint(1LL << 32))), "18446744073709551616");
+	build(std::vector<unsigned int>(3, 0xFFFFFFFF), true, value, reference);
+	check_text("-(2^96 - 1)", text(value), "-79228162514264337593543950335");
+}
+
+// A random fraction of up to 62 bit numerators and denominators, often small enough to stay inline
+static void random_fraction(BigFraction& value, Signed& numerator, Signed& denominator){
+	const count_type bits = count_type(random_bits() % 4 ? 1 + random_bits() % 30 : 1 + random_bits() % 62);
+	long long int numer = (long long int)(random_bits() >> (64 - bits));
+	const long long int denom = (long long int)(random_bits() >> (64 - bits)) + 1;
+	if (random_bits() % 2){
+		numer = -numer;
+	}
+	value = BigFraction(numer, denom);
+	numerator = Signed(numer < 0, Decimal((unsigned long long int)(numer < 0 ? -numer : numer)));
+	denominator = Signed(false, Decimal((unsigned long long int)denom));
+}
+
+// Compares with an unreduced reference by cross multiplication, and checks lowest terms, the sign, and where the value is stored
+static void check_fraction(const char* what, const BigFraction& value, const Signed& numerator, const Signed& denominator){
+	const std::string result = text(value);
+	const size_t slash = result.find('/');
+	const std::string numerator_text = result.substr(0, slash);
+	const std::string denominator_text = slash == std::string::npos ? "1" : result.substr(slash + 1);
+	const bool negative = numerator_text[0] == '-';
+	const Signed result_numerator(negative, Decimal(numerator_text.substr(negative)));
+	const Decimal result_denominator(denominator_text);
+
+	const Signed left = Signed::mul(result_numerator, Signed(false, denominator.magnitude));
+	const Signed right = Signed::mul(numerator, Signed(false, result_denominator));
+	bool correct = (left.magnitude.zero() || left.negative == (right.negative != denominator.negative)) && Decimal::compare(left.magnitude, right.magnitude) == 0;
+
+	// Lowest terms, with a positive denominator that is not written when it is 1
+	_fp_bigint numerator_limbs, denominator_limbs, divisor;
+	Signed unused;
+	for (int pass = 0; pass < 2; pass++){
+		Decimal rest(pass ? result_denominator : result_numerator.magnitude);
+		std::vector<unsigned int> words;
+		while (!rest.zero()){
+			// Divides by 2^32 in base 10^9, most significant limb first
+			unsigned long long int remainder = 0;
+			for (size_t i = rest.limbs.size(); i--;){
+				const unsigned long long int current = remainder * Decimal::base + rest.limbs[i];
+				rest.limbs[i] = unsigned(current >> 32);
+				remainder = current & 0xFFFFFFFF;
+			}
+			rest.trim();
+			words.insert(words.begin(), unsigned(remainder));
+		}
+		build(words, false, pass ? denominator_limbs : numerator_limbs, unused);
+	}
+	_fp_bigint::gcd(numerator_limbs, denominator_limbs, divisor);
+	correct = correct && divisor.one() && !result_denominator.zero() && denominator_text[0] != '-' && (slash == std::string::npos || denominator_text != "1");
+
+	// Inline exactly when both fit in a long long, other than the most negative numerator
+	long long int numer = 0, denom = 0;
+	const bool fits = numerator_limbs.get(numer) && denominator_limbs.get(denom);
+	correct = correct && value.is_inline() == fits;
+	if (!correct){
+		std::printf("%s is %s (%s), expected %s/%s\n", what, result.c_str(), value.is_inline() ? "inline" : "limbs", numerator.str().c_str(), denominator.str().c_str());
+		failures++;
+	}
+}
+
+static void check_fractions(){
+	for (int chain = 0; chain < 300; chain++){
+		BigFraction value;
+		Signed numerator, denominator;
+		random_fraction(value, numerator, denominator);
+		for (int step = 0; step < 40; step++){
+			BigFraction operand;
+			Signed operand_numerator, operand_denominator;
+			random_fraction(operand, operand_numerator, operand_denominator);
+			switch (random_bits() % 6){
+				case 0:
+					value += operand;
+					numerator = Signed::add(Signed::mul(numerator, operand_denominator), Signed::mul(operand_numerator, denominator), false);
+					denominator = Signed::mul(denominator, operand_denominator);
+					break;
+				case 1:
+					value -= operand;
+					numerator = Signed::add(Signed::mul(numerator, operand_denominator), Signed::mul(operand_numerator, denominator), true);
+					denominator = Signed::mul(denominator, operand_denominator);
+					break;
+				case 2:
+					value *= operand;
+					numerator = Signed::mul(numerator, operand_numerator);
+					denominator = Signed::mul(denominator, operand_denominator);
+					break;
+				case 3:
+					if (operand.sign()){
+						value /= operand;
+						numerator = Signed::mul(numerator, operand_denominator);
+						denominator = Signed::mul(denominator, operand_numerator);
+					}
+					break;
+				case 4:{
+					// value - (value - operand), which goes back inline
+					const BigFraction difference = value - operand;
+					value -= difference;
+					numerator = operand_numerator;
+					denominator = operand_denominator;
+					break;
+				}
+				default:
+					// value * (operand / value), unless value is zero
+					if (value.sign()){
+						value *= operand / value;
+						numerator = operand_numerator;
+						denominator = operand_denominator;
+					}
+			}
+			check_fraction("chain", value, numerator, denominator);
+		}
+	}
+}
+
+static void check_limits(){
+	const long long int max = std::numeric_limits<long long int>::max();
+	const long long int min = std::numeric_limits<long long int>::min();
+
+	// Past a long long and back
+	BigFraction value(max);
+	value += BigFraction(1);
+	check_text("max + 1", text(value), "9223372036854775808");
+	if (value.is_inline()){
+		std::printf("max + 1 is inline\n");
+		failures++;
+	}
+	value -= BigFraction(1);
+	long long int numer = 0, denom = 0;
+	if (!value.get(numer, denom) || numer != max || denom != 1){
+		std::printf("max + 1 - 1 is %s, not back inline\n", text(value).c_str());
+		failures++;
+	}
+
+	// The most negative value has no opposite, so it is not inline
+	check_text("min", text(BigFraction(min)), "-9223372036854775808");
+	check_text("-min", text(-BigFraction(min)), "9223372036854775808");
+	check_text("min / -1", text(BigFraction(min) / BigFraction(-1)), "9223372036854775808");
+	check_text("1 / min", text(BigFraction(1, min)), "-1/9223372036854775808");
+	check_text("min / 2", text(BigFraction(min, 2)), "-4611686018427387904");
+	check_text("min + 1", text(BigFraction(min) + BigFraction(1)), "-9223372036854775807");
+	check_text("min * min", text(BigFraction(min) * BigFraction(min)), "85070591730234615865843651857942052864");
+
+	// Denominators that cancel across limbs
+	const BigFraction power(1LL << 48);
+	const BigFraction big = power * power - BigFraction(1);
+	check_text("2^96 - 1", text(big), "79228162514264337593543950335");
+	check_text("2^96", text(big + BigFraction(1)), "79228162514264337593543950336");
+	check_text("2^96 / 2^64", text((big + BigFraction(1)) / (BigFraction(1LL << 32) * BigFraction(1LL << 32))), "4294967296");
+	check_text("(2^96 - 1) / (2^96 + 2^48)", text(big / (big + BigFraction(1) + power)), "281474976710655/281474976710656");
+	check_text("1 / (2^96 - 1) - 1 / 2^96", text(BigFraction(1) / big - BigFraction(1) / (big + BigFraction(1))), "1/6277101735386680763835789423128438253588091106870490562560");
+	if (!(big / big).is_inline() || (big / big) != BigFraction(1)){
+		std::printf("(2^96 - 1) / (2^96 - 1) is %s\n", text(big / big).c_str());
+		failures++;
+	}
+}
+
+int main(){
+	check_bigints();
+	check_limits();
+	check_fractions();
+
+	if (failures){
+		std::printf("%d failures\n", failures);
+		return 1;
+	}
+	return 0;
+}
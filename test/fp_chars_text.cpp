@@ -0,0 +1,232 @@
+/**
+ *	@file fp_chars_text.cpp
+ *	Checks fp_to_chars and fp_from_chars of fp_chars.h: every value reads back from its text, the text is the shortest that does,
+ *	the limits of formats without fractional bits and with fractional bits filling the IntegerType are exact, and malformed text is rejected
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_chars.h"
+
+static int failures = 0;
+
+static unsigned long long int random_bits(){
+	static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+// Adds one unit in the last place to decimal text, e.g. "-0.19" to "-0.20" or "9.9" to "10.0"
+static void increment_text(char* text){
+	char* digit = text + std::strlen(text);
+	while (digit != text){
+		--digit;
+		if (*digit == '.'){
+			continue;
+		}
+		if (*digit == '-'){
+			break;
+		}
+		if (*digit != '9'){
+			++*digit;
+			return;
+		}
+		*digit = '0';
+	}
+	// Every digit was 9, so a 1 goes in front of them
+	char* const start = *text == '-' ? text + 1 : text;
+	std::memmove(start + 1, start, std::strlen(start) + 1);
+	*start = '1';
+}
+
+template<typename Type>
+bool reads_as(const char* text, const Type& expected){
+	Type value;
+	const fp_from_chars_result result = fp_from_chars(text, text + std::strlen(text), value);
+	return result.status == fp_chars_ok && result.ptr == text + std::strlen(text) && value() == expected();
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+void check_round_trip(const char* name, const FixedPoint<IntegerType, IntegerBits, FractionalBits>& value){
+	char text[200];
+	const fp_to_chars_result written = fp_to_chars(text, text + sizeof(text) - 1, value);
+	if (written.status != fp_chars_ok){
+		std::printf("%s: fp_to_chars of %llx failed\n", name, (unsigned long long int)value());
+		failures++;
+		return;
+	}
+	*written.ptr = 0;
+	if (!reads_as(text, value)){
+		std::printf("%s: %s does not read back as %llx\n", name, text, (unsigned long long int)value());
+		failures++;
+	}
+
+	// The text with one decimal less, rounded down or up, must read as another value
+	char* const point = std::strchr(text, '.');
+	if (point){
+		char shorter[200];
+		const size_t length = size_t(written.ptr - text) - 1;
+		std::memcpy(shorter, text, length);
+		shorter[length == size_t(point - text) + 1 ? length - 1 : length] = 0;
+		if (reads_as(shorter, value)){
+			std::printf("%s: %s is not the shortest text, %s reads the same\n", name, text, shorter);
+			failures++;
+		}
+		increment_text(shorter);
+		if (reads_as(shorter, value)){
+			std::printf("%s: %s is not the shortest text, %s reads the same\n", name, text, shorter);
+			failures++;
+		}
+	}
+
+	// With as many decimals as fractional bits the text is exact, so it reads back too
+	const fp_to_chars_result exact = fp_to_chars(text, text + sizeof(text) - 1, value, size_t(FractionalBits));
+	*exact.ptr = 0;
+	if (exact.status != fp_chars_ok || !reads_as(text, value)){
+		std::printf("%s: exact text %s does not read back as %llx\n", name, text, (unsigned long long int)value());
+		failures++;
+	}
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+void check_round_trips(const char* name){
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits> value_type;
+	check_round_trip(name, value_type(std::numeric_limits<IntegerType>::min()));
+	check_round_trip(name, value_type(std::numeric_limits<IntegerType>::max()));
+	check_round_trip(name, value_type(IntegerType(0)));
+	check_round_trip(name, value_type(IntegerType(1)));
+	check_round_trip(name, value_type(IntegerType(std::numeric_limits<IntegerType>::max() - 1)));
+	for (int i = 0; i < 20000; i++){
+		// Small contents have the longest fractions
+		const unsigned long long int bits = random_bits();
+		check_round_trip(name, value_type(IntegerType(i % 4 ? bits : bits >> (bits % 64))));
+	}
+}
+
+template<typename Type>
+void check_text(const char* name, const Type& value, const char* expected, size_t precision = size_t(-1)){
+	char text[200];
+	const fp_to_chars_result written = precision == size_t(-1) ? fp_to_chars(text, text + sizeof(text), value) : fp_to_chars(text, text + sizeof(text), value, precision);
+	if (written.status != fp_chars_ok || size_t(written.ptr - text) != std::strlen(expected) || std::memcmp(text, expected, std::strlen(expected))){
+		std::printf("%s: %llx is written as %.*s, expected %s\n", name, (unsigned long long int)value(), int(written.ptr - text), text, expected);
+		failures++;
+	}
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void check_read(const char* name, const char* text, fp_chars_status status, size_t read, IntegerType expected){
+	// Invalid text leaves the value unchanged, so it starts as another one
+	const IntegerType content = status == fp_chars_invalid ? IntegerType(expected ^ 1) : expected;
+	FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value(content);
+	const fp_from_chars_result result = fp_from_chars(text, text + std::strlen(text), value);
+	if (result.status != status || size_t(result.ptr - text) != read || value() != content){
+		std::printf("%s: \"%s\" reads %u characters as %llx with status %d, expected %u as %llx with status %d\n", name, text,
+			unsigned(result.ptr - text), (unsigned long long int)value(), int(result.status), unsigned(read), (unsigned long long int)content, int(status));
+		failures++;
+	}
+}
+
+int main(){
+	typedef FixedPoint<short int, 7, 8> q7_8;
+	typedef FixedPoint<int, 31, 0> q31_0;
+	typedef FixedPoint<unsigned int, 0, 32> uq0_32;
+	typedef FixedPoint<long long int, 0, 63> q0_63;
+	typedef FixedPoint<unsigned long long int, 0, 64> uq0_64;
+	typedef FixedPoint<unsigned long long int, 64, 0> uq64_0;
+
+	check_round_trips<short int, 7, 8>("q7_8");
+	check_round_trips<unsigned short int, 0, 16>("uq0_16");
+	check_round_trips<int, 15, 16>("q15_16");
+	check_round_trips<int, 31, 0>("q31_0");
+	check_round_trips<unsigned int, 0, 32>("uq0_32");
+	check_round_trips<long long int, 23, 40>("q23_40");
+	check_round_trips<long long int, 0, 63>("q0_63");
+	check_round_trips<unsigned long long int, 0, 64>("uq0_64");
+	check_round_trips<unsigned long long int, 64, 0>("uq64_0");
+
+	// Shortest text, and exact text with as many decimals as fractional bits
+	check_text("q7_8", q7_8(short(1)), "0.004");
+	check_text("q7_8", q7_8(short(1)), "0.00390625", 8);
+	check_text("q7_8", q7_8(short(-384)), "-1.5");
+	check_text("q7_8", q7_8(short(0x7FFF)), "127.996");
+	check_text("q7_8", q7_8(short(-0x8000)), "-128");
+	check_text("q7_8", q7_8(short(640)), "2", 0);
+	check_text("q7_8", q7_8(short(896)), "4", 0);
+	check_text("q31_0", q31_0(std::numeric_limits<int>::min()), "-2147483648");
+	check_text("q31_0", q31_0(std::numeric_limits<int>::max()), "2147483647.00", 2);
+	check_text("uq0_32", uq0_32(0x80000000u), "0.5");
+	check_text("uq0_32", uq0_32(0xFFFFFFFFu), "1", 0);
+	check_text("q0_63", q0_63(std::numeric_limits<long long int>::min()), "-1");
+	check_text("uq0_64", uq0_64(1ull), "0.0000000000000000000542101086242752217003726400434970855712890625", 64);
+	check_text("uq64_0", uq64_0(~0ull), "18446744073709551615");
+
+	// Nothing is written to a buffer that is too small
+	char small[3] = {'x', 'x', 'x'};
+	const fp_to_chars_result too_small = fp_to_chars(small, small + 3, q7_8(short(-384)));
+	if (too_small.status != fp_chars_buffer_too_small || too_small.ptr != small + 3 || small[0] != 'x'){
+		std::printf("q7_8: -1.5 was written to a buffer of 3 characters\n");
+		failures++;
+	}
+
+	// Midpoints round to even, and any later digit breaks the tie
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "0.001953125", fp_chars_ok, 11, 0);
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "0.005859375", fp_chars_ok, 11, 2);
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "0.0019531250000000000000000001", fp_chars_ok, 30, 1);
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "-0.0019531250000000000000000001", fp_chars_ok, 31, -1);
+	check_read<short int, 7, 8, fp_wrap>("q7_8", ".5", fp_chars_ok, 2, 128);
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "5.", fp_chars_ok, 2, 1280);
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "00000000000000000000001.25", fp_chars_ok, 26, 320);
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "127.99609375", fp_chars_ok, 12, 0x7FFF);
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "-128", fp_chars_ok, 4, -0x8000);
+	check_read<unsigned int, 0, 32, fp_wrap>("uq0_32", "0.99999999976716935634613037109375", fp_chars_ok, 34, 0xFFFFFFFFu);
+	check_read<unsigned long long int, 0, 64, fp_wrap>("uq0_64", "0.0000000000000000000542101086242752217003726400434970855712890625", fp_chars_ok, 66, 1ull);
+	check_read<unsigned long long int, 64, 0, fp_wrap>("uq64_0", "18446744073709551615", fp_chars_ok, 20, ~0ull);
+	check_read<long long int, 0, 63, fp_wrap>("q0_63", "-1", fp_chars_ok, 2, std::numeric_limits<long long int>::min());
+
+	// Values outside the format are given by the overflow policy
+	check_read<short int, 7, 8, fp_saturate>("q7_8_saturate", "128", fp_chars_out_of_range, 3, 0x7FFF);
+	check_read<short int, 7, 8, fp_saturate>("q7_8_saturate", "-128.002", fp_chars_out_of_range, 8, -0x8000);
+	check_read<short int, 7, 8, fp_saturate>("q7_8_saturate", "127.999", fp_chars_out_of_range, 7, 0x7FFF);
+	check_read<short int, 7, 8, fp_saturate>("q7_8_saturate", "99999999999999999999999", fp_chars_out_of_range, 23, 0x7FFF);
+	check_read<unsigned int, 0, 32, fp_saturate>("uq0_32_saturate", "-0.5", fp_chars_out_of_range, 4, 0);
+	check_read<unsigned long long int, 64, 0, fp_saturate>("uq64_0_saturate", "18446744073709551616", fp_chars_out_of_range, 20, ~0ull);
+	check_read<long long int, 0, 63, fp_wrap>("q0_63", "1", fp_chars_out_of_range, 1, std::numeric_limits<long long int>::min());
+
+	// Text without a number is rejected, and reading stops at the first character that is not part of one
+	const char* const invalid[] = {"", "-", ".", "-.", "+1", "abc", "e5", " 1", "--1", "-x"};
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++){
+		check_read<short int, 7, 8, fp_wrap>("q7_8", invalid[i], fp_chars_invalid, 0, 0x123);
+	}
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "1e5", fp_chars_ok, 1, 256);
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "1.5.5", fp_chars_ok, 3, 384);
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "2-", fp_chars_ok, 1, 512);
+	check_read<short int, 7, 8, fp_wrap>("q7_8", "-0", fp_chars_ok, 2, 0);
+
+	// Delimited values, which stop at text that is not a number followed by a separator
+	q7_8 values[4];
+	size_t read = 0;
+	const char list[] = "1, 2.5\n-3\t";
+	fp_from_chars_result listed = fp_from_chars(list, list + sizeof(list) - 1, values, 4, read);
+	if (listed.status != fp_chars_ok || read != 3 || values[0]() != 256 || values[1]() != 640 || values[2]() != -768){
+		std::printf("q7_8: \"%s\" reads %u values with status %d\n", list, unsigned(read), int(listed.status));
+		failures++;
+	}
+	const char malformed[] = "1,2x,3";
+	listed = fp_from_chars(malformed, malformed + sizeof(malformed) - 1, values, 4, read);
+	if (listed.status != fp_chars_invalid || read != 1 || listed.ptr != malformed + 2){
+		std::printf("q7_8: \"%s\" reads %u values with status %d\n", malformed, unsigned(read), int(listed.status));
+		failures++;
+	}
+
+	if (failures){
+		std::printf("%d failures\n", failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,230 @@
+/**
+ *	@file fp_convert_float.cpp
+ *	Checks that the vector conversions of fp_convert.h give the same contents and values as the scalar loop,
+ *	for every format width, including NaN, infinities, halves, and values at and past the limits of the format
+ *	and that the same values are out of range, which fp_trap counts here
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+// Counts the values out of range instead of aborting
+static int traps = 0;
+#define FIXEDPOINT_TRAP() (++traps)
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_convert.h"
+
+static int failures = 0;
+
+static unsigned long long int random_bits(){
+	static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+// Contents of any magnitude, since 64 bit values are only converted by vectors below 2^51
+template<typename IntegerType>
+IntegerType random_content(){
+	const long long int bits = (long long int)random_bits();
+	return IntegerType(random_bits() % 2 ? bits : bits / (1LL << (random_bits() % 63)));
+}
+
+// Values around the limits of the format, halves between contents, and values that are not numbers
+template<typename IntegerType, count_type FractionalBits>
+std::vector<double> special_values(){
+	const double unit = std::ldexp(1.0, -int(FractionalBits));
+	const double largest = double(std::numeric_limits<IntegerType>::max()) * unit;
+	const double smallest = double(std::numeric_limits<IntegerType>::min()) * unit;
+	const double values[] = {
+		0.0, -0.0, unit, -unit, unit / 2, -unit / 2, 1.5 * unit, -1.5 * unit, 2.5 * unit, -2.5 * unit, unit / 4, unit * 0.75,
+		largest, largest - unit / 2, largest + unit / 2, largest + unit, largest * 2, -largest,
+		smallest, smallest - unit / 2, smallest + unit / 2, smallest - unit, smallest * 2 - unit,
+		std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN(),
+		std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(), std::numeric_limits<double>::denorm_min(), 1e30, -1e30,
+		// Around the limits of the int32 lanes and of the 2^51 range of the 64 bit kernel
+		2147483647.5 * unit, 2147483648.0 * unit, -2147483648.5 * unit, 4294967295.5 * unit, 4294967296.0 * unit,
+		2251799813685247.5 * unit, 2251799813685248.0 * unit, -2251799813685248.0 * unit, -2251799813685248.5 * unit
+	};
+	return std::vector<double>(values, values + sizeof(values) / sizeof(values[0]));
+}
+
+// Values must match bit for bit, so NaN is not compared with ==
+template<typename Float>
+bool same_float(Float a, Float b){
+	return std::memcmp(&a, &b, sizeof(Float)) == 0;
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy, typename Float>
+void check_from(const char* name, const char* type, const std::vector<Float>& in){
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	typedef _fp_convert_scalar<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, fp_nan_zero> scalar;
+
+	const size_t length = in.size();
+	std::vector<value_type> out(length + 1);
+	std::vector<IntegerType> expected(length + 1);
+	// Every offset and length of the tail, so that each value goes through the vector loop and the scalar one
+	for (size_t offset = 0; offset < 3 && offset < length; offset++){
+		for (size_t count = 0; offset + count <= length; count += count < 20 ? 1 : 37){
+			traps = 0;
+			fp_from_float(&out[0], &in[offset], count);
+			const int vector_traps = traps;
+			traps = 0;
+			scalar::from(&expected[0], &in[offset], count, std::ldexp(1.0, FractionalBits));
+			if (vector_traps != traps){
+				std::printf("%s from %s: %d values out of range from %u, the scalar loop finds %d\n", name, type, vector_traps, unsigned(offset), traps);
+				failures++;
+				return;
+			}
+			for (size_t i = 0; i < count; i++){
+				if (out[i]() != expected[i]){
+					std::printf("%s from %s: %.17g converts to %llx, the scalar loop gives %llx\n", name, type, double(in[offset + i]), (unsigned long long int)out[i](), (unsigned long long int)expected[i]);
+					failures++;
+					return;
+				}
+			}
+		}
+	}
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy, typename Float>
+void check_to(const char* name, const char* type, const std::vector<IntegerType>& contents){
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	typedef _fp_convert_scalar<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, fp_nan_zero> scalar;
+
+	const size_t length = contents.size();
+	std::vector<value_type> in(length);
+	for (size_t i = 0; i < length; i++){
+		in[i] = value_type(contents[i]);
+	}
+	std::vector<Float> out(length + 1), expected(length + 1);
+	for (size_t offset = 0; offset < 3 && offset < length; offset++){
+		for (size_t count = 0; offset + count <= length; count += count < 20 ? 1 : 37){
+			fp_to_float(&out[0], &in[offset], count);
+			scalar::to(&expected[0], &contents[offset], count, Float(std::ldexp(1.0, -int(FractionalBits))));
+			for (size_t i = 0; i < count; i++){
+				if (!same_float(out[i], expected[i])){
+					std::printf("%s to %s: %llx converts to %.17g, the scalar loop gives %.17g\n", name, type, (unsigned long long int)contents[offset + i], double(out[i]), double(expected[i]));
+					failures++;
+					return;
+				}
+			}
+		}
+	}
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void check(const char* name){
+	const double unit = std::ldexp(1.0, -int(FractionalBits));
+	const std::vector<double> specials = special_values<IntegerType, FractionalBits>();
+
+	// Blocks of values in range, which the vector loop converts
+	std::vector<double> doubles;
+	std::vector<IntegerType> contents;
+	for (size_t i = 0; i < 400; i++){
+		const IntegerType content = random_content<IntegerType>();
+		contents.push_back(content);
+		// A content, or halfway to the next one
+		doubles.push_back((double(content) + double(random_bits() % 3) * 0.5) * unit);
+	}
+	// Values of any magnitude around the range of the format
+	for (size_t i = 0; i < 200; i++){
+		doubles.push_back(std::ldexp(double(int(random_bits() % 2001) - 1000), int(IntegerBits) - 10 + int(random_bits() % 12)));
+	}
+	// Each special value alone in a block of 8 values in range, at every position
+	for (size_t i = 0; i < specials.size(); i++){
+		for (size_t j = 0; j < 8; j++){
+			doubles.push_back(j == i % 8 ? specials[i] : double(random_content<IntegerType>()) * unit);
+		}
+	}
+	contents.push_back(std::numeric_limits<IntegerType>::min());
+	contents.push_back(std::numeric_limits<IntegerType>::max());
+	contents.push_back(IntegerType(std::numeric_limits<IntegerType>::max() - 1));
+	contents.push_back(IntegerType(std::numeric_limits<IntegerType>::min() + 1));
+
+	std::vector<float> floats(doubles.size());
+	for (size_t i = 0; i < doubles.size(); i++){
+		// Casting a double out of the range of float is undefined, so those become infinities
+		floats[i] = std::fabs(doubles[i]) <= double(std::numeric_limits<float>::max()) || doubles[i] != doubles[i] ?
+			float(doubles[i]) : (doubles[i] > 0 ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity());
+	}
+
+	check_from<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(name, "double", doubles);
+	check_from<IntegerType, IntegerBits, FractionalBits, OverflowPolicy>(name, "float", floats);
+	check_to<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, double>(name, "double", contents);
+	check_to<IntegerType, IntegerBits, FractionalBits, OverflowPolicy, float>(name, "float", contents);
+}
+
+// Values past the limits give the closest content, NaN gives zero, and halves round to even
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits, typename OverflowPolicy>
+void check_limits(const char* name){
+	typedef FixedPoint<IntegerType, IntegerBits, FractionalBits, OverflowPolicy> value_type;
+	const double unit = std::ldexp(1.0, -int(FractionalBits));
+	const double largest = double(std::numeric_limits<IntegerType>::max()) * unit;
+	const double smallest = double(std::numeric_limits<IntegerType>::min()) * unit;
+	const double in[16] = {
+		std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN(), largest * 4,
+		smallest * 4 - 1, 2.5 * unit, 3.5 * unit, -0.0,
+		1e300, -1e300, unit / 2, 1.5 * unit, 0, 0, 0, 0
+	};
+	const IntegerType max = std::numeric_limits<IntegerType>::max();
+	const IntegerType min = std::numeric_limits<IntegerType>::min();
+	const IntegerType expected[16] = {max, min, 0, max, min, 2, 4, 0, max, min, 0, 2, 0, 0, 0, 0};
+
+	// The first 8 values are together in one vector block, the next 8 one at a time
+	value_type out[16];
+	fp_from_float(out, in, 8);
+	for (size_t i = 8; i < 16; i++){
+		fp_from_float(out + i, in + i, 1);
+	}
+	for (size_t i = 0; i < 16; i++){
+		if (out[i]() != expected[i]){
+			std::printf("%s: %.17g converts to %llx, expected %llx\n", name, in[i], (unsigned long long int)out[i](), (unsigned long long int)expected[i]);
+			failures++;
+		}
+	}
+}
+
+int main(){
+	check<signed char, 3, 4, fp_wrap>("q3_4");
+	check<signed char, 3, 4, fp_trap>("q3_4_trap");
+	check<unsigned char, 0, 8, fp_trap>("uq0_8_trap");
+	check<unsigned char, 0, 8, fp_saturate>("uq0_8");
+	check<short int, 7, 8, fp_wrap>("q7_8");
+	check<short int, 7, 8, fp_trap>("q7_8_trap");
+	check<unsigned short int, 0, 16, fp_trap>("uq0_16_trap");
+	check<short int, 0, 15, fp_saturate>("q0_15");
+	check<unsigned short int, 0, 16, fp_saturate>("uq0_16");
+	check<int, 15, 16, fp_wrap>("q15_16");
+	check<int, 15, 16, fp_trap>("q15_16_trap");
+	check<int, 31, 0, fp_trap>("q31_0_trap");
+	check<int, 31, 0, fp_saturate>("q31_0");
+	check<unsigned int, 0, 32, fp_saturate>("uq0_32");
+	check<unsigned int, 32, 0, fp_wrap>("uq32_0");
+	check<unsigned int, 0, 32, fp_trap>("uq0_32_trap");
+	check<long long int, 23, 40, fp_wrap>("q23_40");
+	check<long long int, 23, 40, fp_trap>("q23_40_trap");
+	check<unsigned long long int, 64, 0, fp_trap>("uq64_0_trap");
+	check<long long int, 63, 0, fp_saturate>("q63_0");
+	check<unsigned long long int, 0, 64, fp_saturate>("uq0_64");
+
+	check_limits<signed char, 3, 4, fp_saturate>("q3_4");
+	check_limits<short int, 7, 8, fp_saturate>("q7_8");
+	check_limits<unsigned short int, 0, 16, fp_wrap>("uq0_16");
+	check_limits<int, 15, 16, fp_saturate>("q15_16");
+	check_limits<unsigned int, 0, 32, fp_saturate>("uq0_32");
+	check_limits<long long int, 23, 40, fp_wrap>("q23_40");
+	check_limits<unsigned long long int, 0, 64, fp_saturate>("uq0_64");
+
+	if (failures){
+		std::printf("%d failures\n", failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,290 @@
+/**
+ *	@file fp_fft_transform.cpp
+ *	Checks FixedPointFft against a naive DFT computed in double, that an inverse transform after a forward one gives back the input,
+ *	that the block floating point exponents are exact for impulses and scale no more than overflow needs,
+ *	and that the SSE2 16 bit butterflies give the same contents as the scalar ones
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_fft.h"
+
+static int failures = 0;
+
+static unsigned long long int random_bits(){
+	static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+static const double pi = 3.14159265358979323846;
+
+// Values of the transform of contents, in units of the input contents, or of its inverse with the 1 / size factor
+static void dft(const std::vector<double>& real, const std::vector<double>& imag, bool inverse, std::vector<double>& out_real, std::vector<double>& out_imag){
+	const size_t size = real.size();
+	std::vector<double> cosine(size), sine(size);
+	for (size_t i = 0; i < size; i++){
+		cosine[i] = std::cos(2 * pi * double(i) / double(size));
+		sine[i] = (inverse ? 1 : -1) * std::sin(2 * pi * double(i) / double(size));
+	}
+	out_real.assign(size, 0);
+	out_imag.assign(size, 0);
+	for (size_t k = 0; k < size; k++){
+		double sum_real = 0, sum_imag = 0;
+		for (size_t n = 0; n < size; n++){
+			const size_t index = n * k % size;
+			sum_real += real[n] * cosine[index] - imag[n] * sine[index];
+			sum_imag += real[n] * sine[index] + imag[n] * cosine[index];
+		}
+		out_real[k] = inverse ? sum_real / double(size) : sum_real;
+		out_imag[k] = inverse ? sum_imag / double(size) : sum_imag;
+	}
+}
+
+template<typename IntegerType, count_type IntegerBits>
+class Checker{
+public:
+	typedef FixedPointFft<IntegerType, IntegerBits> fft_type;
+	typedef typename fft_type::value_type complex_type;
+	typedef typename complex_type::value_type value_type;
+
+	static const count_type digits = std::numeric_limits<IntegerType>::digits;
+
+	const char* name;
+	const fft_type fft;
+	count_type bits;
+
+	Checker(const char* _name, size_t size) : name(_name), fft(size), bits(0){
+		while ((size_t(1) << bits) < size){
+			bits++;
+		}
+	}
+
+	std::vector<complex_type> values(const std::vector<double>& real, const std::vector<double>& imag) const{
+		std::vector<complex_type> result(real.size());
+		for (size_t i = 0; i < real.size(); i++){
+			result[i] = complex_type(value_type(IntegerType(real[i])), value_type(IntegerType(imag[i])));
+		}
+		return result;
+	}
+
+	// Largest difference between contents times 2^exponent and the reference, in units of 2^exponent
+	static double error(const std::vector<complex_type>& result, int exponent, const std::vector<double>& real, const std::vector<double>& imag){
+		double largest = 0;
+		for (size_t i = 0; i < result.size(); i++){
+			largest = std::max(largest, std::fabs(double(result[i].real()()) - std::ldexp(real[i], -exponent)));
+			largest = std::max(largest, std::fabs(double(result[i].imag()()) - std::ldexp(imag[i], -exponent)));
+		}
+		return largest;
+	}
+
+	static IntegerType largest_magnitude(const std::vector<complex_type>& result){
+		IntegerType largest = 0;
+		for (size_t i = 0; i < result.size(); i++){
+			largest = std::max(largest, IntegerType(std::abs((long long int)result[i].real()())));
+			largest = std::max(largest, IntegerType(std::abs((long long int)result[i].imag()())));
+		}
+		return largest;
+	}
+
+	// In units of the result, for passes that scaled by 2^exponent in all. Each pass rounds by a few units at its own scale,
+	// plus the error of its twiddles relative to values that fill the type. Biased roundings such as truncation grow
+	// up to 4 times with every later radix 4 pass, by up to 4 / 3 size in all, unless those passes scale them away again
+	double tolerance(int exponent) const{
+		return 2.0 * double(bits) + 2.0 + std::ldexp(4.0 * double(fft.size()) / 3.0, -exponent);
+	}
+
+	// Random contents of the given number of bits, transformed both ways
+	void check_random(count_type length){
+		const size_t size = fft.size();
+		std::vector<double> real(size), imag(size);
+		for (size_t i = 0; i < size; i++){
+			real[i] = double((long long int)random_bits() >> (64 - length));
+			imag[i] = double((long long int)random_bits() >> (64 - length));
+		}
+		std::vector<double> expected_real, expected_imag;
+		dft(real, imag, false, expected_real, expected_imag);
+
+		const std::vector<complex_type> input = values(real, imag);
+		std::vector<complex_type> transform(size);
+		const int exponent = fft.forward(&transform[0], &input[0]);
+		const double forward_error = error(transform, exponent, expected_real, expected_imag);
+		if (forward_error > tolerance(exponent)){
+			std::printf("%s: forward transform of %u values of %u bits is %g units from the DFT\n", name, unsigned(size), unsigned(length), forward_error);
+			failures++;
+		}
+		// Only as much scaling as overflow needs: the largest result reaches the last 3 bits of growth a pass allows for
+		if (exponent > 0 && largest_magnitude(transform) < (IntegerType(1) << (digits - 5))){
+			std::printf("%s: forward transform of %u values of %u bits has an exponent of %d but its largest content is %lld\n", name, unsigned(size), unsigned(length), exponent,
+				(long long int)largest_magnitude(transform));
+			failures++;
+		}
+		if (length + bits + 1 < digits && exponent != 0){
+			std::printf("%s: forward transform of %u values of %u bits fits without scaling, but has an exponent of %d\n", name, unsigned(size), unsigned(length), exponent);
+			failures++;
+		}
+
+		// The inverse of the transform, against the inverse DFT of that transform and against the input
+		std::vector<double> transform_real(size), transform_imag(size);
+		for (size_t i = 0; i < size; i++){
+			transform_real[i] = double(transform[i].real()());
+			transform_imag[i] = double(transform[i].imag()());
+		}
+		std::vector<double> inverse_real, inverse_imag;
+		dft(transform_real, transform_imag, true, inverse_real, inverse_imag);
+		std::vector<complex_type> round_trip(transform);
+		const int inverse_exponent = fft.inverse(&round_trip[0]);
+		const double inverse_error = error(round_trip, inverse_exponent, inverse_real, inverse_imag);
+		if (inverse_error > tolerance(inverse_exponent + int(bits))){
+			std::printf("%s: inverse transform of %u values is %g units from the inverse DFT\n", name, unsigned(size), inverse_error);
+			failures++;
+		}
+		// Both errors in units of the input, where the inverse transform spreads the forward error without growing it
+		const double trip_error = error(round_trip, inverse_exponent + exponent, real, imag) * std::ldexp(1.0, inverse_exponent + exponent);
+		if (trip_error > tolerance(exponent) * std::ldexp(1.0, exponent) + tolerance(inverse_exponent + int(bits)) * std::ldexp(1.0, inverse_exponent + exponent)){
+			std::printf("%s: forward and inverse transforms of %u values of %u bits are %g from the input, with exponents %d and %d\n", name, unsigned(size), unsigned(length),
+				trip_error, exponent, inverse_exponent);
+			failures++;
+		}
+	}
+
+	// A unit impulse transforms to ones without scaling, and ones transform back to size at 0 with an exponent of -bits
+	void check_impulse(){
+		const size_t size = fft.size();
+		std::vector<complex_type> data(size);
+		data[0] = complex_type(value_type(IntegerType(1)));
+		const int exponent = fft.forward(&data[0]);
+		for (size_t i = 0; i < size; i++){
+			if (exponent != 0 || data[i].real()() != 1 || data[i].imag()() != 0){
+				std::printf("%s: impulse of %u values transforms to (%lld, %lld) at %u with an exponent of %d\n", name, unsigned(size), (long long int)data[i].real()(),
+					(long long int)data[i].imag()(), unsigned(i), exponent);
+				failures++;
+				return;
+			}
+		}
+		const int inverse_exponent = fft.inverse(&data[0]);
+		if (inverse_exponent != -int(bits) || data[0].real()() != IntegerType(size) || data[0].imag()() != 0){
+			std::printf("%s: inverse of ones of %u values is (%lld, %lld) with an exponent of %d\n", name, unsigned(size), (long long int)data[0].real()(),
+				(long long int)data[0].imag()(), inverse_exponent);
+			failures++;
+		}
+	}
+
+	// The largest constant transforms to size times it at 0, which grows every pass to the limit of the type, and zeros elsewhere
+	void check_constant(){
+		const size_t size = fft.size();
+		const IntegerType max = std::numeric_limits<IntegerType>::max();
+		std::vector<complex_type> data(size, complex_type(value_type(max), value_type(IntegerType(-max))));
+		const int exponent = fft.forward(&data[0]);
+		const std::vector<double> real(size, 0), imag(size, 0);
+		std::vector<double> expected_real(real), expected_imag(imag);
+		expected_real[0] = double(max) * double(size);
+		expected_imag[0] = -double(max) * double(size);
+		const double constant_error = error(data, exponent, expected_real, expected_imag);
+		// The sum needs digits + bits bits, and the headroom a pass keeps for growth leaves at most 2 of them unused at the top
+		if (constant_error > tolerance(exponent) || exponent < int(bits) || exponent > int(bits) + 2){
+			std::printf("%s: constant of %u values transforms with an exponent of %d, %g units from the DFT\n", name, unsigned(size), exponent, constant_error);
+			failures++;
+		}
+	}
+
+	// Contents at the limits whose signs follow e^(2 pi i frequency n / size), so that the transform peaks at frequency
+	// with about 1.27 size times the largest content, more than radix 4 passes that only allowed for growing 4 times could hold
+	void check_tone(size_t frequency){
+		const size_t size = fft.size();
+		const IntegerType max = std::numeric_limits<IntegerType>::max();
+		std::vector<double> real(size), imag(size);
+		for (size_t n = 0; n < size; n++){
+			const double angle = 2 * pi * double(n * frequency % size) / double(size);
+			real[n] = std::cos(angle) < 0 ? -double(max) : double(max);
+			imag[n] = std::sin(angle) < 0 ? -double(max) : double(max);
+		}
+		std::vector<double> expected_real, expected_imag;
+		dft(real, imag, false, expected_real, expected_imag);
+		std::vector<complex_type> data = values(real, imag);
+		const int exponent = fft.forward(&data[0]);
+		const double tone_error = error(data, exponent, expected_real, expected_imag);
+		if (tone_error > tolerance(exponent)){
+			std::printf("%s: tone at %u of %u values is %g units from the DFT\n", name, unsigned(frequency), unsigned(size), tone_error);
+			failures++;
+		}
+	}
+};
+
+template<typename IntegerType, count_type IntegerBits>
+void check(const char* name){
+	for (size_t size = 1; size <= 1024; size *= 2){
+		Checker<IntegerType, IntegerBits> checker(name, size);
+		checker.check_impulse();
+		if (size > 1){
+			checker.check_constant();
+			for (size_t frequency = 1; frequency < size; frequency = frequency * 3 + 1){
+				checker.check_tone(frequency);
+			}
+		}
+		// Small values that need no scaling, values at the limits of the type, and in between
+		const count_type digits = std::numeric_limits<IntegerType>::digits;
+		checker.check_random(3);
+		checker.check_random(digits - 11 > 3 ? digits - 11 : 3);
+		checker.check_random(digits / 2);
+		checker.check_random(digits - 1);
+		checker.check_random(digits + 1);
+	}
+}
+
+#ifdef FIXEDPOINT_SSE2
+	// The vector butterflies against the scalar ones, for every size of the 4 value blocks and its tail, and for every shift
+	template<bool HalfUp, bool Inverse>
+	void check_kernel16(const char* name){
+		typedef typename _fp_select<HalfUp, fp_round_half_up, fp_round_truncate>::type rounding;
+		for (size_t h = 1; h <= 64; h++){
+			const size_t size = 4 * h * (1 + random_bits() % 3);
+			for (count_type scale = 0; scale < 4; scale++){
+				std::vector<short int> data(2 * size), expected(2 * size), twiddles(6 * h);
+				// Magnitudes below 2^(12 + scale), as the plan picks the shift for, so that results fit. Every 11th one at that limit
+				const int limit = (1 << (12 + scale)) - 1;
+				for (size_t i = 0; i < data.size(); i++){
+					data[i] = expected[i] = short(i % 11 ? int(random_bits() % (2 * limit + 1)) - limit : (i % 2 ? -limit : limit));
+				}
+				// Twiddles have 14 fractional bits, at most 1 in magnitude
+				for (size_t i = 0; i < twiddles.size(); i++){
+					twiddles[i] = i % 13 ? short(int(random_bits() % 32769) - 16384) : short(i % 2 ? -16384 : 16384);
+				}
+				const unsigned short int magnitude = _fp_fft_kernel16<HalfUp>::template radix4<Inverse>(&data[0], size, h, &twiddles[0], scale);
+				const unsigned short int expected_magnitude = _fp_fft_scalar<short int, rounding>::template radix4<Inverse>(&expected[0], size, h, &twiddles[0], scale);
+				if (data != expected || magnitude != expected_magnitude){
+					std::printf("%s: radix 4 pass of %u values with a quarter of %u and a shift of %u differs from the scalar loop\n", name, unsigned(size), unsigned(h), unsigned(scale));
+					failures++;
+					return;
+				}
+			}
+		}
+	}
+#endif
+
+int main(){
+	check<short int, 7>("q7_8");
+	check<int, 15>("q15_16");
+
+	#ifdef FIXEDPOINT_SSE2
+		check_kernel16<false, false>("truncate forward");
+		check_kernel16<false, true>("truncate inverse");
+		check_kernel16<true, false>("half up forward");
+		check_kernel16<true, true>("half up inverse");
+	#endif
+
+	if (failures){
+		std::printf("%d failures\n", failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,165 @@
+/**
+ *	@file fp_filter_biquad.cpp
+ *	Checks that the vector biquad kernel of fp_filter.h gives the same samples as the scalar loop for every policy it supports,
+ *	with contents at the limits of the type, and that filtering interleaved channels gives the same samples as filtering each channel on its own
+ */
+
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_filter.h"
+
+static int failures = 0;
+
+static unsigned long long int random_bits(){
+	static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+template<typename IntegerType>
+IntegerType random_content(size_t index){
+	switch (index % 7){
+		case 0: return std::numeric_limits<IntegerType>::min();
+		case 1: return std::numeric_limits<IntegerType>::max();
+		default: return IntegerType(random_bits());
+	}
+}
+
+// Coefficients whose magnitudes add up to less than 2^16, as the 16 bit kernel needs, at the limit of that every few sections
+template<typename IntegerType>
+void random_section(IntegerType* b, size_t index){
+	static const IntegerType limit[5] = {IntegerType(-32768), 32767, 0, 0, 0};
+	for (size_t i = 0; i < 5; i++){
+		b[i] = index % 5 ? IntegerType(IntegerType(random_bits()) % 13107) : limit[i];
+	}
+}
+
+// Filters the channels of one section with the kernel, and checks them against the scalar sums rescaled by the same policies
+template<typename IntegerType, typename Rounding, typename OverflowPolicy>
+void check_kernel(const char* name, count_type shift){
+	typedef _fp_biquad_kernel<IntegerType> kernel;
+	static const size_t channels = 19;
+
+	for (size_t round = 0; round < 64; round++){
+		IntegerType b[5], input[channels], state[4][channels], output[channels];
+		random_section(b, round);
+		for (size_t channel = 0; channel < channels; channel++){
+			input[channel] = random_content<IntegerType>(round + channel);
+			for (size_t i = 0; i < 4; i++){
+				state[i][channel] = random_content<IntegerType>(round + 3 * i + channel);
+			}
+		}
+		IntegerType expected[channels];
+		for (size_t channel = 0; channel < channels; channel++){
+			_fp_accumulator<IntegerType> accumulator;
+			accumulator.template mul_add<false>(b[0], input[channel]);
+			accumulator.template mul_add<false>(b[1], state[0][channel]);
+			accumulator.template mul_add<false>(b[2], state[1][channel]);
+			accumulator.template mul_add<true>(b[3], state[2][channel]);
+			accumulator.template mul_add<true>(b[4], state[3][channel]);
+			IntegerType content = 0;
+			const bool overflow = accumulator.template result<Rounding>(shift, content);
+			expected[channel] = OverflowPolicy::fit(content, overflow, accumulator.negative());
+		}
+
+		const IntegerType x1 = state[0][0], y1 = state[2][0];
+		const size_t filtered = kernel::template filter<Rounding, OverflowPolicy>(b, shift, input, output, state[0], state[1], state[2], state[3], channels);
+		if (filtered != channels - channels % kernel::step){
+			std::printf("%s: the kernel filtered %lu channels\n", name, (unsigned long)filtered);
+			failures++;
+			return;
+		}
+		for (size_t channel = 0; channel < filtered; channel++){
+			if (output[channel] != expected[channel] || state[2][channel] != expected[channel] || state[0][channel] != input[channel]){
+				std::printf("%s: channel %lu rescaled by %u differs from the scalar loop\n", name, (unsigned long)channel, (unsigned)shift);
+				failures++;
+				return;
+			}
+		}
+		if (filtered && (state[1][0] != x1 || state[3][0] != y1)){
+			std::printf("%s: the state of channel 0 was not shifted\n", name);
+			failures++;
+			return;
+		}
+	}
+}
+
+template<typename IntegerType>
+void check_kernels(const char* name){
+	// Sections whose sums may not fit in 32 bits are left to the scalar loop
+	typedef _fp_biquad_kernel<IntegerType> kernel;
+	const IntegerType large[5] = {IntegerType(-32768), IntegerType(-32768), 0, 0, 0};
+	IntegerType unused[kernel::step * 6] = {};
+	if (kernel::template filter<fp_round_truncate, fp_wrap>(large, 0, unused, unused, unused, unused, unused, unused, kernel::step)){
+		std::printf("%s: the kernel filtered a section whose sums do not fit\n", name);
+		failures++;
+	}
+
+	for (count_type shift = 0; shift < count_type(std::numeric_limits<IntegerType>::digits); shift++){
+		check_kernel<IntegerType, fp_round_truncate, fp_wrap>(name, shift);
+		check_kernel<IntegerType, fp_round_truncate, fp_saturate>(name, shift);
+		check_kernel<IntegerType, fp_round_half_up, fp_wrap>(name, shift);
+		check_kernel<IntegerType, fp_round_half_up, fp_saturate>(name, shift);
+	}
+}
+
+template<typename IntegerType, typename OverflowPolicy>
+void check_channels(const char* name){
+	typedef FixedPointBiquad<IntegerType, 0, std::numeric_limits<IntegerType>::digits, OverflowPolicy, std::numeric_limits<IntegerType>::digits - 1> filter_type;
+	typedef typename filter_type::value_type value_type;
+	typedef typename filter_type::coefficient_type coefficient_type;
+	static const size_t sections = 2, frames = 64;
+
+	// The first section may be filtered by a vector kernel, the second has sums too large for one
+	IntegerType raw[5 * sections];
+	random_section(raw, 1);
+	for (size_t i = 5; i < 5 * sections; i++){
+		raw[i] = random_content<IntegerType>(i);
+	}
+	coefficient_type coefficients[5 * sections];
+	for (size_t i = 0; i < 5 * sections; i++){
+		coefficients[i] = coefficient_type(raw[i]);
+	}
+
+	// Every channel count up to a few vectors, so that both the vector steps and the remaining channels are filtered
+	for (size_t channels = 1; channels <= 19; channels++){
+		std::vector<value_type> in(frames * channels), out(frames * channels);
+		for (size_t i = 0; i < in.size(); i++){
+			in[i] = value_type(random_content<IntegerType>(i));
+		}
+		filter_type interleaved(coefficients, sections, channels);
+		interleaved.process(&out[0], &in[0], frames);
+
+		for (size_t channel = 0; channel < channels; channel++){
+			std::vector<value_type> single_in(frames), single_out(frames);
+			for (size_t frame = 0; frame < frames; frame++){
+				single_in[frame] = in[frame * channels + channel];
+			}
+			filter_type single(coefficients, sections);
+			single.process(&single_out[0], &single_in[0], frames);
+
+			for (size_t frame = 0; frame < frames; frame++){
+				if (single_out[frame]() != out[frame * channels + channel]()){
+					std::printf("%s: channel %lu of %lu differs at frame %lu\n", name, (unsigned long)channel, (unsigned long)channels, (unsigned long)frame);
+					failures++;
+					return;
+				}
+			}
+		}
+	}
+}
+
+int main(){
+	check_kernels<short int>("short");
+	check_channels<short int, fp_wrap>("short wrap");
+	check_channels<short int, fp_saturate>("short saturate");
+	check_channels<int, fp_wrap>("int wrap");
+	check_channels<int, fp_saturate>("int saturate");
+	return failures != 0;
+}
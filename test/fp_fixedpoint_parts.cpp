@@ -0,0 +1,71 @@
+/**
+ *	@file fp_fixedpoint_parts.cpp
+ *	Checks the integer and decimal portions given by i() and d(), including formats whose fractional bits fill the IntegerType.
+ *	i() is rounded half up, so the policy decides whether a value without integer bits reads as 0 or 1
+ */
+
+// The policy must be chosen before the first include
+#define FIXEDPOINT_ROUNDING_POLICY fp_round_half_up
+
+#include <cstdio>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+
+// Shifting by the width of the type is not a constant expression, so these fail to build if d() or i() does it
+#ifdef FIXEDPOINT_CPP14
+	static_assert(FixedPoint<unsigned int, 0, 32>(0x80000000u).d() == 0x80000000u, "d() of an unsigned 0.32 format");
+	static_assert(FixedPoint<int, 0, 31>(-0x40000000).d() == 0x40000000, "d() of a signed 0.31 format");
+	static_assert(FixedPoint<unsigned int, 0, 32>(0x80000000u).i() == 1, "i() of an unsigned 0.32 format");
+	static_assert(FixedPoint<unsigned long long int, 0, 64>(0x7FFFFFFFFFFFFFFFull).i() == 0, "i() of an unsigned 0.64 format");
+#endif
+
+static int failures = 0;
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+void check_d(const char* name, IntegerType content, unsigned long long int expected){
+	const FixedPoint<IntegerType, IntegerBits, FractionalBits> value(content);
+	if ((unsigned long long int)value.d() != expected){
+		std::printf("%s: d() of %lld is %llu, expected %llu\n", name, (long long int)content, (unsigned long long int)value.d(), expected);
+		failures++;
+	}
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+void check_i(const char* name, IntegerType content, unsigned long long int expected){
+	const FixedPoint<IntegerType, IntegerBits, FractionalBits> value(content);
+	if ((unsigned long long int)value.i() != expected){
+		std::printf("%s: i() of %lld is %llu, expected %llu\n", name, (long long int)content, (unsigned long long int)value.i(), expected);
+		failures++;
+	}
+}
+
+int main(){
+	// Every bit of these formats is fractional, so d() is the whole magnitude
+	check_d<unsigned int, 0, 32>("unsigned 0.32", 0x80000000u, 0x80000000ull);
+	check_d<unsigned int, 0, 32>("unsigned 0.32", 0xFFFFFFFFu, 0xFFFFFFFFull);
+	check_d<unsigned int, 0, 32>("unsigned 0.32", 1u, 1ull);
+	check_d<int, 0, 31>("signed 0.31", 0x40000000, 0x40000000ull);
+	check_d<int, 0, 31>("signed 0.31", -0x40000000, 0x40000000ull);
+	check_d<int, 0, 31>("signed 0.31", 0x7FFFFFFF, 0x7FFFFFFFull);
+	check_d<unsigned long long int, 0, 64>("unsigned 0.64", 0x8000000000000000ull, 0x8000000000000000ull);
+
+	// Formats with integer bits keep only the fractional bits
+	check_d<int, 15, 16>("15.16", 0x00038000, 0x8000ull);
+	check_d<int, 15, 16>("15.16", -0x00038000, 0x8000ull);
+
+	// Half and more rounds up to 1, less than half down to 0
+	check_i<unsigned int, 0, 32>("unsigned 0.32", 0x80000000u, 1);
+	check_i<unsigned int, 0, 32>("unsigned 0.32", 0x7FFFFFFFu, 0);
+	check_i<unsigned int, 0, 32>("unsigned 0.32", 0xFFFFFFFFu, 1);
+	check_i<unsigned int, 0, 32>("unsigned 0.32", 0u, 0);
+	check_i<int, 0, 31>("signed 0.31", 0x40000000, 1);
+	check_i<int, 0, 31>("signed 0.31", -0x40000000, 1);
+	check_i<int, 0, 31>("signed 0.31", 0x3FFFFFFF, 0);
+	check_i<unsigned long long int, 0, 64>("unsigned 0.64", 0x8000000000000000ull, 1);
+	check_i<unsigned long long int, 0, 64>("unsigned 0.64", 0x7FFFFFFFFFFFFFFFull, 0);
+	check_i<int, 15, 16>("15.16", 0x00038000, 4);
+	check_i<int, 15, 16>("15.16", -0x00037FFF, 3);
+
+	return failures != 0;
+}
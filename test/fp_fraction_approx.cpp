@@ -0,0 +1,163 @@
+/**
+ *	@file fp_fraction_approx.cpp
+ *	Checks the conversions from FixedPoint to Fraction: the exact one, and the closest Fraction with a bounded denominator,
+ *	against the convergents of pi and a search over every denominator
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+
+static int failures = 0;
+
+static unsigned long long int random_bits(){
+	static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+typedef __int128 reference_type;
+
+static reference_type magnitude(reference_type value){
+	return value < 0 ? -value : value;
+}
+
+static reference_type gcd(reference_type a, reference_type b){
+	a = magnitude(a);
+	b = magnitude(b);
+	while (b){
+		const reference_type rest = a % b;
+		a = b;
+		b = rest;
+	}
+	return a;
+}
+
+template<typename IntegerType>
+void check_fraction(const char* name, const char* what, long long int content, const Fraction<IntegerType>& result, reference_type numerator, reference_type denominator){
+	if (reference_type(result.numerator()) != numerator || reference_type(result.denominator()) != denominator){
+		std::printf("%s: %s of %lld is %lld/%lld, expected %lld/%lld\n", name, what, content, (long long int)result.numerator(), (long long int)result.denominator(), (long long int)numerator, (long long int)denominator);
+		failures++;
+	}
+}
+
+// Closest numerator / denominator to content / 2^FractionalBits with a denominator of at most max_denominator and a numerator that fits,
+// by trying every denominator. Of two equally close, the first, with the smaller denominator, is kept
+template<typename IntegerType, count_type FractionalBits>
+void closest(IntegerType content, long long int max_denominator, reference_type& best_numerator, reference_type& best_denominator){
+	const reference_type one = reference_type(1) << FractionalBits;
+	const reference_type value = magnitude(content);
+	const reference_type max_numerator = content < 0 ? -reference_type(std::numeric_limits<IntegerType>::min()) : reference_type(std::numeric_limits<IntegerType>::max());
+	reference_type best_error = -1;
+	best_numerator = 0;
+	best_denominator = 1;
+	for (reference_type denominator = 1; denominator <= max_denominator; denominator++){
+		const reference_type below = value * denominator / one;
+		for (reference_type numerator = below; numerator <= below + 1; numerator++){
+			if (numerator > max_numerator){
+				continue;
+			}
+			// The error is |value - numerator / denominator| = error / (denominator * one)
+			const reference_type error = magnitude(value * denominator - numerator * one);
+			if (best_error < 0 || error * best_denominator < best_error * denominator){
+				best_error = error;
+				best_numerator = numerator;
+				best_denominator = denominator;
+			}
+		}
+	}
+	if (content < 0){
+		best_numerator = -best_numerator;
+	}
+}
+
+// The exact Fraction is the content over 2^FractionalBits in lowest terms, or the closest Fraction if that denominator does not fit
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+void check_exact(const char* name, IntegerType content){
+	const Fraction<IntegerType> result((FixedPoint<IntegerType, IntegerBits, FractionalBits>(content)));
+	const reference_type one = reference_type(1) << FractionalBits;
+	const reference_type divisor = gcd(content, one);
+	reference_type numerator = reference_type(content) / divisor, denominator = one / divisor;
+	if (denominator > reference_type(std::numeric_limits<IntegerType>::max())){
+		// Trying every denominator is only quick enough for 16 bits, the 32 bit cases are in main()
+		if (std::numeric_limits<IntegerType>::digits > 16){
+			return;
+		}
+		closest<IntegerType, FractionalBits>(content, (long long int)std::numeric_limits<IntegerType>::max(), numerator, denominator);
+	}
+	check_fraction(name, "exact Fraction", (long long int)content, result, numerator, denominator);
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+void check_closest(const char* name, IntegerType content, IntegerType max_denominator){
+	const Fraction<IntegerType> result(FixedPoint<IntegerType, IntegerBits, FractionalBits>(content), max_denominator);
+	reference_type numerator = 0, denominator = 1;
+	closest<IntegerType, FractionalBits>(content, (long long int)max_denominator, numerator, denominator);
+	check_fraction(name, "closest Fraction", (long long int)content, result, numerator, denominator);
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+void check_random(const char* name, long long int max_denominator){
+	for (int i = 0; i < 2000; i++){
+		const IntegerType content = IntegerType(random_bits() >> (random_bits() % 64));
+		check_exact<IntegerType, IntegerBits, FractionalBits>(name, content);
+		check_closest<IntegerType, IntegerBits, FractionalBits>(name, content, IntegerType(random_bits() % (unsigned long long int)max_denominator + 1));
+	}
+	check_exact<IntegerType, IntegerBits, FractionalBits>(name, std::numeric_limits<IntegerType>::min());
+	check_exact<IntegerType, IntegerBits, FractionalBits>(name, std::numeric_limits<IntegerType>::max());
+	check_closest<IntegerType, IntegerBits, FractionalBits>(name, std::numeric_limits<IntegerType>::min(), IntegerType(max_denominator));
+	check_closest<IntegerType, IntegerBits, FractionalBits>(name, std::numeric_limits<IntegerType>::max(), IntegerType(max_denominator));
+}
+
+template<typename IntegerType, count_type IntegerBits, count_type FractionalBits>
+void check_pi(const char* name, IntegerType max_denominator, IntegerType numerator, IntegerType denominator){
+	const FixedPoint<IntegerType, IntegerBits, FractionalBits> pi(IntegerType(std::floor(std::ldexp(3.14159265358979323846264338327950288L, FractionalBits) + 0.5L)));
+	const Fraction<IntegerType> result(pi, max_denominator);
+	check_fraction(name, "closest Fraction to pi", (long long int)max_denominator, result, numerator, denominator);
+	const Fraction<IntegerType> negative(-pi, max_denominator);
+	check_fraction(name, "closest Fraction to -pi", (long long int)max_denominator, negative, -reference_type(numerator), denominator);
+}
+
+int main(){
+	// Convergents of pi, and the best semiconvergent below a convergent's denominator
+	check_pi<int, 3, 28>("q3_28", 1, 3, 1);
+	check_pi<int, 3, 28>("q3_28", 6, 19, 6);
+	check_pi<int, 3, 28>("q3_28", 7, 22, 7);
+	check_pi<int, 3, 28>("q3_28", 100, 311, 99);
+	check_pi<int, 3, 28>("q3_28", 112, 333, 106);
+	check_pi<int, 3, 28>("q3_28", 113, 355, 113);
+	check_pi<int, 3, 28>("q3_28", 1000, 355, 113);
+	check_pi<long long int, 3, 60>("q3_60", 16603, 355, 113);
+	check_pi<long long int, 3, 60>("q3_60", 33101, 103638, 32989);
+	check_pi<long long int, 3, 60>("q3_60", 33102, 103993, 33102);
+
+	// Every denominator tried, with numerators that reach the limits of the type in the 7.8 format
+	check_random<short int, 3, 12>("q3_12", 300);
+	check_random<short int, 7, 8>("q7_8", 1000);
+	check_random<unsigned short int, 0, 16>("uq0_16", 2000);
+	check_random<int, 15, 16>("q15_16", 3000);
+	check_random<int, 0, 31>("q0_31", 3000);
+	check_random<int, 31, 0>("q31_0", 50);
+
+	// The most negative value, whose magnitude does not fit
+	const int min = std::numeric_limits<int>::min();
+	check_fraction("q0_31", "exact Fraction", min, Fraction<int>(FixedPoint<int, 0, 31>(min)), -1, 1);
+	check_fraction("q0_31", "closest Fraction", min, Fraction<int>(FixedPoint<int, 0, 31>(min), 1000), -1, 1);
+	check_fraction("q31_0", "closest Fraction", min, Fraction<int>(FixedPoint<int, 31, 0>(min), 5), min, 1);
+	check_fraction("q7_24", "exact Fraction", min, Fraction<int>(FixedPoint<int, 7, 24>(min)), -128, 1);
+
+	// A denominator of 2^32 does not fit, so the exact conversion gives the closest Fraction instead
+	check_fraction("uq0_32", "exact Fraction", 1, Fraction<unsigned int>(FixedPoint<unsigned int, 0, 32>(1u)), 1, 4294967295u);
+	check_fraction("uq0_32", "exact Fraction", 0x80000000ll, Fraction<unsigned int>(FixedPoint<unsigned int, 0, 32>(0x80000000u)), 1, 2);
+
+	if (failures){
+		std::printf("%d failures\n", failures);
+		return 1;
+	}
+	return 0;
+}
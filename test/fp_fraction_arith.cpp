@@ -0,0 +1,161 @@
+/**
+ *	@file fp_fraction_arith.cpp
+ *	Checks that Fraction arithmetic on operands in lowest terms gives the result in lowest terms whenever that result fits,
+ *	even when the products of numerators and denominators do not, against a reference computed on 128 bits
+ */
+
+#include <cstdio>
+#include <limits>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+
+static int failures = 0;
+
+static unsigned long long int random_bits(){
+	static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+typedef __int128 reference_type;
+typedef unsigned __int128 reference_unsigned_type;
+
+static reference_unsigned_type magnitude(reference_type value){
+	return value < 0 ? reference_unsigned_type(0) - reference_unsigned_type(value) : reference_unsigned_type(value);
+}
+
+static reference_unsigned_type gcd(reference_unsigned_type a, reference_unsigned_type b){
+	while (b){
+		const reference_unsigned_type rest = a % b;
+		a = b;
+		b = rest;
+	}
+	return a;
+}
+
+template<typename IntegerType>
+bool fits(reference_type value){
+	return value >= reference_type(std::numeric_limits<IntegerType>::min()) && value <= reference_type(std::numeric_limits<IntegerType>::max());
+}
+
+// Compares a result with numerator / denominator in lowest terms, when that fits IntegerType
+template<typename IntegerType>
+void check_result(const char* name, const char* operation, const Fraction<IntegerType>& a, const Fraction<IntegerType>& b, Fraction<IntegerType> result, reference_type numerator, reference_type denominator){
+	const reference_type divisor = reference_type(gcd(magnitude(numerator), magnitude(denominator)));
+	numerator /= divisor;
+	denominator /= divisor;
+	if (!fits<IntegerType>(numerator) || !fits<IntegerType>(denominator)){
+		return;
+	}
+	#ifdef FIXEDPOINT_FRACTION_LAZY
+		// Results are only in lowest terms once simplified
+		result.simplify();
+	#endif
+	if (reference_type(result.numerator()) != numerator || reference_type(result.denominator()) != denominator){
+		std::printf("%s: %lld/%lld %s %lld/%lld is %lld/%lld, expected %lld/%lld\n", name, (long long int)a.numerator(), (long long int)a.denominator(), operation,
+			(long long int)b.numerator(), (long long int)b.denominator(), (long long int)result.numerator(), (long long int)result.denominator(), (long long int)numerator, (long long int)denominator);
+		failures++;
+	}
+}
+
+template<typename IntegerType>
+void check(const char* name, const Fraction<IntegerType>& a, const Fraction<IntegerType>& b){
+	const reference_type an = a.numerator(), ad = a.denominator(), bn = b.numerator(), bd = b.denominator();
+	check_result(name, "*", a, b, a * b, an * bn, ad * bd);
+	check_result(name, "+", a, b, a + b, an * bd + bn * ad, ad * bd);
+	check_result(name, "-", a, b, a - b, an * bd - bn * ad, ad * bd);
+	if (bn){
+		check_result(name, "/", a, b, a / b, an * bd, ad * bn);
+	}
+
+	// The same with the numerator of b as an integer
+	const Fraction<IntegerType> integer(b.numerator(), 1);
+	check_result(name, "* integer", a, integer, a * b.numerator(), an * bn, ad);
+	check_result(name, "+ integer", a, integer, a + b.numerator(), an + bn * ad, ad);
+	check_result(name, "- integer", a, integer, a - b.numerator(), an - bn * ad, ad);
+	if (bn){
+		check_result(name, "/ integer", a, integer, a / b.numerator(), an, ad * bn);
+	}
+}
+
+// A random value of any number of bits, up to the largest magnitude of IntegerType
+template<typename IntegerType>
+IntegerType random_magnitude(){
+	const count_type digits = std::numeric_limits<IntegerType>::digits;
+	return IntegerType((random_bits() & (~0ull >> (64 - digits))) >> (random_bits() % digits));
+}
+
+// A random Fraction in lowest terms, with a positive denominator
+template<typename IntegerType>
+Fraction<IntegerType> random_fraction(){
+	IntegerType numerator = random_magnitude<IntegerType>();
+	IntegerType denominator = random_magnitude<IntegerType>();
+	if (!denominator){
+		denominator = 1;
+	}
+	if (std::numeric_limits<IntegerType>::is_signed && random_bits() % 2){
+		numerator = IntegerType(-numerator);
+	}
+	Fraction<IntegerType> result(numerator, denominator);
+	result.simplify();
+	return result;
+}
+
+template<typename IntegerType>
+void check_random(const char* name){
+	for (int i = 0; i < 100000; i++){
+		check(name, random_fraction<IntegerType>(), random_fraction<IntegerType>());
+	}
+
+	// p q / r and r s / q, whose product p s / 1 always fits although p q r s does not
+	const count_type quarter = count_type(std::numeric_limits<IntegerType>::digits / 4);
+	for (int i = 0; i < 100000; i++){
+		const IntegerType p = IntegerType(random_bits() >> (64 - 2 * quarter)), q = IntegerType((random_bits() >> (64 - 2 * quarter)) | 1);
+		const IntegerType r = IntegerType((random_bits() >> (64 - 2 * quarter)) | 1), s = IntegerType(random_bits() >> (64 - 2 * quarter));
+		Fraction<IntegerType> a(IntegerType(p * q), r), b(IntegerType(r * s), q);
+		a.simplify();
+		b.simplify();
+		check(name, a, b);
+		// a / (q / r s) is the same product
+		Fraction<IntegerType> c(q, IntegerType(r * s));
+		if (s){
+			c.simplify();
+			check(name, a, c);
+		}
+	}
+}
+
+int main(){
+	check_random<short int>("short");
+	check_random<unsigned short int>("unsigned short");
+	check_random<int>("int");
+	check_random<unsigned int>("unsigned int");
+	// No wider type, so only the cancellation keeps products in range
+	check_random<long long int>("long long");
+
+	// The most negative value, whose magnitude does not fit
+	const int min = std::numeric_limits<int>::min();
+	const int max = std::numeric_limits<int>::max();
+	check<int>("int", Fraction<int>(min, 1), Fraction<int>(1, 2));
+	check<int>("int", Fraction<int>(min, 3), Fraction<int>(min, 5));
+	check<int>("int", Fraction<int>(min, 3), Fraction<int>(1, 3));
+	check<int>("int", Fraction<int>(min, 3), Fraction<int>(-1, 3));
+	check<int>("int", Fraction<int>(min, max), Fraction<int>(max, 2));
+	check<int>("int", Fraction<int>(max, 2), Fraction<int>(2, max));
+	check<int>("int", Fraction<int>(-max, 7), Fraction<int>(7, max));
+	check<long long int>("long long", Fraction<long long int>(std::numeric_limits<long long int>::min(), 3), Fraction<long long int>(3, 1LL << 62));
+	check<long long int>("long long", Fraction<long long int>(std::numeric_limits<long long int>::max(), 1LL << 62), Fraction<long long int>(1LL << 61, std::numeric_limits<long long int>::max()));
+
+	// Coprime operands whose results are already in lowest terms
+	check<int>("int", Fraction<int>(2147483629, 2147483587), Fraction<int>(1, 2147483587));
+	check<int>("int", Fraction<int>(65521, 65519), Fraction<int>(65519, 65521));
+
+	if (failures){
+		std::printf("%d failures\n", failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,138 @@
+/**
+ *	@file fp_fraction_gcd.cpp
+ *	Checks the binary GCD of fp_fraction.h against Euclid's algorithm, and that simplify() gives lowest terms
+ *	for negative values, the most negative value, and values already in lowest terms
+ */
+
+#include <cstdio>
+#include <limits>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+
+static int failures = 0;
+
+static unsigned long long int random_bits(){
+	static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+template<typename UnsignedType>
+UnsignedType euclid(UnsignedType a, UnsignedType b){
+	while (b){
+		const UnsignedType rest = UnsignedType(a % b);
+		a = b;
+		b = rest;
+	}
+	return a;
+}
+
+template<typename UnsignedType>
+void check_gcd(const char* name, UnsignedType a, UnsignedType b){
+	const UnsignedType expected = euclid(a, b);
+	if (_fp_gcd(a, b) != expected || _fp_gcd(b, a) != expected){
+		std::printf("%s: gcd(%llu, %llu) is %llu, expected %llu\n", name, (unsigned long long int)a, (unsigned long long int)b, (unsigned long long int)_fp_gcd(a, b), (unsigned long long int)expected);
+		failures++;
+	}
+}
+
+template<typename UnsignedType>
+void check_gcds(const char* name){
+	const UnsignedType max = std::numeric_limits<UnsignedType>::max();
+	check_gcd<UnsignedType>(name, 0, 0);
+	check_gcd<UnsignedType>(name, 0, 12);
+	check_gcd<UnsignedType>(name, max, 0);
+	check_gcd<UnsignedType>(name, max, max);
+	check_gcd<UnsignedType>(name, max, UnsignedType(max - 1));
+	check_gcd<UnsignedType>(name, UnsignedType(max / 2 + 1), UnsignedType(max / 2 + 1));
+	check_gcd<UnsignedType>(name, UnsignedType(max / 2 + 1), 48);
+
+	// Neighbouring Fibonacci numbers are coprime and take the most steps
+	UnsignedType previous = 1, current = 1;
+	while (current <= max - previous){
+		const UnsignedType next = UnsignedType(previous + current);
+		previous = current;
+		current = next;
+		check_gcd<UnsignedType>(name, previous, current);
+	}
+
+	// Powers of two, which the shifts alone reduce
+	for (count_type i = 0; i < std::numeric_limits<UnsignedType>::digits; i++){
+		for (count_type j = 0; j < std::numeric_limits<UnsignedType>::digits; j += 3){
+			check_gcd<UnsignedType>(name, UnsignedType(UnsignedType(1) << i), UnsignedType(UnsignedType(3) << j));
+		}
+	}
+
+	// Random values, and multiples of a random common factor
+	for (int i = 0; i < 100000; i++){
+		const UnsignedType a = UnsignedType(random_bits() >> (random_bits() % std::numeric_limits<UnsignedType>::digits));
+		const UnsignedType b = UnsignedType(random_bits() >> (random_bits() % std::numeric_limits<UnsignedType>::digits));
+		check_gcd<UnsignedType>(name, a, b);
+		const UnsignedType factor = UnsignedType(random_bits() % 1000 + 1);
+		check_gcd<UnsignedType>(name, UnsignedType(a / factor * factor), UnsignedType(b / factor * factor));
+	}
+}
+
+template<typename IntegerType>
+void check_simplify(const char* name, IntegerType numerator, IntegerType denominator, IntegerType expected_numerator, IntegerType expected_denominator){
+	Fraction<IntegerType> value(numerator, denominator);
+	value.simplify();
+	if (value.numerator() != expected_numerator || value.denominator() != expected_denominator){
+		std::printf("%s: %lld/%lld simplifies to %lld/%lld, expected %lld/%lld\n", name, (long long int)numerator, (long long int)denominator,
+			(long long int)value.numerator(), (long long int)value.denominator(), (long long int)expected_numerator, (long long int)expected_denominator);
+		failures++;
+	}
+}
+
+int main(){
+	// Every pair of 8 bit values
+	for (unsigned int a = 0; a < 256; a++){
+		for (unsigned int b = 0; b < 256; b++){
+			check_gcd<unsigned char>("unsigned char", (unsigned char)a, (unsigned char)b);
+		}
+	}
+	check_gcds<unsigned short int>("unsigned short");
+	check_gcds<unsigned int>("unsigned int");
+	check_gcds<unsigned long long int>("unsigned long long");
+
+	// Signs stay where they are, and only the magnitudes are divided
+	const int min = std::numeric_limits<int>::min();
+	check_simplify<int>("int", 6, 4, 3, 2);
+	check_simplify<int>("int", -6, 4, -3, 2);
+	check_simplify<int>("int", 6, -4, 3, -2);
+	check_simplify<int>("int", -6, -4, -3, -2);
+	check_simplify<int>("int", 0, -5, 0, -1);
+	check_simplify<int>("int", 7, 9, 7, 9);
+	check_simplify<int>("int", -2147483647, 2147483646, -2147483647, 2147483646);
+
+	// The magnitude of the most negative value does not fit in int, but its quotients do
+	check_simplify<int>("int", min, 2, min / 2, 1);
+	check_simplify<int>("int", min, 6, min / 2, 3);
+	check_simplify<int>("int", min, 3, min, 3);
+	check_simplify<int>("int", min, min, -1, -1);
+	check_simplify<int>("int", min / 4, min, -1, -4);
+	check_simplify<int>("int", 1 << 30, min, 1, -2);
+	check_simplify<long long int>("long long", std::numeric_limits<long long int>::min(), 1LL << 40, -(1LL << 23), 1);
+	check_simplify<unsigned int>("unsigned int", 0x80000000u, 0xC0000000u, 2u, 3u);
+
+	// Random fractions in lowest terms, scaled by a common factor
+	for (int i = 0; i < 100000; i++){
+		const int factor = int(random_bits() % 5000) + 1;
+		int numerator = int(random_bits() % 400000) - 200000;
+		int denominator = int(random_bits() % 400000) + 1;
+		const unsigned int divisor = euclid<unsigned int>(_fp_magnitude(numerator), (unsigned int)denominator);
+		numerator /= int(divisor);
+		denominator /= int(divisor);
+		const int sign = random_bits() % 2 ? 1 : -1;
+		check_simplify<int>("int", numerator * factor * sign, denominator * factor, numerator * sign, denominator);
+	}
+
+	if (failures){
+		std::printf("%d failures\n", failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,67 @@
+/**
+ *	@file fp_matrix_dot.cpp
+ *	Checks that the vector dot product kernels of fp_matrix.h give the same sums as the scalar loop,
+ *	for every length up to a few vectors and with contents at the limits of each type
+ */
+
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_matrix.h"
+
+static int failures = 0;
+
+static unsigned long long int random_bits(){
+	static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+template<typename IntegerType>
+void check(const char* name){
+	typedef _fp_accumulator<IntegerType> accumulator_type;
+	static const size_t length = 80, stride = length;
+
+	std::vector<IntegerType> a(length), b(4 * stride);
+	for (size_t i = 0; i < length; i++){
+		a[i] = i % 3 ? IntegerType(random_bits()) : std::numeric_limits<IntegerType>::min();
+	}
+	for (size_t i = 0; i < b.size(); i++){
+		b[i] = i % 5 ? IntegerType(random_bits()) : (i % 2 ? std::numeric_limits<IntegerType>::max() : std::numeric_limits<IntegerType>::min());
+	}
+
+	for (size_t count = 0; count <= length; count++){
+		accumulator_type vector, scalar;
+		_fp_dot_kernel<IntegerType>::dot(&a[0], &b[0], count, vector);
+		_fp_dot_scalar<IntegerType>::dot(&a[0], &b[0], count, scalar);
+
+		accumulator_type vector4[4], scalar4[4];
+		_fp_dot_kernel<IntegerType>::dot4(&a[0], &b[0], stride, count, vector4);
+		_fp_dot_scalar<IntegerType>::dot4(&a[0], &b[0], stride, count, scalar4);
+
+		bool same = vector._sum == scalar._sum;
+		for (size_t k = 0; k < 4; k++){
+			same = same && vector4[k]._sum == scalar4[k]._sum;
+		}
+		if (!same){
+			std::printf("%s: the sums of %lu products differ from the scalar loop\n", name, (unsigned long)count);
+			failures++;
+			return;
+		}
+	}
+}
+
+int main(){
+	check<signed char>("signed char");
+	check<unsigned char>("unsigned char");
+	check<short int>("short");
+	check<unsigned short int>("unsigned short");
+	check<int>("int");
+	check<unsigned int>("unsigned int");
+	return failures != 0;
+}
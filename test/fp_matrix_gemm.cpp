@@ -0,0 +1,77 @@
+/**
+ *	@file fp_matrix_gemm.cpp
+ *	Checks fp_gemm and fp_gemm_parallel against dot products of rows and columns, for sizes that do not
+ *	divide into the panels and blocks, which are made small here so that every matrix spans several of them
+ */
+
+// The block sizes must be chosen before the first include
+#define FIXEDPOINT_GEMM_PANEL 8
+#define FIXEDPOINT_GEMM_DEPTH 16
+#define FIXEDPOINT_GEMM_ROWS 4
+
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_matrix.h"
+
+static int failures = 0;
+
+static unsigned long long int random_bits(){
+	static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+template<typename IntegerType, count_type FractionalBits>
+void check(const char* name, size_t rows, size_t inner, size_t columns){
+	typedef FixedPoint<IntegerType, std::numeric_limits<IntegerType>::digits - FractionalBits, FractionalBits, fp_saturate> value_type;
+
+	std::vector<value_type> a(rows * inner + 1), b(inner * columns + 1), column(inner + 1), out(rows * columns + 1), parallel(rows * columns + 1);
+	for (size_t i = 0; i < a.size(); i++){
+		a[i] = value_type(i % 11 ? IntegerType(random_bits()) : std::numeric_limits<IntegerType>::min());
+	}
+	for (size_t i = 0; i < b.size(); i++){
+		b[i] = value_type(i % 13 ? IntegerType(random_bits()) : std::numeric_limits<IntegerType>::max());
+	}
+	fp_gemm(&out[0], &a[0], &b[0], rows, inner, columns);
+	fp_gemm_parallel(&parallel[0], &a[0], &b[0], rows, inner, columns, 3);
+
+	for (size_t j = 0; j < columns; j++){
+		for (size_t k = 0; k < inner; k++){
+			column[k] = b[k * columns + j];
+		}
+		for (size_t i = 0; i < rows; i++){
+			const value_type expected = fp_dot(&a[i * inner], &column[0], inner);
+			if (out[i * columns + j]() != expected() || parallel[i * columns + j]() != expected()){
+				std::printf("%s: %lu x %lu x %lu differs from fp_dot at (%lu, %lu)\n", name, (unsigned long)rows, (unsigned long)inner, (unsigned long)columns, (unsigned long)i, (unsigned long)j);
+				failures++;
+				return;
+			}
+		}
+	}
+}
+
+template<typename IntegerType, count_type FractionalBits>
+void check_sizes(const char* name){
+	static const size_t sizes[] = {1, 3, 4, 7, 16, 37};
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++){
+		for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++){
+			for (size_t j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++){
+				check<IntegerType, FractionalBits>(name, sizes[i], sizes[k], sizes[j]);
+			}
+		}
+	}
+}
+
+int main(){
+	check_sizes<signed char, 7>("q0_7");
+	check_sizes<short int, 15>("q0_15");
+	check_sizes<int, 31>("q0_31");
+	check_sizes<long long int, 40>("q23_40");
+	return failures != 0;
+}
@@ -0,0 +1,51 @@
+/**
+ *	@file fp_packed_limits.cpp
+ *	Checks that FixedPointPacked applies the overflow policy to contents that do not fit its bits,
+ *	including contents at the limits of the IntegerType
+ */
+
+#include <cstdio>
+#include <limits>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_packed.h"
+
+static int failures = 0;
+
+template<typename Packed>
+void check(const char* name, typename Packed::value_type value, long long int expected){
+	Packed packed(2);
+	packed.set(0, value);
+	packed.pack(&value, 1, 1);
+	for (size_t i = 0; i < 2; i++){
+		if ((long long int)packed.get(i)() != expected){
+			std::printf("%s: stored %lld as %lld, expected %lld\n", name, (long long int)value(), (long long int)packed.get(i)(), expected);
+			failures++;
+		}
+	}
+}
+
+int main(){
+	// 13 bits hold -4096 to 4095
+	typedef FixedPointPacked<short, 4, 8, fp_saturate> saturated;
+	check<saturated>("saturate", short(4095), 4095);
+	check<saturated>("saturate", short(-4096), -4096);
+	check<saturated>("saturate", short(4096), 4095);
+	check<saturated>("saturate", short(-4097), -4096);
+	check<saturated>("saturate", std::numeric_limits<short>::max(), 4095);
+	check<saturated>("saturate", std::numeric_limits<short>::min(), -4096);
+
+	// Wrapping keeps the low 13 bits
+	typedef FixedPointPacked<short, 4, 8, fp_wrap> wrapped;
+	check<wrapped>("wrap", short(4096), -4096);
+	check<wrapped>("wrap", std::numeric_limits<short>::max(), -1);
+	check<wrapped>("wrap", std::numeric_limits<short>::min(), 0);
+
+	// 12 bits hold 0 to 4095
+	typedef FixedPointPacked<unsigned short, 4, 8, fp_saturate> unsigned_saturated;
+	check<unsigned_saturated>("unsigned saturate", (unsigned short)(4096), 4095);
+	check<unsigned_saturated>("unsigned saturate", std::numeric_limits<unsigned short>::max(), 4095);
+
+	return failures != 0;
+}
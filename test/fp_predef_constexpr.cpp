@@ -0,0 +1,25 @@
+/**
+ *	@file fp_predef_constexpr.cpp
+ *	Compile-time checks of the fp_predef.h literals: constants must fold at compile time,
+ *	so tables built from them can live in read-only data. Builds only if every check holds
+ */
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_predef.h"
+
+#if defined(FIXEDPOINT_CPP14) && defined(FIXEDPOINT_SIZE16) && defined(FIXEDPOINT_SIZE32) && defined(FIXEDPOINT_SIZE64)
+	static_assert((1.25_q16_16)() == 0x14000, "FixedPoint literals must be constant");
+	static_assert(0.5_q8_8 + 0.25_q8_8 == 0.75_q8_8, "FixedPoint addition must be constant");
+	static_assert(4.5_q16_16 - 3.0_q16_16 + 2_q16_16 == 3.5_q16_16, "FixedPoint subtraction must be constant");
+	static_assert(1.5_q16_16 * 2.5_q16_16 == 3.75_q16_16, "FixedPoint multiplication must be constant");
+	static_assert(1.5_q32_32 * 2.5_q32_32 == 3.75_q32_32, "FixedPoint multiplication must be constant");
+	static_assert(7_q16_16 / 2_q16_16 == 3.5_q16_16, "FixedPoint division must be constant");
+	static_assert(7_q32_32 * (2_q32_32).reciprocal() == 3.5_q32_32, "FixedPoint reciprocals must be constant");
+	static_assert(1_q16_16 < 1.5_q16_16 && 2_q16_16 >= 2_q16_16, "FixedPoint comparisons must be constant");
+	static_assert((2.75_q16_16).convert<8, 24>()() == 0x2C00000, "FixedPoint conversion must be constant");
+#endif
+
+int main(){
+	return 0;
+}
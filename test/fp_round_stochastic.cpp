@@ -0,0 +1,57 @@
+/**
+ *	@file fp_round_stochastic.cpp
+ *	Checks stochastic rounding on 64 and 128 bit sums: results are one of the two neighbours of the exact value,
+ *	and round up about as often as the fraction shifted out
+ */
+
+#include <cstdio>
+
+// Generator of the rounding policy, a xorshift
+struct test_generator{
+	static unsigned long long int next(){
+		static unsigned long long int state = 0x9E3779B97F4A7C15ull;
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return state;
+	}
+};
+
+#define FIXEDPOINT_ROUNDING_POLICY fp_round_stochastic<test_generator>
+
+#include "fp_fraction.h"
+#include "fp_fixedpoint.h"
+#include "fp_fused.h"
+
+static int failures = 0;
+
+// 1.25 * (1 + ulp) is 1.25 + ulp and a quarter of an ulp, so about a quarter of the results must round up
+template<typename IntegerType, count_type IntegerBits>
+void check(const char* name){
+	typedef FixedPoint<IntegerType, IntegerBits> value_type;
+	const value_type a = value_type::from_float(1.25L);
+	const value_type b = value_type(IntegerType(value_type::from_float(1.0L)() + 1));
+	const IntegerType truncated = a() + 1;
+
+	static const int draws = 4000;
+	int up = 0;
+	for (int i = 0; i < draws; i++){
+		const value_type result = fp_fused(a) * fp_fused(b);
+		if (result() != truncated && result() != truncated + 1){
+			std::printf("%s: %lld is not a neighbour of the exact value\n", name, (long long int)result());
+			failures++;
+			return;
+		}
+		up += result() != truncated;
+	}
+	if (up < draws / 5 || up > draws * 3 / 10){
+		std::printf("%s: rounded up %d times out of %d, expected about %d\n", name, up, draws, draws / 4);
+		failures++;
+	}
+}
+
+int main(){
+	check<int, 15>("Q15.16, 64 bit sum");
+	check<long long int, 31>("Q31.32, 128 bit sum");
+	return failures != 0;
+}